@@ -801,6 +801,41 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         items=enum_texture_limit
     )
 
+    use_texture_cache: BoolProperty(
+        name="Texture Cache",
+        description="Read tiled image files (such as .tx) from disk on demand when rendering on the CPU, "
+        "instead of loading all images into memory",
+        default=False,
+    )
+    texture_cache_size: IntProperty(
+        name="Cache Size",
+        description="Maximum memory in megabytes used for tiles of images read on demand",
+        default=4096,
+        min=64, max=1048576,
+    )
+
+    use_bvh_cache: BoolProperty(
+        name="BVH Cache",
+        description="Store acceleration structures of objects on disk and reuse them in later renders "
+        "when the geometry did not change. Objects always get their own acceleration structure, "
+        "which can make rendering slightly slower",
+        default=False,
+    )
+    bvh_cache_directory: StringProperty(
+        name="Cache Directory",
+        description="Directory to store acceleration structures in, shared between renders. "
+        "Uses the user cache directory when empty",
+        default="",
+        subtype='DIR_PATH',
+    )
+    bvh_cache_size: IntProperty(
+        name="Cache Size",
+        description="Maximum disk space in megabytes used by the cache, acceleration structures "
+        "written least recently are removed first",
+        default=8192,
+        min=64, max=1048576,
+    )
+
     use_fast_gi: BoolProperty(
         name="Fast GI Approximation",
         description="Approximate diffuse indirect light with background tinted ambient occlusion. This provides fast alternative to full global illumination, for interactive viewport rendering or final renders with reduced quality",
@@ -838,6 +873,12 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         default='EMBREE',
     )
     debug_use_cpu_split_kernel: BoolProperty(name="Split Kernel", default=False)
+    debug_use_cpu_bvh_triangle_soa: BoolProperty(
+        name="SIMD Triangles",
+        description="Store triangles of BVH leaf nodes in groups of four and intersect them at once, "
+        "uses more memory",
+        default=True,
+    )
 
     debug_use_cuda_adaptive_compile: BoolProperty(name="Adaptive Compile", default=False)
     debug_use_cuda_split_kernel: BoolProperty(name="Split Kernel", default=False)
@@ -758,7 +758,9 @@ void BlenderSync::free_data_after_sync(BL::Depsgraph &b_depsgraph)
 
 /* Scene Parameters */
 
-SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene, bool background)
+SceneParams BlenderSync::get_scene_params(BL::BlendData &b_data,
+                                          BL::Scene &b_scene,
+                                          bool background)
 {
   SceneParams params;
   PointerRNA cscene = RNA_pointer_get(&b_scene.ptr, "cycles");
@@ -797,9 +799,29 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene, bool background)
     params.texture_limit = 0;
   }
 
+  if (get_boolean(cscene, "use_texture_cache")) {
+    params.texture_cache_size = get_int(cscene, "texture_cache_size");
+  }
+  else {
+    params.texture_cache_size = 0;
+  }
+
+  if (get_boolean(cscene, "use_bvh_cache")) {
+    const string cache_directory = get_string(cscene, "bvh_cache_directory");
+    params.bvh_cache_path = (cache_directory.empty()) ?
+                                path_cache_get("bvh") :
+                                blender_absolute_path(b_data, b_scene, cache_directory);
+    params.bvh_cache_size = get_int(cscene, "bvh_cache_size");
+  }
+  else {
+    params.bvh_cache_path = "";
+    params.bvh_cache_size = 0;
+  }
+
   params.bvh_layout = DebugFlags().cpu.bvh_layout;
 
   params.background = background;
+  params.use_persistent_data = background && b_scene.render().use_persistent_data();
 
   return params;
 }
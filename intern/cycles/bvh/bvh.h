@@ -65,6 +65,11 @@ struct PackedBVH {
   array<int> prim_object;
   /* Time range of BVH primitive. */
   array<float2> prim_time;
+  /* Triangles of leaf nodes in groups of four, stored as structure of arrays so they can be
+   * intersected at once on the CPU. Optional, see BVHParams::use_triangle_soa. */
+  array<float4> prim_tri_soa;
+  /* Mapping from the first primitive of each group to its index in the triangle groups. */
+  array<uint> prim_tri_soa_index;
 
   /* index of the root node. */
   int root_index;
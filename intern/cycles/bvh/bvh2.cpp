@@ -25,9 +25,16 @@
 #include "bvh/bvh_node.h"
 #include "bvh/bvh_unaligned.h"
 
+#include "util/util_algorithm.h"
 #include "util/util_foreach.h"
+#include "util/util_logging.h"
+#include "util/util_md5.h"
+#include "util/util_path.h"
 #include "util/util_progress.h"
 
+#include <cstdio>
+#include <random>
+
 CCL_NAMESPACE_BEGIN
 
 BVHStackEntry::BVHStackEntry(const BVHNode *n, int i) : node(n), idx(i)
@@ -42,12 +49,28 @@ int BVHStackEntry::encodeIdx() const
 BVH2::BVH2(const BVHParams &params_,
            const vector<Geometry *> &geometry_,
            const vector<Object *> &objects_)
-    : BVH(params_, geometry_, objects_)
+    : BVH(params_, geometry_, objects_),
+      own_nodes_size(0),
+      own_leaf_nodes_size(0),
+      own_prims_size(0),
+      build_sah_cost(0.0f),
+      refit_sah_cost(0.0f)
 {
 }
 
 void BVH2::build(Progress &progress, Stats *)
 {
+  const string cache_path = cache_filepath();
+  if (!cache_path.empty()) {
+    progress.set_substatus("Reading BVH from cache");
+    if (cache_read(cache_path)) {
+      VLOG(1) << "Read BVH from cache " << cache_path;
+      /* Mark as used, so the cache size limit removes files that were not read recently. */
+      path_touch(cache_path);
+      return;
+    }
+  }
+
   progress.set_substatus("Building BVH");
 
   /* build nodes */
@@ -94,20 +117,113 @@ void BVH2::build(Progress &progress, Stats *)
   progress.set_substatus("Packing BVH nodes");
   pack_nodes(root);
 
+  /* Remember the state the tree was built for, to decide if it can be refit later. */
+  build_sah_cost = ensure_finite(root->computeSubtreeSAHCost(params));
+  refit_sah_cost = build_sah_cost;
+
+  if (params.top_level) {
+    traceable_objects.resize(objects.size());
+    instanced_objects.resize(objects.size());
+    for (size_t i = 0; i < objects.size(); i++) {
+      traceable_objects[i] = objects[i]->is_traceable();
+      instanced_objects[i] = objects[i]->get_geometry()->is_instanced();
+    }
+  }
+
   /* free build nodes */
   root->deleteSubtree();
+
+  if (!cache_path.empty() && params.use_cache_write) {
+    progress.set_substatus("Writing BVH to cache");
+    if (!cache_write(cache_path)) {
+      VLOG(1) << "Failed to write BVH to cache " << cache_path;
+    }
+  }
 }
 
 void BVH2::refit(Progress &progress)
 {
+  if (params.top_level) {
+    /* Remove the merged BVHs of instanced geometry, they are merged again after refitting since
+     * they might have been refit or rebuilt themselves. */
+    pack.nodes.resize(own_nodes_size);
+    pack.leaf_nodes.resize(own_leaf_nodes_size);
+    pack.prim_type.resize(own_prims_size);
+    pack.prim_index.resize(own_prims_size);
+    pack.prim_object.resize(own_prims_size);
+    if (pack.prim_time.size()) {
+      pack.prim_time.resize(own_prims_size);
+    }
+
+    /* Primitive indices point into the global arrays, make them local to the geometry again
+     * for packing the primitives. */
+    for (size_t i = 0; i < own_prims_size; i++) {
+      if (pack.prim_index[i] != -1) {
+        pack.prim_index[i] -= objects[pack.prim_object[i]]->get_geometry()->prim_offset;
+      }
+    }
+  }
+
   progress.set_substatus("Packing BVH primitives");
   pack_primitives();
 
+  if (params.top_level) {
+    for (size_t i = 0; i < own_prims_size; i++) {
+      if (pack.prim_index[i] != -1) {
+        pack.prim_index[i] += objects[pack.prim_object[i]]->get_geometry()->prim_offset;
+      }
+    }
+  }
+
   if (progress.get_cancel())
     return;
 
   progress.set_substatus("Refitting BVH nodes");
   refit_nodes();
+
+  if (params.top_level) {
+    progress.set_substatus("Packing instanced BVHs");
+    pack_instances(own_nodes_size, own_leaf_nodes_size);
+
+    if (params.use_triangle_soa) {
+      pack_triangles_soa();
+    }
+  }
+}
+
+bool BVH2::can_refit() const
+{
+  /* Not built yet, or the packed data was not kept. */
+  if (own_leaf_nodes_size == 0 || pack.leaf_nodes.size() < own_leaf_nodes_size ||
+      pack.nodes.size() < own_nodes_size || pack.prim_index.size() < own_prims_size) {
+    return false;
+  }
+
+  if (params.top_level) {
+    /* Objects that were not traceable are not in the tree. Objects becoming untraceable are
+     * fine, their bounds are empty after refitting. */
+    if (objects.size() != traceable_objects.size()) {
+      return false;
+    }
+    for (size_t i = 0; i < objects.size(); i++) {
+      if (objects[i]->is_traceable() && !traceable_objects[i]) {
+        return false;
+      }
+      if (objects[i]->get_geometry()->is_instanced() != instanced_objects[i]) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+bool BVH2::refit_degraded() const
+{
+  /* Refitting keeps the topology that was optimal for the primitive positions at build time,
+   * rebuild when the tree has become noticeably more expensive to traverse. */
+  const float max_cost_factor = 1.5f;
+  return build_sah_cost > 0.0f && refit_sah_cost > build_sah_cost * max_cost_factor;
 }
 
 BVHNode *BVH2::widen_children_nodes(const BVHNode *root)
@@ -258,8 +374,20 @@ void BVH2::pack_nodes(const BVHNode *root)
   /* Resize arrays */
   pack.nodes.clear();
   pack.leaf_nodes.clear();
+  own_nodes_size = node_size;
+  own_leaf_nodes_size = num_leaf_nodes * BVH_NODE_LEAF_SIZE;
+  own_prims_size = pack.prim_index.size();
   /* For top level BVH, first merge existing BVH's so we know the offsets. */
   if (params.top_level) {
+    /* Adjust primitive index to point to the triangle in the global array, for
+     * geometry with transform applied and already in the top level BVH.
+     */
+    for (size_t i = 0; i < pack.prim_index.size(); i++) {
+      if (pack.prim_index[i] != -1) {
+        pack.prim_index[i] += objects[pack.prim_object[i]]->get_geometry()->prim_offset;
+      }
+    }
+
     pack_instances(node_size, num_leaf_nodes * BVH_NODE_LEAF_SIZE);
   }
   else {
@@ -311,15 +439,22 @@ void BVH2::pack_nodes(const BVHNode *root)
   assert(node_size == nextNodeIdx);
   /* root index to start traversal at, to handle case of single leaf node */
   pack.root_index = (root->is_leaf()) ? -1 : 0;
+
+  if (params.top_level && params.use_triangle_soa) {
+    pack_triangles_soa();
+  }
 }
 
 void BVH2::refit_nodes()
 {
-  assert(!params.top_level);
-
   BoundBox bbox = BoundBox::empty;
   uint visibility = 0;
+  refit_sah_cost = 0.0f;
   refit_node(0, (pack.root_index == -1) ? true : false, bbox, visibility);
+
+  /* Same as BVHNode::computeSubtreeSAHCost(), relative to the area of the root. */
+  const float root_area = bbox.safe_area();
+  refit_sah_cost = (root_area > 0.0f) ? refit_sah_cost / root_area : 0.0f;
 }
 
 void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
@@ -331,7 +466,15 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     const int c0 = data[0].x;
     const int c1 = data[0].y;
 
-    refit_primitives(c0, c1, bbox, visibility);
+    if (c0 < 0) {
+      /* Object instance in a top level BVH, stored as inverted primitive index. */
+      refit_primitives(~c0, ~c0 + 1, bbox, visibility);
+      refit_sah_cost += bbox.safe_area() * params.primitive_cost(1);
+    }
+    else {
+      refit_primitives(c0, c1, bbox, visibility);
+      refit_sah_cost += bbox.safe_area() * params.primitive_cost(c1 - c0);
+    }
 
     /* TODO(sergey): De-duplicate with pack_leaf(). */
     float4 leaf_data[BVH_NODE_LEAF_SIZE];
@@ -367,6 +510,7 @@ void BVH2::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
     bbox.grow(bbox0);
     bbox.grow(bbox1);
     visibility = visibility0 | visibility1;
+    refit_sah_cost += bbox.safe_area() * params.node_cost(2);
   }
 }
 
@@ -499,19 +643,60 @@ void BVH2::pack_primitives()
   }
 }
 
-/* Pack Instances */
-
-void BVH2::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
+/* Pack triangles of all leaf nodes, including those of merged instanced BVHs, in groups of
+ * four. Leaves are contiguous ranges of primitives, so the group for the primitives starting at
+ * a given address can be found from that address. Vertices of each group are stored as
+ * Ax, Ay, Az, Bx, By, Bz, Cx, Cy, Cz with one triangle per component, unused components are
+ * degenerate triangles at the origin that are never hit. */
+void BVH2::pack_triangles_soa()
 {
-  /* Adjust primitive index to point to the triangle in the global array, for
-   * geometry with transform applied and already in the top level BVH.
-   */
-  for (size_t i = 0; i < pack.prim_index.size(); i++) {
-    if (pack.prim_index[i] != -1) {
-      pack.prim_index[i] += objects[pack.prim_object[i]]->get_geometry()->prim_offset;
+  const size_t leaf_nodes_size = pack.leaf_nodes.size();
+  const int4 *leaf_nodes = pack.leaf_nodes.data();
+
+  size_t num_groups = 0;
+  for (size_t i = 0; i < leaf_nodes_size; i += BVH_NODE_LEAF_SIZE) {
+    const int4 data = leaf_nodes[i];
+    if (data.x >= 0 && data.w == PRIMITIVE_TRIANGLE) {
+      num_groups += divide_up(data.y - data.x, 4);
+    }
+  }
+
+  pack.prim_tri_soa.resize(num_groups * BVH_TRIANGLE_SOA_SIZE);
+  pack.prim_tri_soa_index.resize(pack.prim_index.size());
+  for (size_t i = 0; i < pack.prim_tri_soa_index.size(); i++) {
+    pack.prim_tri_soa_index[i] = (uint)-1;
+  }
+
+  size_t soa_index = 0;
+  for (size_t i = 0; i < leaf_nodes_size; i += BVH_NODE_LEAF_SIZE) {
+    const int4 data = leaf_nodes[i];
+    if (data.x < 0 || data.w != PRIMITIVE_TRIANGLE) {
+      continue;
+    }
+
+    for (int start = data.x; start < data.y; start += 4) {
+      float4 *soa = &pack.prim_tri_soa[soa_index];
+      memset(soa, 0, sizeof(float4) * BVH_TRIANGLE_SOA_SIZE);
+
+      for (int lane = 0; lane < 4 && start + lane < data.y; lane++) {
+        const float4 *tri_verts = &pack.prim_tri_verts[pack.prim_tri_index[start + lane]];
+        for (int v = 0; v < 3; v++) {
+          soa[v * 3 + 0][lane] = tri_verts[v].x;
+          soa[v * 3 + 1][lane] = tri_verts[v].y;
+          soa[v * 3 + 2][lane] = tri_verts[v].z;
+        }
+      }
+
+      pack.prim_tri_soa_index[start] = soa_index;
+      soa_index += BVH_TRIANGLE_SOA_SIZE;
     }
   }
+}
 
+/* Pack Instances */
+
+void BVH2::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
+{
   /* track offsets of instanced BVH data in global array */
   size_t prim_offset = pack.prim_index.size();
   size_t nodes_offset = nodes_size;
@@ -699,4 +884,235 @@ void BVH2::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
   }
 }
 
+/* Disk Cache */
+
+/* Increase when changing the file format or the way BVHs are built. */
+static const uint BVH2_CACHE_VERSION = 1;
+static const char BVH2_CACHE_MAGIC[4] = {'C', 'B', 'V', 'H'};
+
+static void cache_hash_data(MD5Hash &md5, const void *data, size_t size)
+{
+  /* MD5Hash::append() takes an int size. */
+  const uint8_t *bytes = (const uint8_t *)data;
+  while (size > 0) {
+    const int chunk_size = (int)min(size, (size_t)(1 << 30));
+    md5.append(bytes, chunk_size);
+    bytes += chunk_size;
+    size -= chunk_size;
+  }
+}
+
+template<typename T> static void cache_hash_value(MD5Hash &md5, const T &value)
+{
+  cache_hash_data(md5, &value, sizeof(T));
+}
+
+template<typename T> static void cache_hash_array(MD5Hash &md5, const T *data, size_t size)
+{
+  cache_hash_value(md5, (uint64_t)size);
+  cache_hash_data(md5, data, sizeof(T) * size);
+}
+
+static void cache_hash_float3_array(MD5Hash &md5, const float3 *data, size_t size)
+{
+  /* Only hash the used components, padding of float3 is not initialized. */
+  cache_hash_value(md5, (uint64_t)size);
+
+  const size_t chunk_size = 1024;
+  float buffer[chunk_size * 3];
+  for (size_t start = 0; start < size; start += chunk_size) {
+    const size_t num = min(chunk_size, size - start);
+    for (size_t i = 0; i < num; i++) {
+      buffer[i * 3 + 0] = data[start + i].x;
+      buffer[i * 3 + 1] = data[start + i].y;
+      buffer[i * 3 + 2] = data[start + i].z;
+    }
+    cache_hash_data(md5, buffer, sizeof(float) * 3 * num);
+  }
+}
+
+static void cache_hash_motion_attribute(MD5Hash &md5, const Geometry *geom, size_t num_elements)
+{
+  const Attribute *attr = geom->attributes.find(ATTR_STD_MOTION_VERTEX_POSITION);
+  if (attr && geom->get_use_motion_blur()) {
+    cache_hash_value(md5, geom->get_motion_steps());
+    cache_hash_float3_array(
+        md5, attr->data_float3(), num_elements * (geom->get_motion_steps() - 1));
+  }
+  else {
+    cache_hash_value(md5, 0);
+  }
+}
+
+string BVH2::cache_filepath() const
+{
+  if (params.cache_path.empty() || params.top_level || objects.size() != 1) {
+    return "";
+  }
+
+  const Geometry *geom = objects[0]->get_geometry();
+  MD5Hash md5;
+
+  cache_hash_value(md5, BVH2_CACHE_VERSION);
+
+  /* Parameters that affect the build. */
+  cache_hash_value(md5, (int)params.bvh_layout);
+  cache_hash_value(md5, params.use_spatial_split);
+  cache_hash_value(md5, params.spatial_split_alpha);
+  cache_hash_value(md5, params.unaligned_split_threshold);
+  cache_hash_value(md5, params.sah_node_cost);
+  cache_hash_value(md5, params.sah_primitive_cost);
+  cache_hash_value(md5, params.min_leaf_size);
+  cache_hash_value(md5, params.max_triangle_leaf_size);
+  cache_hash_value(md5, params.max_motion_triangle_leaf_size);
+  cache_hash_value(md5, params.max_curve_leaf_size);
+  cache_hash_value(md5, params.max_motion_curve_leaf_size);
+  cache_hash_value(md5, params.use_unaligned_nodes);
+  cache_hash_value(md5, params.num_motion_curve_steps);
+  cache_hash_value(md5, params.num_motion_triangle_steps);
+  cache_hash_value(md5, params.curve_subdivisions);
+  cache_hash_value(md5, objects[0]->visibility_for_tracing());
+
+  /* Geometry data. */
+  cache_hash_value(md5, (int)geom->geometry_type);
+  if (geom->geometry_type == Geometry::MESH || geom->geometry_type == Geometry::VOLUME) {
+    const Mesh *mesh = static_cast<const Mesh *>(geom);
+    const array<float3> &verts = mesh->get_verts();
+    const array<int> &triangles = mesh->get_triangles();
+    cache_hash_float3_array(md5, verts.data(), verts.size());
+    cache_hash_array(md5, triangles.data(), triangles.size());
+    cache_hash_motion_attribute(md5, geom, verts.size());
+  }
+  else if (geom->geometry_type == Geometry::HAIR) {
+    const Hair *hair = static_cast<const Hair *>(geom);
+    const array<float3> &curve_keys = hair->get_curve_keys();
+    const array<float> &curve_radius = hair->get_curve_radius();
+    const array<int> &curve_first_key = hair->get_curve_first_key();
+    cache_hash_value(md5, (int)hair->curve_shape);
+    cache_hash_float3_array(md5, curve_keys.data(), curve_keys.size());
+    cache_hash_array(md5, curve_radius.data(), curve_radius.size());
+    cache_hash_array(md5, curve_first_key.data(), curve_first_key.size());
+    cache_hash_motion_attribute(md5, geom, curve_keys.size());
+  }
+
+  return path_join(params.cache_path, md5.get_hex() + ".bvh");
+}
+
+template<typename T> static bool cache_write_value(FILE *f, const T &value)
+{
+  return fwrite(&value, sizeof(T), 1, f) == 1;
+}
+
+template<typename T> static bool cache_read_value(FILE *f, T &value)
+{
+  return fread(&value, sizeof(T), 1, f) == 1;
+}
+
+template<typename T> static bool cache_write_array(FILE *f, const array<T> &data)
+{
+  const uint64_t size = data.size();
+  return cache_write_value(f, size) &&
+         (size == 0 || fwrite(data.data(), sizeof(T), size, f) == size);
+}
+
+template<typename T> static bool cache_read_array(FILE *f, const size_t file_size, array<T> &data)
+{
+  uint64_t size;
+  if (!cache_read_value(f, size) || size > file_size / sizeof(T)) {
+    return false;
+  }
+  if (size == 0) {
+    data.clear();
+    return true;
+  }
+  if (data.resize(size) == NULL) {
+    return false;
+  }
+  return fread(data.data(), sizeof(T), size, f) == size;
+}
+
+bool BVH2::cache_read(const string &filepath)
+{
+  const size_t file_size = path_file_size(filepath);
+  FILE *f = path_fopen(filepath, "rb");
+  if (!f) {
+    return false;
+  }
+
+  /* Arrays are read directly into the packed BVH, which is then handed over to the device
+   * memory without further copies. */
+  char magic[4];
+  uint version;
+  uint64_t nodes_size = 0, leaf_nodes_size = 0, prims_size = 0;
+  bool ok = fread(magic, sizeof(magic), 1, f) == 1 &&
+            memcmp(magic, BVH2_CACHE_MAGIC, sizeof(magic)) == 0 &&
+            cache_read_value(f, version) && version == BVH2_CACHE_VERSION &&
+            cache_read_value(f, pack.root_index) && cache_read_value(f, nodes_size) &&
+            cache_read_value(f, leaf_nodes_size) && cache_read_value(f, prims_size) &&
+            cache_read_value(f, build_sah_cost) &&
+            cache_read_array(f, file_size, pack.nodes) &&
+            cache_read_array(f, file_size, pack.leaf_nodes) &&
+            cache_read_array(f, file_size, pack.object_node) &&
+            cache_read_array(f, file_size, pack.prim_tri_index) &&
+            cache_read_array(f, file_size, pack.prim_tri_verts) &&
+            cache_read_array(f, file_size, pack.prim_type) &&
+            cache_read_array(f, file_size, pack.prim_visibility) &&
+            cache_read_array(f, file_size, pack.prim_index) &&
+            cache_read_array(f, file_size, pack.prim_object) &&
+            cache_read_array(f, file_size, pack.prim_time);
+  fclose(f);
+
+  /* Sanity check, protects against files from a different version or that are corrupted. */
+  ok = ok && nodes_size == pack.nodes.size() && leaf_nodes_size == pack.leaf_nodes.size() &&
+       prims_size == pack.prim_index.size() && leaf_nodes_size > 0;
+
+  if (!ok) {
+    pack = PackedBVH();
+    own_nodes_size = own_leaf_nodes_size = own_prims_size = 0;
+    build_sah_cost = 0.0f;
+    return false;
+  }
+
+  own_nodes_size = nodes_size;
+  own_leaf_nodes_size = leaf_nodes_size;
+  own_prims_size = prims_size;
+  refit_sah_cost = build_sah_cost;
+  return true;
+}
+
+bool BVH2::cache_write(const string &filepath) const
+{
+  /* Write to a temporary file first, so that other processes rendering the same geometry never
+   * read a partially written file. */
+  std::random_device random_device;
+  const string tmp_filepath = string_printf("%s.%08x.tmp", filepath.c_str(), random_device());
+
+  path_create_directories(tmp_filepath);
+  FILE *f = path_fopen(tmp_filepath, "wb");
+  if (!f) {
+    return false;
+  }
+
+  const uint version = BVH2_CACHE_VERSION;
+  bool ok = fwrite(BVH2_CACHE_MAGIC, sizeof(BVH2_CACHE_MAGIC), 1, f) == 1 &&
+            cache_write_value(f, version) && cache_write_value(f, pack.root_index) &&
+            cache_write_value(f, (uint64_t)own_nodes_size) &&
+            cache_write_value(f, (uint64_t)own_leaf_nodes_size) &&
+            cache_write_value(f, (uint64_t)own_prims_size) &&
+            cache_write_value(f, build_sah_cost) && cache_write_array(f, pack.nodes) &&
+            cache_write_array(f, pack.leaf_nodes) && cache_write_array(f, pack.object_node) &&
+            cache_write_array(f, pack.prim_tri_index) &&
+            cache_write_array(f, pack.prim_tri_verts) && cache_write_array(f, pack.prim_type) &&
+            cache_write_array(f, pack.prim_visibility) && cache_write_array(f, pack.prim_index) &&
+            cache_write_array(f, pack.prim_object) && cache_write_array(f, pack.prim_time);
+  ok = (fclose(f) == 0) && ok;
+
+  if (!ok || rename(tmp_filepath.c_str(), filepath.c_str()) != 0) {
+    path_remove(tmp_filepath);
+    return false;
+  }
+
+  return true;
+}
+
 CCL_NAMESPACE_END
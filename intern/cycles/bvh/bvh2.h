@@ -28,6 +28,7 @@ CCL_NAMESPACE_BEGIN
 
 #define BVH_NODE_SIZE 4
 #define BVH_NODE_LEAF_SIZE 1
+#define BVH_TRIANGLE_SOA_SIZE 9
 #define BVH_UNALIGNED_NODE_SIZE 7
 
 /* Pack Utility */
@@ -48,6 +49,12 @@ class BVH2 : public BVH {
   void build(Progress &progress, Stats *stats);
   void refit(Progress &progress);
 
+  /* Check if the tree can be refit, or needs a full rebuild because objects that it was built
+   * for changed the way they are referenced. */
+  bool can_refit() const;
+  /* Check if the last refit degraded the quality of the tree enough to rebuild it. */
+  bool refit_degraded() const;
+
   PackedBVH pack;
 
  protected:
@@ -100,9 +107,29 @@ class BVH2 : public BVH {
   /* triangles and strands */
   void pack_primitives();
   void pack_triangle(int idx, float4 storage[3]);
+  void pack_triangles_soa();
 
   /* merge instance BVH's */
   void pack_instances(size_t nodes_size, size_t leaf_nodes_size);
+
+  /* Disk cache for BVHs of a single geometry, file name is a hash of the geometry and
+   * parameters. Empty path if the BVH can not be cached. */
+  string cache_filepath() const;
+  bool cache_read(const string &filepath);
+  bool cache_write(const string &filepath) const;
+
+  /* Size of the packed data of this tree itself, without the merged BVHs of instances. */
+  size_t own_nodes_size;
+  size_t own_leaf_nodes_size;
+  size_t own_prims_size;
+
+  /* Objects that were traceable and instanced when the top level BVH was built. */
+  vector<bool> traceable_objects;
+  vector<bool> instanced_objects;
+
+  /* SAH cost of the tree after the last build and the last refit. */
+  float build_sah_cost;
+  float refit_sah_cost;
 };
 
 CCL_NAMESPACE_END
@@ -19,6 +19,7 @@
 #define __BVH_PARAMS_H__
 
 #include "util/util_boundbox.h"
+#include "util/util_string.h"
 
 #include "kernel/kernel_types.h"
 
@@ -91,6 +92,15 @@ class BVHParams {
   /* These are needed for Embree. */
   int curve_subdivisions;
 
+  /* Directory to cache built BVHs of single geometry in, empty to disable caching. */
+  string cache_path;
+  /* Write built BVHs to the cache, otherwise it is only read from. */
+  bool use_cache_write;
+
+  /* Pack triangles of leaf nodes for SIMD intersection on the CPU. Only used for the top level
+   * BVH2, which includes the triangles of all instanced BVHs. */
+  bool use_triangle_soa;
+
   /* fixed parameters */
   enum { MAX_DEPTH = 64, MAX_SPATIAL_DEPTH = 48, NUM_SPATIAL_BINS = 32 };
 
@@ -122,6 +132,10 @@ class BVHParams {
     bvh_type = 0;
 
     curve_subdivisions = 4;
+
+    use_cache_write = false;
+
+    use_triangle_soa = false;
   }
 
   /* SAH costs */
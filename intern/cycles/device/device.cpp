@@ -371,12 +371,17 @@ void Device::build_bvh(BVH *bvh, Progress &progress, bool refit)
   assert(bvh->params.bvh_layout == BVH_LAYOUT_BVH2);
 
   BVH2 *const bvh2 = static_cast<BVH2 *>(bvh);
-  if (refit) {
+  if (refit && bvh2->can_refit()) {
     bvh2->refit(progress);
+
+    if (progress.get_cancel() || !bvh2->refit_degraded()) {
+      return;
+    }
+
+    VLOG(1) << "BVH quality degraded too much by refitting, rebuilding.";
   }
-  else {
-    bvh2->build(progress, &stats);
-  }
+
+  bvh2->build(progress, &stats);
 }
 
 Device *Device::create(DeviceInfo &info, Stats &stats, Profiler &profiler, bool background)
@@ -137,6 +137,22 @@ ccl_device_noinline bool BVH_FUNCTION_FULL_NAME(BVH)(KernelGlobals *kg,
           /* primitive intersection */
           switch (type & PRIMITIVE_ALL) {
             case PRIMITIVE_TRIANGLE: {
+#if defined(__KERNEL_SSE2__) && defined(__KERNEL_SSE__)
+              /* Intersect four triangles at once if the SoA storage was created. */
+              if (kg->__prim_tri_soa_index.width != 0) {
+                for (; prim_addr < prim_addr2; prim_addr += 4) {
+                  BVH_DEBUG_NEXT_INTERSECTION();
+                  const uint soa_index = kernel_tex_fetch(__prim_tri_soa_index, prim_addr);
+                  if (triangle_intersect4(
+                          kg, isect, P, dir, visibility, object, prim_addr, soa_index)) {
+                    /* shadow ray early termination */
+                    if (visibility & PATH_RAY_SHADOW_OPAQUE)
+                      return true;
+                  }
+                }
+                break;
+              }
+#endif
               for (; prim_addr < prim_addr2; prim_addr++) {
                 BVH_DEBUG_NEXT_INTERSECTION();
                 kernel_assert(kernel_tex_fetch(__prim_type, prim_addr) == type);
@@ -71,6 +71,108 @@ ccl_device_inline bool triangle_intersect(KernelGlobals *kg,
   return false;
 }
 
+#if defined(__KERNEL_SSE2__) && defined(__KERNEL_SSE__)
+/* Dot product of cross(a, b) with d, for four triangles at once. */
+ccl_device_forceinline ssef triangle_soa_cross_dot(const ssef &ax,
+                                                  const ssef &ay,
+                                                  const ssef &az,
+                                                  const ssef &bx,
+                                                  const ssef &by,
+                                                  const ssef &bz,
+                                                  const ssef &dx,
+                                                  const ssef &dy,
+                                                  const ssef &dz)
+{
+  const ssef cx = ay * bz - az * by;
+  const ssef cy = az * bx - ax * bz;
+  const ssef cz = ax * by - ay * bx;
+  return madd(cx, dx, madd(cy, dy, cz * dz));
+}
+
+/* Intersect a group of up to four triangles of a leaf node at once, using the SoA triangle
+ * storage of the CPU. Same algorithm as ray_triangle_intersect(), and like calling
+ * triangle_intersect() for each triangle this finds the closest visible hit. */
+ccl_device_inline bool triangle_intersect4(KernelGlobals *kg,
+                                           Intersection *isect,
+                                           float3 P,
+                                           float3 dir,
+                                           uint visibility,
+                                           int object,
+                                           int prim_addr,
+                                           uint soa_index)
+{
+  const ssef Px(P.x), Py(P.y), Pz(P.z);
+  const ssef dirx(dir.x), diry(dir.y), dirz(dir.z);
+
+  /* Calculate vertices relative to ray origin. */
+  const ssef v0x = kernel_tex_fetch_ssef(__prim_tri_soa, soa_index + 6) - Px;
+  const ssef v0y = kernel_tex_fetch_ssef(__prim_tri_soa, soa_index + 7) - Py;
+  const ssef v0z = kernel_tex_fetch_ssef(__prim_tri_soa, soa_index + 8) - Pz;
+  const ssef v1x = kernel_tex_fetch_ssef(__prim_tri_soa, soa_index + 0) - Px;
+  const ssef v1y = kernel_tex_fetch_ssef(__prim_tri_soa, soa_index + 1) - Py;
+  const ssef v1z = kernel_tex_fetch_ssef(__prim_tri_soa, soa_index + 2) - Pz;
+  const ssef v2x = kernel_tex_fetch_ssef(__prim_tri_soa, soa_index + 3) - Px;
+  const ssef v2y = kernel_tex_fetch_ssef(__prim_tri_soa, soa_index + 4) - Py;
+  const ssef v2z = kernel_tex_fetch_ssef(__prim_tri_soa, soa_index + 5) - Pz;
+
+  /* Calculate triangle edges. */
+  const ssef e0x = v2x - v0x, e0y = v2y - v0y, e0z = v2z - v0z;
+  const ssef e1x = v0x - v1x, e1y = v0y - v1y, e1z = v0z - v1z;
+  const ssef e2x = v1x - v2x, e2y = v1y - v2y, e2z = v1z - v2z;
+
+  /* Perform edge tests. */
+  const ssef U = triangle_soa_cross_dot(
+      v2x + v0x, v2y + v0y, v2z + v0z, e0x, e0y, e0z, dirx, diry, dirz);
+  const ssef V = triangle_soa_cross_dot(
+      v0x + v1x, v0y + v1y, v0z + v1z, e1x, e1y, e1z, dirx, diry, dirz);
+  const ssef W = triangle_soa_cross_dot(
+      v1x + v2x, v1y + v2y, v1z + v2z, e2x, e2y, e2z, dirx, diry, dirz);
+  const ssef zero(0.0f);
+  sseb valid = (min(U, min(V, W)) >= zero) | (max(U, max(V, W)) <= zero);
+
+  /* Calculate geometry normal and denominator. */
+  const ssef Ngx = (e1y * e0z - e1z * e0y) * ssef(2.0f);
+  const ssef Ngy = (e1z * e0x - e1x * e0z) * ssef(2.0f);
+  const ssef Ngz = (e1x * e0y - e1y * e0x) * ssef(2.0f);
+  const ssef den = madd(Ngx, dirx, madd(Ngy, diry, Ngz * dirz));
+  /* Avoid division by 0, this also rejects the unused triangles of the group. */
+  valid &= (den != zero);
+
+  /* Perform depth test. */
+  const ssef T = madd(v0x, Ngx, madd(v0y, Ngy, v0z * Ngz));
+  const ssef sign_den = signmsk(den);
+  const ssef sign_T = T ^ sign_den;
+  valid &= (sign_T >= zero) & (sign_T <= ssef(isect->t) * (den ^ sign_den));
+
+  int mask = movemask(valid);
+  if (mask == 0) {
+    return false;
+  }
+
+  const ssef inv_den = ssef(1.0f) / den;
+  const ssef t = T * inv_den;
+
+  /* Pick the closest hit, skipping triangles that are not visible to the ray. */
+  while (mask != 0) {
+    const int lane = select_min(sseb(mask), t);
+#  ifdef __VISIBILITY_FLAG__
+    if (kernel_tex_fetch(__prim_visibility, prim_addr + lane) & visibility)
+#  endif
+    {
+      isect->prim = prim_addr + lane;
+      isect->object = object;
+      isect->type = PRIMITIVE_TRIANGLE;
+      isect->u = U[lane] * inv_den[lane];
+      isect->v = V[lane] * inv_den[lane];
+      isect->t = t[lane];
+      return true;
+    }
+    mask &= ~(1 << lane);
+  }
+  return false;
+}
+#endif
+
 /* Special ray intersection routines for subsurface scattering. In that case we
  * only want to intersect with primitives in the same object, and if case of
  * multiple hits we pick a single random primitive as the intersection point.
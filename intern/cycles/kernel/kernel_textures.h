@@ -29,6 +29,8 @@ KERNEL_TEX(uint, __prim_index)
 KERNEL_TEX(uint, __prim_object)
 KERNEL_TEX(uint, __object_node)
 KERNEL_TEX(float2, __prim_time)
+KERNEL_TEX(float4, __prim_tri_soa)
+KERNEL_TEX(uint, __prim_tri_soa_index)
 
 /* objects */
 KERNEL_TEX(KernelObject, __objects)
@@ -60,6 +60,8 @@
 #define KERNEL_ARCH cpu
 #include "kernel/kernels/cpu/kernel_cpu_impl.h"
 
+#include <OpenImageIO/texture.h>
+
 CCL_NAMESPACE_BEGIN
 
 /* Memory Copy */
@@ -91,4 +93,71 @@ void kernel_global_memory_copy(KernelGlobals *kg, const char *name, void *mem, s
   }
 }
 
+/* Texture Cache */
+
+void kernel_tex_image_interp_texture_cache(const TextureInfo &info,
+                                           float x,
+                                           float y,
+                                           float result[4])
+{
+  const TextureCacheImage *image = (const TextureCacheImage *)info.data;
+  OIIO::TextureSystem *ts = (OIIO::TextureSystem *)image->texture_system;
+  OIIO::TextureOpt options;
+
+  switch (info.interpolation) {
+    case INTERPOLATION_CLOSEST:
+      options.interpmode = OIIO::TextureOpt::InterpClosest;
+      break;
+    case INTERPOLATION_CUBIC:
+    case INTERPOLATION_SMART:
+      options.interpmode = OIIO::TextureOpt::InterpBicubic;
+      break;
+    default:
+      options.interpmode = OIIO::TextureOpt::InterpBilinear;
+      break;
+  }
+
+  switch (info.extension) {
+    case EXTENSION_REPEAT:
+      options.swrap = options.twrap = OIIO::TextureOpt::WrapPeriodic;
+      break;
+    case EXTENSION_EXTEND:
+      options.swrap = options.twrap = OIIO::TextureOpt::WrapClamp;
+      break;
+    default:
+      options.swrap = options.twrap = OIIO::TextureOpt::WrapBlack;
+      break;
+  }
+
+  /* There are no ray differentials for image lookups, always use the full resolution. */
+  options.mipmode = OIIO::TextureOpt::MipModeNoMIP;
+  /* Opaque alpha for images without alpha channel. */
+  options.fill = 1.0f;
+
+  /* Image files are stored top to bottom, Cycles images bottom to top. */
+  const bool found = ts->texture((OIIO::TextureSystem::TextureHandle *)image->handle,
+                                 NULL,
+                                 options,
+                                 x,
+                                 1.0f - y,
+                                 0.0f,
+                                 0.0f,
+                                 0.0f,
+                                 0.0f,
+                                 4,
+                                 result);
+
+  if (!found) {
+    result[0] = TEX_IMAGE_MISSING_R;
+    result[1] = TEX_IMAGE_MISSING_G;
+    result[2] = TEX_IMAGE_MISSING_B;
+    result[3] = TEX_IMAGE_MISSING_A;
+  }
+  else if (!(isfinite_safe(result[0]) && isfinite_safe(result[1]) && isfinite_safe(result[2]) &&
+             isfinite_safe(result[3]))) {
+    /* Same as for images loaded into memory, avoid artifacts from invalid pixels. */
+    result[0] = result[1] = result[2] = result[3] = 0.0f;
+  }
+}
+
 CCL_NAMESPACE_END
@@ -25,6 +25,13 @@
 
 CCL_NAMESPACE_BEGIN
 
+/* Lookup in an image that is read on demand through the texture cache. Defined once in
+ * kernel.cpp, since it does not depend on the instruction set. */
+void kernel_tex_image_interp_texture_cache(const TextureInfo &info,
+                                           float x,
+                                           float y,
+                                           float result[4]);
+
 /* Make template functions private so symbols don't conflict between kernels with different
  * instruction sets. */
 namespace {
@@ -605,6 +612,11 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, fl
       return TextureInterpolator<ushort4>::interp(info, x, y);
     case IMAGE_DATA_TYPE_FLOAT4:
       return TextureInterpolator<float4>::interp(info, x, y);
+    case IMAGE_DATA_TYPE_TEXTURE_CACHE: {
+      float result[4];
+      kernel_tex_image_interp_texture_cache(info, x, y, result);
+      return make_float4(result[0], result[1], result[2], result[3]);
+    }
     default:
       assert(0);
       return make_float4(
@@ -37,8 +37,10 @@
 
 #include "kernel/osl/osl_globals.h"
 
+#include "util/util_debug.h"
 #include "util/util_foreach.h"
 #include "util/util_logging.h"
+#include "util/util_path.h"
 #include "util/util_progress.h"
 #include "util/util_task.h"
 
@@ -235,6 +237,12 @@ void Geometry::compute_bvh(
       bparams.num_motion_curve_steps = params->num_bvh_time_steps;
       bparams.bvh_type = params->bvh_type;
       bparams.curve_subdivisions = params->curve_subdivisions();
+      bparams.cache_path = params->bvh_cache_path;
+      /* Only final renders write to the cache. Geometry that already had a BVH was modified since
+       * the last sync, so is likely deforming and not worth caching. Without persistent data
+       * this is not known, then deforming geometry writes a file every frame. Those are never
+       * read again, so the cache size limit removes them first. */
+      bparams.use_cache_write = params->background && bvh == nullptr && !has_motion_blur();
 
       delete bvh;
       bvh = BVH::create(bparams, geometry, objects, device);
@@ -1230,11 +1238,17 @@ void GeometryManager::device_update_bvh(Device *device,
   bparams.num_motion_curve_steps = scene->params.num_bvh_time_steps;
   bparams.bvh_type = scene->params.bvh_type;
   bparams.curve_subdivisions = scene->params.curve_subdivisions();
+  /* Only the CPU kernel intersects triangles from the SoA storage. */
+  bparams.use_triangle_soa = (device->info.type == DEVICE_CPU) &&
+                             DebugFlags().cpu.bvh_triangle_soa;
 
   VLOG(1) << "Using " << bvh_layout_name(bparams.bvh_layout) << " layout.";
 
+  /* The scene BVH is freed when the topology changes, so it can be refit when it still exists.
+   * For BVH2 this is further checked by the BVH itself. */
   const bool can_refit = scene->bvh != nullptr &&
-                         (bparams.bvh_layout == BVHLayout::BVH_LAYOUT_OPTIX);
+                         (bparams.bvh_layout == BVHLayout::BVH_LAYOUT_OPTIX ||
+                          bparams.bvh_layout == BVHLayout::BVH_LAYOUT_BVH2);
   const bool pack_all = scene->bvh == nullptr;
 
   BVH *bvh = scene->bvh;
@@ -1251,8 +1265,26 @@ void GeometryManager::device_update_bvh(Device *device,
   const bool has_bvh2_layout = (bparams.bvh_layout == BVH_LAYOUT_BVH2);
 
   PackedBVH pack;
-  if (has_bvh2_layout) {
-    pack = std::move(static_cast<BVH2 *>(bvh)->pack);
+  if (has_bvh2_layout && (!scene->params.background || scene->params.use_persistent_data)) {
+    /* Copy, the BVH keeps its packed data so it can be refit on the next update. */
+    pack = static_cast<BVH2 *>(bvh)->pack;
+  }
+  else if (has_bvh2_layout) {
+    /* The scene is freed after this render, so take the packed data instead of copying it. */
+    PackedBVH &bvh_pack = static_cast<BVH2 *>(bvh)->pack;
+    pack.nodes.steal_data(bvh_pack.nodes);
+    pack.leaf_nodes.steal_data(bvh_pack.leaf_nodes);
+    pack.object_node.steal_data(bvh_pack.object_node);
+    pack.prim_tri_index.steal_data(bvh_pack.prim_tri_index);
+    pack.prim_tri_verts.steal_data(bvh_pack.prim_tri_verts);
+    pack.prim_type.steal_data(bvh_pack.prim_type);
+    pack.prim_visibility.steal_data(bvh_pack.prim_visibility);
+    pack.prim_index.steal_data(bvh_pack.prim_index);
+    pack.prim_object.steal_data(bvh_pack.prim_object);
+    pack.prim_time.steal_data(bvh_pack.prim_time);
+    pack.prim_tri_soa.steal_data(bvh_pack.prim_tri_soa);
+    pack.prim_tri_soa_index.steal_data(bvh_pack.prim_tri_soa_index);
+    pack.root_index = bvh_pack.root_index;
   }
   else {
     progress.set_status("Updating Scene BVH", "Packing BVH primitives");
@@ -1362,6 +1394,12 @@ void GeometryManager::device_update_bvh(Device *device,
     dscene->prim_time.steal_data(pack.prim_time);
     dscene->prim_time.copy_to_device();
   }
+  if (pack.prim_tri_soa_index.size()) {
+    dscene->prim_tri_soa.steal_data(pack.prim_tri_soa);
+    dscene->prim_tri_soa.copy_to_device();
+    dscene->prim_tri_soa_index.steal_data(pack.prim_tri_soa_index);
+    dscene->prim_tri_soa_index.copy_to_device();
+  }
 
   dscene->data.bvh.root = pack.root_index;
   dscene->data.bvh.use_bvh_steps = (scene->params.num_bvh_time_steps != 0);
@@ -1578,6 +1616,8 @@ void GeometryManager::device_update_preprocess(Device *device, Scene *scene, Pro
     dscene->prim_index.tag_realloc();
     dscene->prim_object.tag_realloc();
     dscene->prim_time.tag_realloc();
+    dscene->prim_tri_soa.tag_realloc();
+    dscene->prim_tri_soa_index.tag_realloc();
 
     if (device_update_flags & DEVICE_MESH_DATA_NEEDS_REALLOC) {
       dscene->tri_vnormal.tag_realloc();
@@ -1944,6 +1984,13 @@ void GeometryManager::device_update(Device *device,
     TaskPool::Summary summary;
     pool.wait_work(&summary);
     VLOG(2) << "Objects BVH build pool statistics:\n" << summary.full_report();
+
+    if (!scene->params.bvh_cache_path.empty() && scene->params.background &&
+        scene->params.bvh_cache_size > 0) {
+      path_cache_limit_size(scene->params.bvh_cache_path,
+                            ".bvh",
+                            (uint64_t)scene->params.bvh_cache_size * 1024 * 1024);
+    }
   }
 
   foreach (Shader *shader, scene->shaders) {
@@ -2035,6 +2082,8 @@ void GeometryManager::device_update(Device *device,
   dscene->prim_index.clear_modified();
   dscene->prim_object.clear_modified();
   dscene->prim_time.clear_modified();
+  dscene->prim_tri_soa.clear_modified();
+  dscene->prim_tri_soa_index.clear_modified();
   dscene->tri_shader.clear_modified();
   dscene->tri_vindex.clear_modified();
   dscene->tri_patch.clear_modified();
@@ -2062,6 +2111,8 @@ void GeometryManager::device_free(Device *device, DeviceScene *dscene, bool forc
   dscene->prim_index.free_if_need_realloc(force_free);
   dscene->prim_object.free_if_need_realloc(force_free);
   dscene->prim_time.free_if_need_realloc(force_free);
+  dscene->prim_tri_soa.free_if_need_realloc(force_free);
+  dscene->prim_tri_soa_index.free_if_need_realloc(force_free);
   dscene->tri_shader.free_if_need_realloc(force_free);
   dscene->tri_vnormal.free_if_need_realloc(force_free);
   dscene->tri_vindex.free_if_need_realloc(force_free);
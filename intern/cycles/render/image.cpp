@@ -32,6 +32,8 @@
 #include "util/util_texture.h"
 #include "util/util_unique_ptr.h"
 
+#include <OpenImageIO/texture.h>
+
 #ifdef WITH_OSL
 #  include <OSL/oslexec.h>
 #endif
@@ -77,6 +79,8 @@ const char *name_from_type(ImageDataType type)
       return "nanovdb_float";
     case IMAGE_DATA_TYPE_NANOVDB_FLOAT3:
       return "nanovdb_float3";
+    case IMAGE_DATA_TYPE_TEXTURE_CACHE:
+      return "texture_cache";
     case IMAGE_DATA_NUM_TYPES:
       assert(!"System enumerator type, should never be used");
       return "";
@@ -218,6 +222,7 @@ ImageMetaData::ImageMetaData()
       type(IMAGE_DATA_NUM_TYPES),
       colorspace(u_colorspace_raw),
       colorspace_file_format(""),
+      is_tiled(false),
       use_transform_3d(false),
       compress_as_srgb(false)
 {
@@ -305,6 +310,9 @@ ImageManager::ImageManager(const DeviceInfo &info)
   /* Set image limits */
   features.has_half_float = info.has_half_images;
   features.has_nanovdb = info.has_nanovdb;
+
+  texture_cache_supported = (info.type == DEVICE_CPU);
+  texture_cache = NULL;
 }
 
 ImageManager::~ImageManager()
@@ -477,7 +485,7 @@ void ImageManager::remove_image_user(int slot)
     need_update_ = true;
 }
 
-static bool image_associate_alpha(ImageManager::Image *img)
+static bool image_associate_alpha(const ImageManager::Image *img)
 {
   /* For typical RGBA images we let OIIO convert to associated alpha,
    * but some types we want to leave the RGB channels untouched. */
@@ -486,6 +494,68 @@ static bool image_associate_alpha(ImageManager::Image *img)
            img->params.alpha_type == IMAGE_ALPHA_CHANNEL_PACKED);
 }
 
+/* Per pixel processing after reading the file: alpha and color space conversion, and removal of
+ * invalid values. Runs in parallel over chunks of pixels. */
+template<TypeDesc::BASETYPE FileFormat, typename StorageType>
+static void image_convert_pixels(const ImageManager::Image *img,
+                                 StorageType *pixels,
+                                 const size_t num_pixels,
+                                 const bool is_rgba)
+{
+  const bool ignore_alpha = is_rgba && img->params.alpha_type == IMAGE_ALPHA_IGNORE;
+  const bool convert_colorspace = is_rgba && img->metadata.colorspace != u_colorspace_raw &&
+                                  img->metadata.colorspace != u_colorspace_srgb;
+  const bool check_finite = (FileFormat == TypeDesc::FLOAT);
+
+  if (!(ignore_alpha || convert_colorspace || check_finite)) {
+    return;
+  }
+
+  const size_t channels = is_rgba ? 4 : 1;
+  const StorageType one = util_image_cast_from_float<StorageType>(1.0f);
+
+  static const size_t PIXELS_PER_TASK = 65536;
+  parallel_for(blocked_range<size_t>(0, num_pixels, PIXELS_PER_TASK),
+               [&](const blocked_range<size_t> &r) {
+                 StorageType *chunk = pixels + r.begin() * channels;
+                 const size_t chunk_size = r.size();
+
+                 /* Disable alpha if requested by the user. */
+                 if (ignore_alpha) {
+                   for (size_t i = 0; i < chunk_size; i++) {
+                     chunk[i * 4 + 3] = one;
+                   }
+                 }
+
+                 if (convert_colorspace) {
+                   /* Convert to scene linear. */
+                   ColorSpaceManager::to_scene_linear(img->metadata.colorspace,
+                                                      chunk,
+                                                      chunk_size,
+                                                      img->metadata.compress_as_srgb);
+                 }
+
+                 /* Make sure we don't have buggy values. */
+                 if (check_finite) {
+                   for (size_t i = 0; i < chunk_size; i++) {
+                     StorageType *pixel = &chunk[i * channels];
+                     bool is_finite = true;
+                     for (size_t c = 0; c < channels; c++) {
+                       is_finite &= isfinite(pixel[c]);
+                     }
+                     /* For RGBA buffers we put all channels to 0 if either of them is not
+                      * finite. This way we avoid possible artifacts caused by fully changed
+                      * hue. */
+                     if (!is_finite) {
+                       for (size_t c = 0; c < channels; c++) {
+                         pixel[c] = 0;
+                       }
+                     }
+                   }
+                 }
+               });
+}
+
 template<TypeDesc::BASETYPE FileFormat, typename StorageType>
 bool ImageManager::file_load_image(Image *img, int texture_limit)
 {
@@ -565,48 +635,10 @@ bool ImageManager::file_load_image(Image *img, int texture_limit)
         pixels[i * 4 + 0] = pixels[i];
       }
     }
-
-    /* Disable alpha if requested by the user. */
-    if (img->params.alpha_type == IMAGE_ALPHA_IGNORE) {
-      for (size_t i = num_pixels - 1, pixel = 0; pixel < num_pixels; pixel++, i--) {
-        pixels[i * 4 + 3] = one;
-      }
-    }
-
-    if (img->metadata.colorspace != u_colorspace_raw &&
-        img->metadata.colorspace != u_colorspace_srgb) {
-      /* Convert to scene linear. */
-      ColorSpaceManager::to_scene_linear(
-          img->metadata.colorspace, pixels, num_pixels, img->metadata.compress_as_srgb);
-    }
   }
 
-  /* Make sure we don't have buggy values. */
-  if (FileFormat == TypeDesc::FLOAT) {
-    /* For RGBA buffers we put all channels to 0 if either of them is not
-     * finite. This way we avoid possible artifacts caused by fully changed
-     * hue. */
-    if (is_rgba) {
-      for (size_t i = 0; i < num_pixels; i += 4) {
-        StorageType *pixel = &pixels[i * 4];
-        if (!isfinite(pixel[0]) || !isfinite(pixel[1]) || !isfinite(pixel[2]) ||
-            !isfinite(pixel[3])) {
-          pixel[0] = 0;
-          pixel[1] = 0;
-          pixel[2] = 0;
-          pixel[3] = 0;
-        }
-      }
-    }
-    else {
-      for (size_t i = 0; i < num_pixels; ++i) {
-        StorageType *pixel = &pixels[i];
-        if (!isfinite(pixel[0])) {
-          pixel[0] = 0;
-        }
-      }
-    }
-  }
+  /* Convert pixels in parallel, for large images this takes longer than reading the file. */
+  image_convert_pixels<FileFormat>(img, pixels, num_pixels, is_rgba);
 
   /* Scale image down if needed. */
   if (pixels_storage.size() > 0) {
@@ -657,6 +689,11 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
   load_image_metadata(img);
   ImageDataType type = img->metadata.type;
 
+  /* Read tiles of the image on demand instead of loading all pixels. */
+  if (texture_cache_use(img, scene)) {
+    type = IMAGE_DATA_TYPE_TEXTURE_CACHE;
+  }
+
   /* Name for debugging. */
   img->mem_name = string_printf("__tex_image_%s_%03d", name_from_type(type), slot);
 
@@ -757,6 +794,9 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
       pixels[0] = TEX_IMAGE_MISSING_R;
     }
   }
+  else if (type == IMAGE_DATA_TYPE_TEXTURE_CACHE) {
+    texture_cache_load_image(img);
+  }
 #ifdef WITH_NANOVDB
   else if (type == IMAGE_DATA_TYPE_NANOVDB_FLOAT || type == IMAGE_DATA_TYPE_NANOVDB_FLOAT3) {
     thread_scoped_lock device_lock(device_mutex);
@@ -794,6 +834,11 @@ void ImageManager::device_free_image(Device *, int slot)
 #endif
   }
 
+  if (texture_cache && img->mem && img->mem->info.data_type == IMAGE_DATA_TYPE_TEXTURE_CACHE) {
+    /* Free cached tiles, and make sure the file is read again if it changes. */
+    ((OIIO::TextureSystem *)texture_cache)->invalidate(img->loader->osl_filepath());
+  }
+
   if (img->mem) {
     thread_scoped_lock device_lock(device_mutex);
     delete img->mem;
@@ -816,6 +861,8 @@ void ImageManager::device_update(Device *device, Scene *scene, Progress &progres
     }
   });
 
+  texture_cache_init(scene);
+
   TaskPool pool;
   for (size_t slot = 0; slot < images.size(); slot++) {
     Image *img = images[slot];
@@ -882,6 +929,8 @@ void ImageManager::device_free(Device *device)
     device_free_image(device, slot);
   }
   images.clear();
+
+  texture_cache_free();
 }
 
 void ImageManager::collect_statistics(RenderStats *stats)
@@ -890,6 +939,105 @@ void ImageManager::collect_statistics(RenderStats *stats)
     stats->image.textures.add_entry(
         NamedSizeEntry(image->loader->name(), image->mem->memory_size()));
   }
+
+  if (texture_cache) {
+    OIIO::TextureSystem *ts = (OIIO::TextureSystem *)texture_cache;
+    float max_memory_MB = 0.0f;
+    long long memory_used = 0;
+    long long find_tile_calls = 0;
+    int find_tile_cache_misses = 0;
+    ts->getattribute("max_memory_MB", TypeDesc::FLOAT, &max_memory_MB);
+    ts->getattribute("stat:cache_memory_used", TypeDesc::INT64, &memory_used);
+    ts->getattribute("stat:find_tile_calls", TypeDesc::INT64, &find_tile_calls);
+    ts->getattribute("stat:find_tile_cache_misses", TypeDesc::INT, &find_tile_cache_misses);
+
+    TextureCacheStats &cache_stats = stats->image.texture_cache;
+    cache_stats.memory_limit = (size_t)max_memory_MB * 1024 * 1024;
+    cache_stats.memory_used = memory_used;
+    cache_stats.tile_misses = find_tile_cache_misses;
+    cache_stats.tile_hits = find_tile_calls - find_tile_cache_misses;
+  }
+}
+
+/* Texture Cache
+ *
+ * Instead of loading all pixels into memory, tiled image files can be read on demand by the CPU
+ * kernel through an OpenImageIO texture system. Its memory budget bounds the memory used by these
+ * images, tiles that were not used recently are freed when needed. */
+
+void ImageManager::texture_cache_init(Scene *scene)
+{
+  if (texture_cache || !texture_cache_supported || scene->params.texture_cache_size <= 0) {
+    return;
+  }
+
+  /* With OSL, image files are already read on demand through the OSL texture system. */
+  if (osl_texture_system) {
+    return;
+  }
+
+  OIIO::TextureSystem *ts = OIIO::TextureSystem::create(false);
+  ts->attribute("max_memory_MB", (float)scene->params.texture_cache_size);
+  /* Match images loaded into memory, which are expanded from gray to RGB. */
+  ts->attribute("gray_to_rgb", 1);
+  /* Untiled files are loaded into memory instead, see texture_cache_use(). */
+  ts->attribute("autotile", 0);
+  texture_cache = ts;
+
+  VLOG(1) << "Texture cache enabled, memory limit " << scene->params.texture_cache_size << " MB.";
+}
+
+void ImageManager::texture_cache_free()
+{
+  if (texture_cache) {
+    OIIO::TextureSystem::destroy((OIIO::TextureSystem *)texture_cache);
+    texture_cache = NULL;
+  }
+}
+
+bool ImageManager::texture_cache_use(const Image *img, Scene *scene) const
+{
+  if (texture_cache == NULL) {
+    return false;
+  }
+
+  /* Only tiled files benefit from being read on demand, and the cache reads from files. */
+  const ImageMetaData &metadata = img->metadata;
+  if (!metadata.is_tiled || img->loader->osl_filepath().empty()) {
+    return false;
+  }
+
+  /* Conversions done while loading pixels into memory are not available for cached images. */
+  if (!(metadata.channels == 1 || metadata.channels == 3 || metadata.channels == 4)) {
+    return false;
+  }
+  if (!image_associate_alpha(img)) {
+    return false;
+  }
+  if (metadata.colorspace != u_colorspace_raw && metadata.colorspace != u_colorspace_srgb) {
+    return false;
+  }
+
+  /* Images larger than the texture limit are scaled down while loading. */
+  const int texture_limit = scene->params.texture_limit;
+  if (texture_limit > 0 && max(metadata.width, metadata.height) > (size_t)texture_limit) {
+    return false;
+  }
+
+  return true;
+}
+
+void ImageManager::texture_cache_load_image(Image *img)
+{
+  OIIO::TextureSystem *ts = (OIIO::TextureSystem *)texture_cache;
+  OIIO::TextureSystem::TextureHandle *handle = ts->get_texture_handle(
+      img->loader->osl_filepath());
+
+  thread_scoped_lock device_lock(device_mutex);
+  TextureCacheImage *cache_image = (TextureCacheImage *)img->mem->alloc(
+      sizeof(TextureCacheImage), 0);
+  cache_image->texture_system = ts;
+  cache_image->handle = handle;
 }
 
 void ImageManager::tag_update()
@@ -84,6 +84,9 @@ class ImageMetaData {
   ustring colorspace;
   const char *colorspace_file_format;
 
+  /* Optional, file is stored in tiles that can be read on demand. */
+  bool is_tiled;
+
   /* Optional transform for 3D images. */
   bool use_transform_3d;
   Transform transform_3d;
@@ -229,6 +232,10 @@ class ImageManager {
   vector<Image *> images;
   void *osl_texture_system;
 
+  /* OIIO::TextureSystem used to read tiled images on demand, CPU rendering only. */
+  bool texture_cache_supported;
+  void *texture_cache;
+
   int add_image_slot(ImageLoader *loader, const ImageParams &params, const bool builtin);
   void add_image_user(int slot);
   void remove_image_user(int slot);
@@ -241,6 +248,11 @@ class ImageManager {
   void device_load_image(Device *device, Scene *scene, int slot, Progress *progress);
   void device_free_image(Device *device, int slot);
 
+  void texture_cache_init(Scene *scene);
+  void texture_cache_free();
+  bool texture_cache_use(const Image *img, Scene *scene) const;
+  void texture_cache_load_image(Image *img);
+
   friend class ImageHandle;
 };
 
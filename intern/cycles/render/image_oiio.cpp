@@ -98,6 +98,9 @@ bool OIIOImageLoader::load_metadata(const ImageDeviceFeatures &features, ImageMe
 
   metadata.colorspace_file_format = in->format_name();
 
+  /* Tiled 2D files can be read on demand by the texture cache. */
+  metadata.is_tiled = spec.tile_width > 0 && spec.tile_height > 0 && spec.depth <= 1;
+
   in->close();
 
   return true;
@@ -211,6 +214,7 @@ bool OIIOImageLoader::load_pixels(const ImageMetaData &metadata,
       break;
     case IMAGE_DATA_TYPE_NANOVDB_FLOAT:
     case IMAGE_DATA_TYPE_NANOVDB_FLOAT3:
+    case IMAGE_DATA_TYPE_TEXTURE_CACHE:
     case IMAGE_DATA_NUM_TYPES:
       break;
   }
@@ -670,7 +670,13 @@ void ObjectManager::device_update(Device *device,
 
   /* prepare for static BVH building */
   /* todo: do before to support getting object level coords? */
-  if (scene->params.bvh_type == SceneParams::BVH_STATIC) {
+  /* When caching BVHs on disk, keep geometry in object space so each gets its own BVH that can
+   * be reused by later renders. */
+  const bool use_bvh_cache = !scene->params.bvh_cache_path.empty() &&
+                             BVHParams::best_bvh_layout(scene->params.bvh_layout,
+                                                        device->get_bvh_layout_mask()) ==
+                                 BVH_LAYOUT_BVH2;
+  if (scene->params.bvh_type == SceneParams::BVH_STATIC && !use_bvh_cache) {
     scoped_callback_timer timer([scene](double time) {
       if (scene->update_stats) {
         scene->update_stats->object.times.add_entry(
@@ -81,6 +81,8 @@ class DeviceScene {
   device_vector<int> prim_index;
   device_vector<int> prim_object;
   device_vector<float2> prim_time;
+  device_vector<float4> prim_tri_soa;
+  device_vector<uint> prim_tri_soa_index;
 
   /* mesh */
   device_vector<uint> tri_shader;
@@ -179,8 +181,18 @@ class SceneParams {
   int hair_subdivisions;
   CurveShapeType hair_shape;
   int texture_limit;
+  /* Memory budget in megabytes for reading tiled image files on demand, 0 to load all images into
+   * memory. Only supported for CPU rendering. */
+  int texture_cache_size;
+  /* Directory to cache BVHs of geometry on disk, empty to disable. Only used for BVH2. */
+  string bvh_cache_path;
+  /* Maximum size of the BVH cache directory in megabytes, least recently written files are
+   * removed when it grows larger. */
+  int bvh_cache_size;
 
   bool background;
+  /* Scene is kept for rendering the next frame of a background render. */
+  bool use_persistent_data;
 
   SceneParams()
   {
@@ -193,7 +205,10 @@ class SceneParams {
     hair_subdivisions = 3;
     hair_shape = CURVE_RIBBON;
     texture_limit = 0;
+    texture_cache_size = 0;
+    bvh_cache_size = 0;
     background = true;
+    use_persistent_data = false;
   }
 
   bool modified(const SceneParams &params)
@@ -204,7 +219,10 @@ class SceneParams {
              use_bvh_unaligned_nodes == params.use_bvh_unaligned_nodes &&
              num_bvh_time_steps == params.num_bvh_time_steps &&
              hair_subdivisions == params.hair_subdivisions && hair_shape == params.hair_shape &&
-             texture_limit == params.texture_limit);
+             texture_limit == params.texture_limit &&
+             texture_cache_size == params.texture_cache_size &&
+             bvh_cache_path == params.bvh_cache_path &&
+             bvh_cache_size == params.bvh_cache_size);
   }
 
   int curve_subdivisions()
@@ -238,6 +238,36 @@ string MeshStats::full_report(int indent_level)
   return result;
 }
 
+/* Texture cache statistics. */
+
+TextureCacheStats::TextureCacheStats()
+    : memory_limit(0), memory_used(0), tile_hits(0), tile_misses(0)
+{
+}
+
+string TextureCacheStats::full_report(int indent_level)
+{
+  const string indent(indent_level * kIndentNumSpaces, ' ');
+  const uint64_t tile_lookups = tile_hits + tile_misses;
+  const double hit_rate = (tile_lookups > 0) ? (double)tile_hits / tile_lookups : 0.0;
+  string result = "";
+  result += string_printf("%sMemory used: %s (%s)\n",
+                          indent.c_str(),
+                          string_human_readable_size(memory_used).c_str(),
+                          string_human_readable_number(memory_used).c_str());
+  result += string_printf("%sMemory limit: %s (%s)\n",
+                          indent.c_str(),
+                          string_human_readable_size(memory_limit).c_str(),
+                          string_human_readable_number(memory_limit).c_str());
+  result += string_printf("%sTile hits: %s (%.2f%%)\n",
+                          indent.c_str(),
+                          string_human_readable_number(tile_hits).c_str(),
+                          hit_rate * 100.0);
+  result += string_printf(
+      "%sTile misses: %s\n", indent.c_str(), string_human_readable_number(tile_misses).c_str());
+  return result;
+}
+
 /* Image statistics. */
 
 ImageStats::ImageStats()
@@ -249,6 +279,9 @@ string ImageStats::full_report(int indent_level)
   const string indent(indent_level * kIndentNumSpaces, ' ');
   string result = "";
   result += indent + "Textures:\n" + textures.full_report(indent_level + 1);
+  if (texture_cache.memory_limit > 0) {
+    result += indent + "Texture cache:\n" + texture_cache.full_report(indent_level + 1);
+  }
   return result;
 }
 
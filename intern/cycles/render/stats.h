@@ -162,6 +162,23 @@ class MeshStats {
   NamedSizeStats geometry;
 };
 
+/* Statistics about the texture cache, which reads tiles of images on demand. */
+class TextureCacheStats {
+ public:
+  TextureCacheStats();
+
+  /* Generate full human-readable report. */
+  string full_report(int indent_level = 0);
+
+  /* Memory budget of the cache, zero when the cache is not used. */
+  size_t memory_limit;
+  size_t memory_used;
+
+  /* Tile lookups that were found in the cache and that had to be read from disk. */
+  uint64_t tile_hits;
+  uint64_t tile_misses;
+};
+
 /* Statistics about images held in memory. */
 class ImageStats {
  public:
@@ -171,6 +188,7 @@ class ImageStats {
   string full_report(int indent_level = 0);
 
   NamedSizeStats textures;
+  TextureCacheStats texture_cache;
 };
 
 /* Render process statistics. */
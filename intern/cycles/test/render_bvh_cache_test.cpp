@@ -0,0 +1,199 @@
+/*
+ * Copyright 2011-2021 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "bvh/bvh2.h"
+
+#include "util/util_path.h"
+#include "util/util_string.h"
+#include "util/util_vector.h"
+
+#ifndef _WIN32
+#  include <utime.h>
+#endif
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+/* Gives access to the cache functions, the BVH is filled with arbitrary data instead of being
+ * built from geometry. */
+class TestBVH2 : public BVH2 {
+ public:
+  TestBVH2() : BVH2(BVHParams(), vector<Geometry *>(), vector<Object *>())
+  {
+  }
+
+  using BVH2::cache_read;
+  using BVH2::cache_write;
+
+  void fill()
+  {
+    const size_t num_nodes = 12, num_leaf_nodes = 7, num_prims = 5;
+
+    for (size_t i = 0; i < num_nodes; i++) {
+      pack.nodes.push_back_slow(make_int4(i, i + 1, -(int)i, 1));
+    }
+    for (size_t i = 0; i < num_leaf_nodes; i++) {
+      pack.leaf_nodes.push_back_slow(make_int4(-(int)i, i, 2 * i, 0));
+    }
+    for (size_t i = 0; i < num_prims; i++) {
+      pack.prim_tri_index.push_back_slow(i * 3);
+      pack.prim_tri_verts.push_back_slow(make_float4(i, 0.0f, 1.0f, 0.0f));
+      pack.prim_type.push_back_slow(1);
+      pack.prim_visibility.push_back_slow(~0u);
+      pack.prim_index.push_back_slow(i);
+      pack.prim_object.push_back_slow(0);
+      pack.prim_time.push_back_slow(make_float2(0.0f, 1.0f));
+    }
+    pack.root_index = 0;
+
+    own_nodes_size = num_nodes;
+    own_leaf_nodes_size = num_leaf_nodes;
+    own_prims_size = num_prims;
+    build_sah_cost = 42.0f;
+  }
+};
+
+string test_cache_filepath(const string &name)
+{
+  return path_join(testing::TempDir(), "render_bvh_cache_test_" + name);
+}
+
+void truncate_file(const string &filepath, size_t size)
+{
+  vector<uint8_t> binary;
+  ASSERT_TRUE(path_read_binary(filepath, binary));
+  ASSERT_LT(size, binary.size());
+  binary.resize(size);
+  ASSERT_TRUE(path_write_binary(filepath, binary));
+}
+
+}  // namespace
+
+TEST(render_bvh_cache, round_trip)
+{
+  const string filepath = test_cache_filepath("round_trip.bvh");
+
+  TestBVH2 written;
+  written.fill();
+  ASSERT_TRUE(written.cache_write(filepath));
+
+  TestBVH2 read;
+  ASSERT_TRUE(read.cache_read(filepath));
+  path_remove(filepath);
+
+  EXPECT_EQ(read.pack.root_index, written.pack.root_index);
+  EXPECT_TRUE(read.pack.nodes == written.pack.nodes);
+  EXPECT_TRUE(read.pack.leaf_nodes == written.pack.leaf_nodes);
+  EXPECT_TRUE(read.pack.object_node == written.pack.object_node);
+  EXPECT_TRUE(read.pack.prim_tri_index == written.pack.prim_tri_index);
+  EXPECT_TRUE(read.pack.prim_tri_verts == written.pack.prim_tri_verts);
+  EXPECT_TRUE(read.pack.prim_type == written.pack.prim_type);
+  EXPECT_TRUE(read.pack.prim_visibility == written.pack.prim_visibility);
+  EXPECT_TRUE(read.pack.prim_index == written.pack.prim_index);
+  EXPECT_TRUE(read.pack.prim_object == written.pack.prim_object);
+  EXPECT_TRUE(read.pack.prim_time == written.pack.prim_time);
+  EXPECT_TRUE(read.can_refit());
+}
+
+TEST(render_bvh_cache, missing_file)
+{
+  TestBVH2 read;
+  EXPECT_FALSE(read.cache_read(test_cache_filepath("missing.bvh")));
+  EXPECT_EQ(read.pack.nodes.size(), 0);
+}
+
+TEST(render_bvh_cache, truncated_file)
+{
+  const string filepath = test_cache_filepath("truncated.bvh");
+
+  TestBVH2 written;
+  written.fill();
+  ASSERT_TRUE(written.cache_write(filepath));
+  truncate_file(filepath, path_file_size(filepath) - 1);
+
+  TestBVH2 read;
+  EXPECT_FALSE(read.cache_read(filepath));
+  path_remove(filepath);
+
+  /* Partially read data is discarded. */
+  EXPECT_EQ(read.pack.nodes.size(), 0);
+  EXPECT_EQ(read.pack.leaf_nodes.size(), 0);
+  EXPECT_EQ(read.pack.prim_index.size(), 0);
+  EXPECT_FALSE(read.can_refit());
+}
+
+TEST(render_bvh_cache, corrupted_header)
+{
+  const string filepath = test_cache_filepath("corrupted.bvh");
+
+  TestBVH2 written;
+  written.fill();
+  ASSERT_TRUE(written.cache_write(filepath));
+
+  vector<uint8_t> binary;
+  ASSERT_TRUE(path_read_binary(filepath, binary));
+  binary[0] ^= 0xff;
+  ASSERT_TRUE(path_write_binary(filepath, binary));
+
+  TestBVH2 read;
+  EXPECT_FALSE(read.cache_read(filepath));
+  path_remove(filepath);
+
+  EXPECT_EQ(read.pack.nodes.size(), 0);
+  EXPECT_FALSE(read.can_refit());
+}
+
+#ifndef _WIN32
+TEST(render_bvh_cache, limit_size)
+{
+  const string dir = test_cache_filepath("limit_size");
+  const vector<uint8_t> binary(100, 0);
+
+  /* Files from oldest to newest, and one that does not belong to the cache. */
+  const string filepaths[3] = {
+      path_join(dir, "a.bvh"), path_join(dir, "b.bvh"), path_join(dir, "c.bvh")};
+  const string other_filepath = path_join(dir, "other.txt");
+
+  path_create_directories(filepaths[0]);
+  for (int i = 0; i < 3; i++) {
+    ASSERT_TRUE(path_write_binary(filepaths[i], binary));
+    struct utimbuf times;
+    times.actime = times.modtime = 1000 * (i + 1);
+    ASSERT_EQ(utime(filepaths[i].c_str(), &times), 0);
+  }
+  ASSERT_TRUE(path_write_binary(other_filepath, binary));
+
+  /* The oldest file was used recently, so the next oldest is removed instead. */
+  ASSERT_TRUE(path_touch(filepaths[0]));
+
+  path_cache_limit_size(dir, ".bvh", 250);
+
+  EXPECT_TRUE(path_exists(filepaths[0]));
+  EXPECT_FALSE(path_exists(filepaths[1]));
+  EXPECT_TRUE(path_exists(filepaths[2]));
+  EXPECT_TRUE(path_exists(other_filepath));
+
+  path_remove(filepaths[0]);
+  path_remove(filepaths[2]);
+  path_remove(other_filepath);
+  path_remove(dir);
+}
+#endif
+
+CCL_NAMESPACE_END
@@ -32,7 +32,8 @@ DebugFlags::CPU::CPU()
       sse3(true),
       sse2(true),
       bvh_layout(BVH_LAYOUT_AUTO),
-      split_kernel(false)
+      split_kernel(false),
+      bvh_triangle_soa(true)
 {
   reset();
 }
@@ -60,6 +61,8 @@ void DebugFlags::CPU::reset()
   bvh_layout = BVH_LAYOUT_AUTO;
 
   split_kernel = false;
+
+  bvh_triangle_soa = true;
 }
 
 DebugFlags::CUDA::CUDA() : adaptive_compile(false), split_kernel(false)
@@ -143,7 +146,8 @@ std::ostream &operator<<(std::ostream &os, DebugFlagsConstRef debug_flags)
      << "  SSE3       : " << string_from_bool(debug_flags.cpu.sse3) << "\n"
      << "  SSE2       : " << string_from_bool(debug_flags.cpu.sse2) << "\n"
      << "  BVH layout : " << bvh_layout_name(debug_flags.cpu.bvh_layout) << "\n"
-     << "  Split      : " << string_from_bool(debug_flags.cpu.split_kernel) << "\n";
+     << "  Split      : " << string_from_bool(debug_flags.cpu.split_kernel) << "\n"
+     << "  Tri SoA    : " << string_from_bool(debug_flags.cpu.bvh_triangle_soa) << "\n";
 
   os << "CUDA flags:\n"
      << "  Adaptive Compile : " << string_from_bool(debug_flags.cuda.adaptive_compile) << "\n";
@@ -82,6 +82,10 @@ class DebugFlags {
 
     /* Whether split kernel is used */
     bool split_kernel;
+
+    /* Whether triangles of BVH2 leaf nodes are also stored in groups of four, to intersect them
+     * with SIMD instructions. Uses more memory. */
+    bool bvh_triangle_soa;
   };
 
   /* Descriptor of CUDA feature-set to be used. */
@@ -64,6 +64,8 @@ bool path_read_text(const string &path, string &text);
 
 /* File manipulation. */
 bool path_remove(const string &path);
+/* Set the modification time of an existing file to the current time. */
+bool path_touch(const string &path);
 
 /* source code utility */
 string path_source_replace_includes(const string &source,
@@ -72,6 +74,10 @@ string path_source_replace_includes(const string &source,
 
 /* cache utility */
 void path_cache_clear_except(const string &name, const set<string> &except);
+/* Remove the least recently modified files ending with suffix from the directory, until the
+ * total size of these files is at most max_size bytes. Use path_touch() to mark files that are
+ * read as recently used. */
+void path_cache_limit_size(const string &dir, const string &suffix, uint64_t max_size);
 
 CCL_NAMESPACE_END
 
@@ -59,6 +59,7 @@ typedef enum ImageDataType {
   IMAGE_DATA_TYPE_USHORT = 7,
   IMAGE_DATA_TYPE_NANOVDB_FLOAT = 8,
   IMAGE_DATA_TYPE_NANOVDB_FLOAT3 = 9,
+  IMAGE_DATA_TYPE_TEXTURE_CACHE = 10,
 
   IMAGE_DATA_NUM_TYPES
 } ImageDataType;
@@ -108,6 +109,16 @@ typedef struct TextureInfo {
   Transform transform_3d;
 } TextureInfo;
 
+#ifndef __KERNEL_GPU__
+/* Image that is read on demand through the texture cache, only supported on the CPU. Textures of
+ * type IMAGE_DATA_TYPE_TEXTURE_CACHE store this instead of pixels. */
+typedef struct TextureCacheImage {
+  /* OIIO::TextureSystem and its OIIO::TextureSystem::TextureHandle for the image file. */
+  void *texture_system;
+  void *handle;
+} TextureCacheImage;
+#endif
+
 CCL_NAMESPACE_END
 
 #endif /* __UTIL_TEXTURE_H__ */
@@ -2022,6 +2022,9 @@ class SEQUENCER_PT_view(SequencerButtonsPanel_Output, Panel):
         col = layout.column()
         if ed:
             col.prop(ed, "use_prefetch")
+            sub = col.column()
+            sub.active = ed.use_prefetch
+            sub.prop(ed, "prefetch_workers", text="Workers")
 
         col.prop(st, "display_channel", text="Channel")
 
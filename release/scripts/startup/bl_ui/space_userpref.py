@@ -634,6 +634,12 @@ class USERPREF_PT_system_memory(SystemPanel, CenterAlignMixIn, Panel):
         col.prop(system, "vbo_time_out", text="Vbo Time Out")
         col.prop(system, "vbo_collection_rate", text="Garbage Collection Rate")
 
+        if prefs.experimental.use_geometry_nodes_cache:
+            layout.separator()
+
+            col = layout.column()
+            col.prop(system, "geometry_nodes_cache_limit")
+
 
 class USERPREF_PT_system_video_sequencer(SystemPanel, CenterAlignMixIn, Panel):
     bl_label = "Video Sequencer"
@@ -2243,6 +2249,8 @@ class USERPREF_PT_experimental_new_features(ExperimentalPanel, Panel):
                 ({"property": "use_sculpt_tools_tilt"}, "T82877"),
                 ({"property": "use_asset_browser"}, ("project/profile/124/", "Milestone 1")),
                 ({"property": "use_override_templates"}, ("T73318", "Milestone 4")),
+                ({"property": "use_geometry_nodes_multithreading"}, None),
+                ({"property": "use_geometry_nodes_cache"}, None),
             ),
         )
 
@@ -74,6 +74,12 @@ typedef enum eCDAllocType {
   CD_REFERENCE = 3,
   /** Do a full copy of all layers, only allowed if source has same number of elements. */
   CD_DUPLICATE = 4,
+  /**
+   * Share the data of the source layers, the data is copied on the first write access through
+   * the `CustomData_duplicate_referenced_layer` functions. Falls back to #CD_REFERENCE for
+   * source layers which don't own their data.
+   */
+  CD_SHARE = 5,
 } eCDAllocType;
 
 #define CD_TYPE_AS_MASK(_type) (CustomDataMask)((CustomDataMask)1 << (CustomDataMask)(_type))
@@ -105,10 +111,19 @@ bool CustomData_has_interp(const struct CustomData *data);
 bool CustomData_bmesh_has_free(const struct CustomData *data);
 
 /**
- * Checks if any of the customdata layers is referenced.
+ * Checks if any of the customdata layers is referenced or shared.
  */
 bool CustomData_has_referenced(const struct CustomData *data);
 
+/**
+ * Statistics about layer data shared with #CD_SHARE: the number of shared buffers, the number of
+ * layers using them and the memory that was not allocated because of the sharing.
+ */
+void CustomData_sharing_stats(int *r_sharings_num,
+                              int *r_users_num,
+                              size_t *r_size_shared,
+                              size_t *r_size_saved);
+
 /* copies the "value" (e.g. mloopuv uv or mloopcol colors) from one block to
  * another, while not overwriting anything else (e.g. flags).  probably only
  * implemented for mloopuv/mloopcol, for now.*/
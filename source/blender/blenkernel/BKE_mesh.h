@@ -303,6 +303,8 @@ void BKE_mesh_calc_normals_poly(struct MVert *mverts,
                                 int numPolys,
                                 float (*r_polyNors)[3],
                                 const bool only_face_normals);
+void BKE_mesh_ensure_own_verts(struct Mesh *mesh);
+void BKE_mesh_calc_normals_poly_ensure_verts(struct Mesh *mesh, float (*r_polynors)[3]);
 void BKE_mesh_calc_normals(struct Mesh *me);
 void BKE_mesh_ensure_normals(struct Mesh *me);
 void BKE_mesh_ensure_normals_for_display(struct Mesh *mesh);
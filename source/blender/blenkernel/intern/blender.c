@@ -57,6 +57,8 @@
 
 #include "DEG_depsgraph.h"
 
+#include "MOD_nodes.h"
+
 #include "RE_pipeline.h"
 #include "RE_texture.h"
 
@@ -101,6 +103,8 @@ void BKE_blender_free(void)
   IMB_moviecache_destruct();
 
   BKE_node_system_exit();
+
+  MOD_nodes_cache_free();
 }
 
 /** \} */
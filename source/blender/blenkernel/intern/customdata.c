@@ -26,6 +26,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 /* Since we have versioning code here (CustomData_verify_versions()). */
 #define DNA_DEPRECATED_ALLOW
 
@@ -2058,6 +2060,104 @@ void customData_mask_layers__print(const CustomData_MeshMasks *mask)
   }
 }
 
+/* -------------------------------------------------------------------- */
+/* layer data sharing */
+
+/**
+ * Shared ownership of the data of layers in different #CustomData, used to avoid copying the
+ * data of the original mesh into its copy-on-write copy. The last user frees the data, users
+ * that want to modify the data make their own copy first.
+ */
+typedef struct CustomDataLayerSharing {
+  int users;
+  /** Size of the shared data in bytes, only used for statistics. */
+  size_t size;
+} CustomDataLayerSharing;
+
+/* Only data with more than one user counts as shared. */
+static struct {
+  int sharings_num;
+  int users_num;
+  size_t size_shared;
+  size_t size_saved;
+} customdata_sharing_stats = {0};
+
+static bool customdata_layer_is_shared(const CustomDataLayer *layer)
+{
+  return layer->sharing && layer->sharing->users > 1;
+}
+
+/**
+ * Let \a dst_layer share the data of \a src_layer, the data pointer has to be set already.
+ */
+static void customdata_layer_share(CustomDataLayer *src_layer,
+                                   CustomDataLayer *dst_layer,
+                                   const int totelem)
+{
+  BLI_assert(src_layer->data == dst_layer->data);
+  BLI_assert((src_layer->flag & CD_FLAG_NOFREE) == 0);
+
+  if (src_layer->sharing == NULL) {
+    /* Other threads might share the same source layer at the same time. */
+    CustomDataLayerSharing *sharing = MEM_mallocN(sizeof(*sharing), __func__);
+    sharing->users = 1;
+    sharing->size = (size_t)totelem * (size_t)layerType_getInfo(src_layer->type)->size;
+    if (atomic_cas_ptr((void **)&src_layer->sharing, NULL, sharing) != NULL) {
+      MEM_freeN(sharing);
+    }
+  }
+
+  CustomDataLayerSharing *sharing = src_layer->sharing;
+  const int users = atomic_add_and_fetch_int32(&sharing->users, 1);
+  if (users == 2) {
+    atomic_add_and_fetch_int32(&customdata_sharing_stats.sharings_num, 1);
+    atomic_add_and_fetch_int32(&customdata_sharing_stats.users_num, 1);
+    atomic_add_and_fetch_z(&customdata_sharing_stats.size_shared, sharing->size);
+  }
+  atomic_add_and_fetch_int32(&customdata_sharing_stats.users_num, 1);
+  atomic_add_and_fetch_z(&customdata_sharing_stats.size_saved, sharing->size);
+
+  dst_layer->sharing = sharing;
+}
+
+/**
+ * Stop sharing the data of the layer.
+ *
+ * \return True when the layer was the last user, the caller is then responsible for the data.
+ */
+static bool customdata_layer_sharing_release(CustomDataLayer *layer)
+{
+  CustomDataLayerSharing *sharing = layer->sharing;
+  layer->sharing = NULL;
+
+  const int users = atomic_sub_and_fetch_int32(&sharing->users, 1);
+  if (users >= 1) {
+    atomic_sub_and_fetch_int32(&customdata_sharing_stats.users_num, 1);
+    atomic_sub_and_fetch_z(&customdata_sharing_stats.size_saved, sharing->size);
+  }
+  if (users == 1) {
+    atomic_sub_and_fetch_int32(&customdata_sharing_stats.sharings_num, 1);
+    atomic_sub_and_fetch_int32(&customdata_sharing_stats.users_num, 1);
+    atomic_sub_and_fetch_z(&customdata_sharing_stats.size_shared, sharing->size);
+  }
+  if (users == 0) {
+    MEM_freeN(sharing);
+    return true;
+  }
+  return false;
+}
+
+void CustomData_sharing_stats(int *r_sharings_num,
+                              int *r_users_num,
+                              size_t *r_size_shared,
+                              size_t *r_size_saved)
+{
+  *r_sharings_num = customdata_sharing_stats.sharings_num;
+  *r_users_num = customdata_sharing_stats.users_num;
+  *r_size_shared = customdata_sharing_stats.size_shared;
+  *r_size_saved = customdata_sharing_stats.size_saved;
+}
+
 /********************* CustomData functions *********************/
 static void customData_update_offsets(CustomData *data);
 
@@ -2145,6 +2245,7 @@ bool CustomData_merge(const struct CustomData *source,
       case CD_ASSIGN:
       case CD_REFERENCE:
       case CD_DUPLICATE:
+      case CD_SHARE:
         data = layer->data;
         break;
       default:
@@ -2152,12 +2253,29 @@ bool CustomData_merge(const struct CustomData *source,
         break;
     }
 
-    if ((alloctype == CD_ASSIGN) && (flag & CD_FLAG_NOFREE)) {
+    if (ELEM(alloctype, CD_ASSIGN, CD_SHARE) && (flag & CD_FLAG_NOFREE)) {
       newlayer = customData_add_layer__internal(
           dest, type, CD_REFERENCE, data, totelem, layer->name);
     }
+    else if (alloctype == CD_SHARE) {
+      if (data && totelem > 0) {
+        newlayer = customData_add_layer__internal(
+            dest, type, CD_ASSIGN, data, totelem, layer->name);
+        if (newlayer && newlayer->data == data) {
+          customdata_layer_share(layer, newlayer, totelem);
+        }
+      }
+      else {
+        newlayer = customData_add_layer__internal(
+            dest, type, CD_DUPLICATE, data, totelem, layer->name);
+      }
+    }
     else {
       newlayer = customData_add_layer__internal(dest, type, alloctype, data, totelem, layer->name);
+      if (newlayer && alloctype == CD_ASSIGN && newlayer->data == data) {
+        /* The ownership is passed on, including the share of the data. */
+        newlayer->sharing = layer->sharing;
+      }
     }
 
     if (newlayer) {
@@ -2186,6 +2304,23 @@ void CustomData_realloc(CustomData *data, int totelem)
       continue;
     }
     typeInfo = layerType_getInfo(layer->type);
+    if (layer->sharing && layer->data) {
+      /* Shared data can't be reallocated in place, copy the elements that are kept. */
+      void *old_data = layer->data;
+      const int old_totelem = (int)(MEM_allocN_len(old_data) / (size_t)typeInfo->size);
+      if (!customdata_layer_sharing_release(layer)) {
+        const int copy_totelem = MIN2(old_totelem, totelem);
+        layer->data = MEM_calloc_arrayN(
+            (size_t)totelem, typeInfo->size, layerType_getName(layer->type));
+        if (typeInfo->copy) {
+          typeInfo->copy(old_data, layer->data, copy_totelem);
+        }
+        else {
+          memcpy(layer->data, old_data, (size_t)copy_totelem * typeInfo->size);
+        }
+        continue;
+      }
+    }
     layer->data = MEM_reallocN(layer->data, (size_t)totelem * typeInfo->size);
   }
 }
@@ -2209,6 +2344,11 @@ static void customData_free_layer__internal(CustomDataLayer *layer, int totelem)
 {
   const LayerTypeInfo *typeInfo;
 
+  if (layer->sharing && !customdata_layer_sharing_release(layer)) {
+    /* Other users still need the data. */
+    return;
+  }
+
   if (!(layer->flag & CD_FLAG_NOFREE) && layer->data) {
     typeInfo = layerType_getInfo(layer->type);
 
@@ -2583,6 +2723,7 @@ static CustomDataLayer *customData_add_layer__internal(CustomData *data,
   data->layers[index].type = type;
   data->layers[index].flag = flag;
   data->layers[index].data = newlayerdata;
+  data->layers[index].sharing = NULL;
 
   /* Set default name if none exists. Note we only call DATA_()  once
    * we know there is a default name, to avoid overhead of locale lookups
@@ -2752,6 +2893,32 @@ int CustomData_number_of_layers_typemask(const CustomData *data, CustomDataMask
   return number;
 }
 
+static void *customData_duplicate_layer_data(const CustomDataLayer *layer, const int totelem)
+{
+  /* MEM_dupallocN won't work in case of complex layers, like e.g.
+   * CD_MDEFORMVERT, which has pointers to allocated data...
+   * So in case a custom copy function is defined, use it!
+   */
+  const LayerTypeInfo *typeInfo = layerType_getInfo(layer->type);
+
+  if (typeInfo->copy) {
+    void *dst_data = MEM_malloc_arrayN((size_t)totelem, typeInfo->size, "CD duplicate ref layer");
+    typeInfo->copy(layer->data, dst_data, totelem);
+    return dst_data;
+  }
+  return MEM_dupallocN(layer->data);
+}
+
+static void customData_free_layer_data(const int type, void *data, const int totelem)
+{
+  const LayerTypeInfo *typeInfo = layerType_getInfo(type);
+
+  if (typeInfo->free) {
+    typeInfo->free(data, totelem, typeInfo->size);
+  }
+  MEM_freeN(data);
+}
+
 static void *customData_duplicate_referenced_layer_index(CustomData *data,
                                                          const int layer_index,
                                                          const int totelem)
@@ -2763,24 +2930,17 @@ static void *customData_duplicate_referenced_layer_index(CustomData *data,
   CustomDataLayer *layer = &data->layers[layer_index];
 
   if (layer->flag & CD_FLAG_NOFREE) {
-    /* MEM_dupallocN won't work in case of complex layers, like e.g.
-     * CD_MDEFORMVERT, which has pointers to allocated data...
-     * So in case a custom copy function is defined, use it!
-     */
-    const LayerTypeInfo *typeInfo = layerType_getInfo(layer->type);
-
-    if (typeInfo->copy) {
-      void *dst_data = MEM_malloc_arrayN(
-          (size_t)totelem, typeInfo->size, "CD duplicate ref layer");
-      typeInfo->copy(layer->data, dst_data, totelem);
-      layer->data = dst_data;
-    }
-    else {
-      layer->data = MEM_dupallocN(layer->data);
-    }
-
+    layer->data = customData_duplicate_layer_data(layer, totelem);
     layer->flag &= ~CD_FLAG_NOFREE;
   }
+  else if (customdata_layer_is_shared(layer)) {
+    void *shared_data = layer->data;
+    layer->data = customData_duplicate_layer_data(layer, totelem);
+    if (customdata_layer_sharing_release(layer)) {
+      /* The other users released the data in the meantime. */
+      customData_free_layer_data(layer->type, shared_data, totelem);
+    }
+  }
 
   return layer->data;
 }
@@ -2825,7 +2985,7 @@ bool CustomData_is_referenced_layer(struct CustomData *data, int type)
 
   CustomDataLayer *layer = &data->layers[layer_index];
 
-  return (layer->flag & CD_FLAG_NOFREE) != 0;
+  return (layer->flag & CD_FLAG_NOFREE) != 0 || customdata_layer_is_shared(layer);
 }
 
 void CustomData_free_temporary(CustomData *data, int totelem)
@@ -3259,6 +3419,19 @@ const char *CustomData_get_layer_name(const CustomData *data, int type, int n)
   return (layer_index == -1) ? NULL : data->layers[layer_index].name;
 }
 
+/**
+ * The caller takes over the ownership of the previous data of the layer, so shared layers have
+ * to be duplicated with #CustomData_duplicate_referenced_layer first.
+ */
+static void customData_set_layer_data(CustomDataLayer *layer, void *ptr)
+{
+  if (layer->sharing) {
+    BLI_assert(!customdata_layer_is_shared(layer));
+    customdata_layer_sharing_release(layer);
+  }
+  layer->data = ptr;
+}
+
 void *CustomData_set_layer(const CustomData *data, int type, void *ptr)
 {
   /* get the layer index of the first layer of type */
@@ -3268,7 +3441,7 @@ void *CustomData_set_layer(const CustomData *data, int type, void *ptr)
     return NULL;
   }
 
-  data->layers[layer_index].data = ptr;
+  customData_set_layer_data(&data->layers[layer_index], ptr);
 
   return ptr;
 }
@@ -3281,7 +3454,7 @@ void *CustomData_set_layer_n(const struct CustomData *data, int type, int n, voi
     return NULL;
   }
 
-  data->layers[layer_index].data = ptr;
+  customData_set_layer_data(&data->layers[layer_index], ptr);
 
   return ptr;
 }
@@ -3873,7 +4046,7 @@ bool CustomData_has_interp(const struct CustomData *data)
 bool CustomData_has_referenced(const struct CustomData *data)
 {
   for (int i = 0; i < data->totlayer; i++) {
-    if (data->layers[i].flag & CD_FLAG_NOFREE) {
+    if ((data->layers[i].flag & CD_FLAG_NOFREE) || customdata_layer_is_shared(&data->layers[i])) {
       return true;
     }
   }
@@ -4258,7 +4431,9 @@ void CustomData_blend_write_prepare(CustomData *data,
         }
         write_layers_size += chunk_size;
       }
-      write_layers[j++] = *layer;
+      write_layers[j] = *layer;
+      write_layers[j].sharing = NULL;
+      j++;
     }
   }
   BLI_assert(j == data->totlayer);
@@ -5191,6 +5366,7 @@ void CustomData_blend_read(BlendDataReader *reader, CustomData *data, int count)
     }
 
     layer->flag &= ~CD_FLAG_NOFREE;
+    layer->sharing = NULL;
 
     if (CustomData_verify_versions(data, i)) {
       BLO_read_data_address(reader, &layer->data);
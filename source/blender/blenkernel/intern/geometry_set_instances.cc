@@ -20,6 +20,8 @@
 #include "BKE_modifier.h"
 #include "BKE_pointcloud.h"
 
+#include "BLI_task.hh"
+
 #include "DNA_collection_types.h"
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
@@ -324,26 +326,95 @@ void geometry_set_gather_instances_attribute_info(Span<GeometryInstanceGroup> se
   }
 }
 
+/**
+ * Offsets of the first element of an instance group in the joined mesh.
+ */
+struct MeshElementOffsets {
+  int vert = 0;
+  int edge = 0;
+  int loop = 0;
+  int poly = 0;
+};
+
+/**
+ * Returns how many instances should be processed by a single task, so that tasks are not too
+ * small when the instanced geometry is small.
+ */
+static int64_t instances_grain_size(const int elements_per_instance)
+{
+  return std::max(1, 4096 / std::max(elements_per_instance, 1));
+}
+
+static void copy_transformed_mesh(const Mesh &mesh,
+                                  const float4x4 &transform,
+                                  const MeshElementOffsets &offsets,
+                                  Mesh &new_mesh)
+{
+  for (const int i : IndexRange(mesh.totvert)) {
+    const MVert &old_vert = mesh.mvert[i];
+    MVert &new_vert = new_mesh.mvert[offsets.vert + i];
+
+    new_vert = old_vert;
+
+    const float3 new_position = transform * float3(old_vert.co);
+    copy_v3_v3(new_vert.co, new_position);
+  }
+  for (const int i : IndexRange(mesh.totedge)) {
+    const MEdge &old_edge = mesh.medge[i];
+    MEdge &new_edge = new_mesh.medge[offsets.edge + i];
+    new_edge = old_edge;
+    new_edge.v1 += offsets.vert;
+    new_edge.v2 += offsets.vert;
+  }
+  for (const int i : IndexRange(mesh.totloop)) {
+    const MLoop &old_loop = mesh.mloop[i];
+    MLoop &new_loop = new_mesh.mloop[offsets.loop + i];
+    new_loop = old_loop;
+    new_loop.v += offsets.vert;
+    new_loop.e += offsets.edge;
+  }
+  for (const int i : IndexRange(mesh.totpoly)) {
+    const MPoly &old_poly = mesh.mpoly[i];
+    MPoly &new_poly = new_mesh.mpoly[offsets.poly + i];
+    new_poly = old_poly;
+    new_poly.loopstart += offsets.loop;
+  }
+}
+
+static void copy_transformed_pointcloud(const PointCloud &pointcloud,
+                                        const float4x4 &transform,
+                                        const int vert_offset,
+                                        Mesh &new_mesh)
+{
+  for (const int i : IndexRange(pointcloud.totpoint)) {
+    MVert &new_vert = new_mesh.mvert[vert_offset + i];
+    const float3 old_position = pointcloud.co[i];
+    const float3 new_position = transform * old_position;
+    copy_v3_v3(new_vert.co, new_position);
+  }
+}
+
 static Mesh *join_mesh_topology_and_builtin_attributes(Span<GeometryInstanceGroup> set_groups,
                                                        const bool convert_points_to_vertices)
 {
-  int totverts = 0;
-  int totloops = 0;
-  int totedges = 0;
-  int totpolys = 0;
+  /* Compute the offsets of all instance groups first, so that they can be copied in parallel. */
+  Array<MeshElementOffsets> group_offsets(set_groups.size());
+  MeshElementOffsets totals;
   int64_t cd_dirty_vert = 0;
   int64_t cd_dirty_poly = 0;
   int64_t cd_dirty_edge = 0;
   int64_t cd_dirty_loop = 0;
-  for (const GeometryInstanceGroup &set_group : set_groups) {
+  for (const int group_index : set_groups.index_range()) {
+    group_offsets[group_index] = totals;
+    const GeometryInstanceGroup &set_group = set_groups[group_index];
     const GeometrySet &set = set_group.geometry_set;
     const int tot_transforms = set_group.transforms.size();
     if (set.has_mesh()) {
       const Mesh &mesh = *set.get_mesh_for_read();
-      totverts += mesh.totvert * tot_transforms;
-      totloops += mesh.totloop * tot_transforms;
-      totedges += mesh.totedge * tot_transforms;
-      totpolys += mesh.totpoly * tot_transforms;
+      totals.vert += mesh.totvert * tot_transforms;
+      totals.loop += mesh.totloop * tot_transforms;
+      totals.edge += mesh.totedge * tot_transforms;
+      totals.poly += mesh.totpoly * tot_transforms;
       cd_dirty_vert |= mesh.runtime.cd_dirty_vert;
       cd_dirty_poly |= mesh.runtime.cd_dirty_poly;
       cd_dirty_edge |= mesh.runtime.cd_dirty_edge;
@@ -351,16 +422,16 @@ static Mesh *join_mesh_topology_and_builtin_attributes(Span<GeometryInstanceGrou
     }
     if (convert_points_to_vertices && set.has_pointcloud()) {
       const PointCloud &pointcloud = *set.get_pointcloud_for_read();
-      totverts += pointcloud.totpoint * tot_transforms;
+      totals.vert += pointcloud.totpoint * tot_transforms;
     }
   }
 
   /* Don't create an empty mesh. */
-  if ((totverts + totloops + totedges + totpolys) == 0) {
+  if ((totals.vert + totals.loop + totals.edge + totals.poly) == 0) {
     return nullptr;
   }
 
-  Mesh *new_mesh = BKE_mesh_new_nomain(totverts, totedges, 0, totloops, totpolys);
+  Mesh *new_mesh = BKE_mesh_new_nomain(totals.vert, totals.edge, 0, totals.loop, totals.poly);
   /* Copy settings from the first input geometry set with a mesh. */
   for (const GeometryInstanceGroup &set_group : set_groups) {
     const GeometrySet &set = set_group.geometry_set;
@@ -375,73 +446,92 @@ static Mesh *join_mesh_topology_and_builtin_attributes(Span<GeometryInstanceGrou
   new_mesh->runtime.cd_dirty_edge = cd_dirty_edge;
   new_mesh->runtime.cd_dirty_loop = cd_dirty_loop;
 
-  int vert_offset = 0;
-  int loop_offset = 0;
-  int edge_offset = 0;
-  int poly_offset = 0;
-  for (const GeometryInstanceGroup &set_group : set_groups) {
-    const GeometrySet &set = set_group.geometry_set;
-    if (set.has_mesh()) {
-      const Mesh &mesh = *set.get_mesh_for_read();
-      for (const float4x4 &transform : set_group.transforms) {
-        for (const int i : IndexRange(mesh.totvert)) {
-          const MVert &old_vert = mesh.mvert[i];
-          MVert &new_vert = new_mesh->mvert[vert_offset + i];
-
-          new_vert = old_vert;
-
-          const float3 new_position = transform * float3(old_vert.co);
-          copy_v3_v3(new_vert.co, new_position);
-        }
-        for (const int i : IndexRange(mesh.totedge)) {
-          const MEdge &old_edge = mesh.medge[i];
-          MEdge &new_edge = new_mesh->medge[edge_offset + i];
-          new_edge = old_edge;
-          new_edge.v1 += vert_offset;
-          new_edge.v2 += vert_offset;
-        }
-        for (const int i : IndexRange(mesh.totloop)) {
-          const MLoop &old_loop = mesh.mloop[i];
-          MLoop &new_loop = new_mesh->mloop[loop_offset + i];
-          new_loop = old_loop;
-          new_loop.v += vert_offset;
-          new_loop.e += edge_offset;
-        }
-        for (const int i : IndexRange(mesh.totpoly)) {
-          const MPoly &old_poly = mesh.mpoly[i];
-          MPoly &new_poly = new_mesh->mpoly[poly_offset + i];
-          new_poly = old_poly;
-          new_poly.loopstart += loop_offset;
-        }
-
-        vert_offset += mesh.totvert;
-        loop_offset += mesh.totloop;
-        edge_offset += mesh.totedge;
-        poly_offset += mesh.totpoly;
+  parallel_for(set_groups.index_range(), 1, [&](IndexRange groups_range) {
+    for (const int group_index : groups_range) {
+      const GeometryInstanceGroup &set_group = set_groups[group_index];
+      const GeometrySet &set = set_group.geometry_set;
+      const MeshElementOffsets &offsets = group_offsets[group_index];
+      int points_vert_offset = offsets.vert;
+      if (set.has_mesh()) {
+        const Mesh &mesh = *set.get_mesh_for_read();
+        parallel_for(set_group.transforms.index_range(),
+                     instances_grain_size(mesh.totvert + mesh.totloop),
+                     [&](IndexRange transforms_range) {
+                       for (const int i : transforms_range) {
+                         MeshElementOffsets instance_offsets;
+                         instance_offsets.vert = offsets.vert + mesh.totvert * i;
+                         instance_offsets.edge = offsets.edge + mesh.totedge * i;
+                         instance_offsets.loop = offsets.loop + mesh.totloop * i;
+                         instance_offsets.poly = offsets.poly + mesh.totpoly * i;
+                         copy_transformed_mesh(
+                             mesh, set_group.transforms[i], instance_offsets, *new_mesh);
+                       }
+                     });
+        points_vert_offset += mesh.totvert * set_group.transforms.size();
       }
-    }
-    if (convert_points_to_vertices && set.has_pointcloud()) {
-      const PointCloud &pointcloud = *set.get_pointcloud_for_read();
-      for (const float4x4 &transform : set_group.transforms) {
-        for (const int i : IndexRange(pointcloud.totpoint)) {
-          MVert &new_vert = new_mesh->mvert[vert_offset + i];
-          const float3 old_position = pointcloud.co[i];
-          const float3 new_position = transform * old_position;
-          copy_v3_v3(new_vert.co, new_position);
-        }
-        vert_offset += pointcloud.totpoint;
+      if (convert_points_to_vertices && set.has_pointcloud()) {
+        const PointCloud &pointcloud = *set.get_pointcloud_for_read();
+        parallel_for(set_group.transforms.index_range(),
+                     instances_grain_size(pointcloud.totpoint),
+                     [&](IndexRange transforms_range) {
+                       for (const int i : transforms_range) {
+                         copy_transformed_pointcloud(pointcloud,
+                                                     set_group.transforms[i],
+                                                     points_vert_offset + pointcloud.totpoint * i,
+                                                     *new_mesh);
+                       }
+                     });
       }
     }
-  }
+  });
 
   return new_mesh;
 }
 
+/**
+ * Copy the source attribute into the result once for every instance. When the source is not
+ * stored as a span, it is materialized into the memory of the first instance directly, instead of
+ * into a temporary buffer.
+ */
+static void copy_attribute_to_instances(const fn::GVArray &src,
+                                        const int domain_size,
+                                        const int instances_num,
+                                        fn::GMutableSpan dst)
+{
+  if (instances_num == 0) {
+    return;
+  }
+
+  const CPPType &type = src.type();
+  const void *src_buffer;
+  int first_instance_to_copy = 0;
+  if (src.is_span()) {
+    src_buffer = src.get_internal_span().data();
+  }
+  else {
+    type.destruct_n(dst.data(), domain_size);
+    src.materialize_to_uninitialized(IndexRange(domain_size), dst.data());
+    src_buffer = dst.data();
+    first_instance_to_copy = 1;
+  }
+
+  const IndexRange instances_range(first_instance_to_copy,
+                                   instances_num - first_instance_to_copy);
+  parallel_for(instances_range, instances_grain_size(domain_size), [&](IndexRange range) {
+    for (const int i : range) {
+      type.copy_to_initialized_n(src_buffer, dst[domain_size * i], domain_size);
+    }
+  });
+}
+
 static void join_attributes(Span<GeometryInstanceGroup> set_groups,
                             Span<GeometryComponentType> component_types,
                             const Map<std::string, AttributeKind> &attribute_info,
                             GeometryComponent &result)
 {
+  /* Offset of every component of every instance group in the result domain. */
+  Array<int> component_offsets(set_groups.size() * component_types.size());
+
   for (Map<std::string, AttributeKind>::Item entry : attribute_info.items()) {
     StringRef name = entry.key;
     const AttributeDomain domain_output = entry.value.domain;
@@ -459,33 +549,50 @@ static void join_attributes(Span<GeometryInstanceGroup> set_groups,
     fn::GVMutableArray_GSpan dst_span{*write_attribute.varray};
 
     int offset = 0;
-    for (const GeometryInstanceGroup &set_group : set_groups) {
+    for (const int group_index : set_groups.index_range()) {
+      const GeometryInstanceGroup &set_group = set_groups[group_index];
       const GeometrySet &set = set_group.geometry_set;
-      for (const GeometryComponentType component_type : component_types) {
-        if (set.has(component_type)) {
-          const GeometryComponent &component = *set.get_component_for_read(component_type);
+      for (const int type_index : component_types.index_range()) {
+        component_offsets[group_index * component_types.size() + type_index] = offset;
+        if (set.has(component_types[type_index])) {
+          const GeometryComponent &component = *set.get_component_for_read(
+              component_types[type_index]);
+          const int domain_size = component.attribute_domain_size(domain_output);
+          offset += domain_size * set_group.transforms.size();
+        }
+      }
+    }
+
+    parallel_for(set_groups.index_range(), 1, [&](IndexRange groups_range) {
+      for (const int group_index : groups_range) {
+        const GeometryInstanceGroup &set_group = set_groups[group_index];
+        const GeometrySet &set = set_group.geometry_set;
+        for (const int type_index : component_types.index_range()) {
+          if (!set.has(component_types[type_index])) {
+            continue;
+          }
+          const GeometryComponent &component = *set.get_component_for_read(
+              component_types[type_index]);
           const int domain_size = component.attribute_domain_size(domain_output);
           if (domain_size == 0) {
-            continue; /* Domain size is 0, so no need to increment the offset. */
+            continue;
           }
           GVArrayPtr source_attribute = component.attribute_try_get_for_read(
               name, domain_output, data_type_output);
-
-          if (source_attribute) {
-            fn::GVArray_GSpan src_span{*source_attribute};
-            const void *src_buffer = src_span.data();
-            for (const int UNUSED(i) : set_group.transforms.index_range()) {
-              void *dst_buffer = dst_span[offset];
-              cpp_type->copy_to_initialized_n(src_buffer, dst_buffer, domain_size);
-              offset += domain_size;
-            }
-          }
-          else {
-            offset += domain_size * set_group.transforms.size();
+          if (!source_attribute) {
+            continue;
           }
+          const int component_offset =
+              component_offsets[group_index * component_types.size() + type_index];
+          const int instances_num = set_group.transforms.size();
+          copy_attribute_to_instances(
+              *source_attribute,
+              domain_size,
+              instances_num,
+              dst_span.slice(component_offset, domain_size * instances_num));
         }
       }
-    }
+    });
 
     dst_span.save();
   }
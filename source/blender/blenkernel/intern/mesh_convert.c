@@ -1645,6 +1645,10 @@ void BKE_mesh_nomain_to_mesh(Mesh *mesh_src,
   if (CustomData_has_layer(&mesh_dst->ldata, CD_MDISPS)) {
     if (totloop == mesh_dst->totloop) {
       MDisps *mdisps = CustomData_get_layer(&mesh_dst->ldata, CD_MDISPS);
+      if (alloctype == CD_ASSIGN) {
+        /* The layer might be shared with the evaluated mesh, only take ownership of own data. */
+        mdisps = CustomData_duplicate_referenced_layer(&mesh_dst->ldata, CD_MDISPS, totloop);
+      }
       CustomData_add_layer(&tmp.ldata, CD_MDISPS, alloctype, mdisps, totloop);
       if (alloctype == CD_ASSIGN) {
         /* Assign NULL to prevent double-free. */
@@ -379,6 +379,38 @@ void BKE_mesh_calc_normals_poly(MVert *mverts,
   MEM_freeN(lnors_weighted);
 }
 
+/**
+ * Vertex normals are stored in the vertex array, which might be referenced from another mesh or
+ * shared with the original mesh (see #CD_SHARE). Make sure the mesh owns the array before the
+ * normals are written to it.
+ */
+void BKE_mesh_ensure_own_verts(Mesh *mesh)
+{
+  mesh->mvert = CustomData_duplicate_referenced_layer(&mesh->vdata, CD_MVERT, mesh->totvert);
+}
+
+/**
+ * Calculate poly normals of the mesh. Vertex normals are only calculated when they are tagged
+ * dirty, so a shared vertex array is only duplicated when the normals in it have to be written.
+ */
+void BKE_mesh_calc_normals_poly_ensure_verts(Mesh *mesh, float (*r_polynors)[3])
+{
+  const bool do_vert_normals = (mesh->runtime.cd_dirty_vert & CD_MASK_NORMAL) != 0;
+  if (do_vert_normals) {
+    BKE_mesh_ensure_own_verts(mesh);
+  }
+  BKE_mesh_calc_normals_poly(mesh->mvert,
+                             NULL,
+                             mesh->totvert,
+                             mesh->mloop,
+                             mesh->mpoly,
+                             mesh->totloop,
+                             mesh->totpoly,
+                             r_polynors,
+                             !do_vert_normals);
+  mesh->runtime.cd_dirty_vert &= ~CD_MASK_NORMAL;
+}
+
 void BKE_mesh_ensure_normals(Mesh *mesh)
 {
   if (mesh->runtime.cd_dirty_vert & CD_MASK_NORMAL) {
@@ -413,6 +445,9 @@ void BKE_mesh_ensure_normals_for_display(Mesh *mesh)
 
   if (do_vert_normals || do_poly_normals) {
     const bool do_add_poly_nors_cddata = (poly_nors == NULL);
+    if (do_vert_normals) {
+      BKE_mesh_ensure_own_verts(mesh);
+    }
     if (do_add_poly_nors_cddata) {
       poly_nors = MEM_malloc_arrayN((size_t)mesh->totpoly, sizeof(*poly_nors), __func__);
     }
@@ -444,6 +479,7 @@ void BKE_mesh_calc_normals(Mesh *mesh)
 #ifdef DEBUG_TIME
   TIMEIT_START_AVERAGED(BKE_mesh_calc_normals);
 #endif
+  BKE_mesh_ensure_own_verts(mesh);
   BKE_mesh_calc_normals_poly(mesh->mvert,
                              NULL,
                              mesh->totvert,
@@ -2060,15 +2096,7 @@ static void mesh_set_custom_normals(Mesh *mesh, float (*r_custom_nors)[3], const
   bool free_polynors = false;
   if (polynors == NULL) {
     polynors = MEM_mallocN(sizeof(float[3]) * (size_t)mesh->totpoly, __func__);
-    BKE_mesh_calc_normals_poly(mesh->mvert,
-                               NULL,
-                               mesh->totvert,
-                               mesh->mloop,
-                               mesh->mpoly,
-                               mesh->totloop,
-                               mesh->totpoly,
-                               polynors,
-                               false);
+    BKE_mesh_calc_normals_poly_ensure_verts(mesh, polynors);
     free_polynors = true;
   }
 
@@ -41,6 +41,8 @@
 #include "BKE_main.h"
 #include "BKE_undo_system.h"
 
+#include "BLO_undofile.h"
+
 #include "MEM_guardedalloc.h"
 
 #define undo_stack _wm_undo_stack_disallow /* pass in as a variable always. */
@@ -1047,6 +1049,16 @@ void BKE_undosys_print(UndoStack *ustack)
            us->name);
     index++;
   }
+
+  size_t buffers_num, size_stored, size_referenced;
+  BLO_memfile_chunk_store_stats(&buffers_num, &size_stored, &size_referenced);
+  if (size_stored != 0) {
+    printf("Memfile chunks: %zu buffers, %zu bytes stored for %zu bytes used (ratio %.2f)\n",
+           buffers_num,
+           size_stored,
+           size_referenced,
+           (double)size_referenced / (double)size_stored);
+  }
 }
 
 /** \} */
@@ -32,7 +32,8 @@ typedef struct {
   const char *buf;
   /** Size in bytes. */
   size_t size;
-  /** When true, this chunk doesn't own the memory, it's shared with a previous #MemFileChunk */
+  /** When true, this chunk is identical to the matching chunk in the previous step. The buffer is
+   * shared with it (buffers are owned by a store shared by all steps, see undofile.c). */
   bool is_identical;
   /** When true, this chunk is also identical to the one in the next step (used by undo code to
    * detect unchanged IDs).
@@ -78,6 +79,9 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
 extern void BLO_memfile_free(MemFile *memfile);
 extern void BLO_memfile_merge(MemFile *first, MemFile *second);
 extern void BLO_memfile_clear_future(MemFile *memfile);
+extern void BLO_memfile_chunk_store_stats(size_t *r_buffers_num,
+                                          size_t *r_size_stored,
+                                          size_t *r_size_referenced);
 
 /* utilities */
 extern struct Main *BLO_memfile_main_get(struct MemFile *memfile,
@@ -29,6 +29,10 @@ struct Main;
 struct MemFile;
 struct ReportList;
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /* -------------------------------------------------------------------- */
 /** \name BLO Write File API
  *
@@ -72,3 +76,7 @@ extern bool BLO_write_file_mem(struct Main *mainvar,
                                int write_flags);
 
 /** \} */
+
+#ifdef __cplusplus
+}
+#endif
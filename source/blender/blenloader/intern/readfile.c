@@ -69,6 +69,7 @@
 #include "BLI_memarena.h"
 #include "BLI_mempool.h"
 #include "BLI_mmap.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BLT_translation.h"
@@ -572,48 +573,89 @@ static bool blo_bhead_is_id_valid_type(const BHead *bhead)
   return BKE_idtype_idcode_is_valid(id_type_code);
 }
 
-#ifdef USE_GHASH_BHEAD
-static void read_file_bhead_idname_map_create(FileData *fd)
-{
+struct BHeadSort {
   BHead *bhead;
+  const void *old;
+};
+
+static int verg_bheadsort(const void *v1, const void *v2)
+{
+  const struct BHeadSort *x1 = v1, *x2 = v2;
+
+  if (x1->old > x2->old) {
+    return 1;
+  }
+  if (x1->old < x2->old) {
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * Build the index of the ID blocks in the file, used when linking from it:
+ * - #FileData.bheadmap maps the old address of ID blocks to their #BHead,
+ *   which is needed to follow ID pointers when expanding linked data.
+ * - #FileData.bhead_idname_hash maps the names of linkable ID's to their #BHead.
+ *
+ * Both only contain ID blocks, so they are built with a single pass over the block headers and
+ * don't have to sort or hash the (usually much more numerous) #DATA blocks. Together with
+ * #USE_BHEAD_READ_ON_DEMAND the data of the blocks is only read once an ID is actually linked.
+ */
+static void read_file_bhead_id_index_create(FileData *fd)
+{
+  BLI_assert(fd->bheadmap == NULL);
+
+  int tot_alloc = 64;
+  int tot = 0;
+  struct BHeadSort *bheadmap = MEM_malloc_arrayN(tot_alloc, sizeof(*bheadmap), __func__);
 
   /* dummy values */
   bool is_link = false;
   int code_prev = ENDB;
-  uint reserve = 0;
+  uint tot_link = 0;
 
-  for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
+  for (BHead *bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
+    if (!blo_bhead_is_id(bhead)) {
+      continue;
+    }
     if (code_prev != bhead->code) {
       code_prev = bhead->code;
       is_link = blo_bhead_is_id_valid_type(bhead) ?
                     BKE_idtype_idcode_is_linkable((short)code_prev) :
                     false;
     }
-
+    if (tot == tot_alloc) {
+      tot_alloc *= 2;
+      bheadmap = MEM_reallocN(bheadmap, sizeof(*bheadmap) * (size_t)tot_alloc);
+    }
+    bheadmap[tot].bhead = bhead;
+    bheadmap[tot].old = bhead->old;
+    tot++;
     if (is_link) {
-      reserve += 1;
+      tot_link++;
     }
   }
 
+#ifdef USE_GHASH_BHEAD
   BLI_assert(fd->bhead_idname_hash == NULL);
 
-  fd->bhead_idname_hash = BLI_ghash_str_new_ex(__func__, reserve);
-
-  for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
-    if (code_prev != bhead->code) {
-      code_prev = bhead->code;
-      is_link = blo_bhead_is_id_valid_type(bhead) ?
-                    BKE_idtype_idcode_is_linkable((short)code_prev) :
-                    false;
-    }
-
-    if (is_link) {
+  fd->bhead_idname_hash = BLI_ghash_str_new_ex(__func__, tot_link);
+  for (int i = 0; i < tot; i++) {
+    BHead *bhead = bheadmap[i].bhead;
+    if (blo_bhead_is_id_valid_type(bhead) && BKE_idtype_idcode_is_linkable((short)bhead->code)) {
       BLI_ghash_insert(fd->bhead_idname_hash, (void *)blo_bhead_id_name(fd, bhead), bhead);
     }
   }
-}
+#else
+  UNUSED_VARS(tot_link);
 #endif
 
+  qsort(bheadmap, tot, sizeof(*bheadmap), verg_bheadsort);
+
+  fd->bheadmap = bheadmap;
+  fd->tot_bheadmap = tot;
+}
+
 static Main *blo_find_main(FileData *fd, const char *filepath, const char *relabase)
 {
   ListBase *mainlist = fd->mainlist;
@@ -1506,20 +1548,34 @@ static ssize_t fd_read_gzip_from_memory(FileData *filedata,
   filedata->strm.next_out = (Bytef *)buffer;
   filedata->strm.avail_out = (uint)size;
 
-  /* Inflate another chunk. */
-  err = inflate(&filedata->strm, Z_SYNC_FLUSH);
+  while (filedata->strm.avail_out > 0) {
+    /* Inflate another chunk. */
+    err = inflate(&filedata->strm, Z_SYNC_FLUSH);
 
-  if (err == Z_STREAM_END) {
-    return 0;
-  }
-  if (err != Z_OK) {
-    printf("fd_read_gzip_from_memory: zlib error\n");
-    return 0;
+    if (err == Z_STREAM_END) {
+      if (filedata->strm.avail_in == 0) {
+        break;
+      }
+      /* Files compressed on multiple threads consist of several gzip members,
+       * continue with the next one. */
+      if (inflateReset(&filedata->strm) != Z_OK) {
+        printf("fd_read_gzip_from_memory: zlib error\n");
+        return 0;
+      }
+    }
+    else if (err != Z_OK) {
+      printf("fd_read_gzip_from_memory: zlib error\n");
+      return 0;
+    }
+    else if (filedata->strm.avail_in == 0) {
+      break;
+    }
   }
 
-  filedata->file_offset += size;
+  const size_t read_size = size - filedata->strm.avail_out;
+  filedata->file_offset += read_size;
 
-  return (ssize_t)size;
+  return (ssize_t)read_size;
 }
 
 static int fd_read_gzip_from_memory_init(FileData *fd)
@@ -2170,6 +2226,61 @@ static void switch_endian_structs(const struct SDNA *filesdna, BHead *bhead)
   }
 }
 
+/* Number of array elements converted by a single task in #read_struct_reconstruct. */
+#define RECONSTRUCT_BLOCKS_PER_TASK 4096
+
+typedef struct ReconstructRangeData {
+  const struct DNA_ReconstructInfo *reconstruct_info;
+  const BHead *bhead;
+  void *new_blocks;
+} ReconstructRangeData;
+
+static void read_struct_reconstruct_range_fn(void *__restrict userdata,
+                                             const int iter,
+                                             const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ReconstructRangeData *data = userdata;
+  const BHead *bhead = data->bhead;
+  const int first_block = iter * RECONSTRUCT_BLOCKS_PER_TASK;
+  const int blocks = MIN2(RECONSTRUCT_BLOCKS_PER_TASK, bhead->nr - first_block);
+  DNA_struct_reconstruct_range(
+      data->reconstruct_info, bhead->SDNAnr, first_block, blocks, bhead + 1, data->new_blocks);
+}
+
+/**
+ * Convert the data of a block whose struct changed since the file was written.
+ *
+ * Large arrays (typically mesh and custom-data layers) dominate the time spent here when opening
+ * files from older versions, so they are converted in parallel.
+ */
+static void *read_struct_reconstruct(FileData *fd, BHead *bh)
+{
+  if (bh->nr < RECONSTRUCT_BLOCKS_PER_TASK * 2) {
+    return DNA_struct_reconstruct(fd->reconstruct_info, bh->SDNAnr, bh->nr, (bh + 1));
+  }
+
+  const int new_block_size = DNA_struct_reconstruct_block_size(fd->reconstruct_info,
+                                                               bh->SDNAnr);
+  if (new_block_size == 0) {
+    return NULL;
+  }
+
+  ReconstructRangeData data = {
+      .reconstruct_info = fd->reconstruct_info,
+      .bhead = bh,
+      .new_blocks = MEM_callocN((size_t)bh->nr * (size_t)new_block_size, "reconstruct"),
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  BLI_task_parallel_range(0,
+                          (bh->nr + RECONSTRUCT_BLOCKS_PER_TASK - 1) / RECONSTRUCT_BLOCKS_PER_TASK,
+                          &data,
+                          read_struct_reconstruct_range_fn,
+                          &settings);
+  return data.new_blocks;
+}
+
 static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
 {
   void *temp = NULL;
@@ -2204,10 +2315,10 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
           }
         }
 #endif
-        temp = DNA_struct_reconstruct(fd->reconstruct_info, bh->SDNAnr, bh->nr, (bh + 1));
+        temp = read_struct_reconstruct(fd, bh);
       }
       else {
-        /* SDNA_CMP_EQUAL */
+        /* SDNA_CMP_EQUAL: identical structs are copied as a whole, without conversion. */
         temp = MEM_mallocN(bh->len, blockname);
 #ifdef USE_BHEAD_READ_ON_DEMAND
         if (BHEADN_FROM_BHEAD(bh)->has_data) {
@@ -4272,49 +4383,6 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
  * Also used for append.
  * \{ */
 
-struct BHeadSort {
-  BHead *bhead;
-  const void *old;
-};
-
-static int verg_bheadsort(const void *v1, const void *v2)
-{
-  const struct BHeadSort *x1 = v1, *x2 = v2;
-
-  if (x1->old > x2->old) {
-    return 1;
-  }
-  if (x1->old < x2->old) {
-    return -1;
-  }
-  return 0;
-}
-
-static void sort_bhead_old_map(FileData *fd)
-{
-  BHead *bhead;
-  struct BHeadSort *bhs;
-  int tot = 0;
-
-  for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
-    tot++;
-  }
-
-  fd->tot_bheadmap = tot;
-  if (tot == 0) {
-    return;
-  }
-
-  bhs = fd->bheadmap = MEM_malloc_arrayN(tot, sizeof(struct BHeadSort), "BHeadSort");
-
-  for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead), bhs++) {
-    bhs->bhead = bhead;
-    bhs->old = bhead->old;
-  }
-
-  qsort(fd->bheadmap, tot, sizeof(struct BHeadSort), verg_bheadsort);
-}
-
 static BHead *find_previous_lib(FileData *fd, BHead *bhead)
 {
   /* Skip library data-blocks in undo, see comment in read_libblock. */
@@ -4343,7 +4411,7 @@ static BHead *find_bhead(FileData *fd, void *old)
   }
 
   if (fd->bheadmap == NULL) {
-    sort_bhead_old_map(fd);
+    read_file_bhead_id_index_create(fd);
   }
 
   bhs_s.old = old;
@@ -5061,9 +5129,7 @@ static Main *library_link_begin(
   /* needed for do_version */
   mainl->versionfile = (*fd)->fileversion;
   read_file_version(*fd, mainl);
-#ifdef USE_GHASH_BHEAD
-  read_file_bhead_idname_map_create(*fd);
-#endif
+  read_file_bhead_id_index_create(*fd);
 
   return mainl;
 }
@@ -5475,9 +5541,7 @@ static FileData *read_library_file_data(FileData *basefd,
 
     /* subversion */
     read_file_version(fd, mainptr);
-#ifdef USE_GHASH_BHEAD
-    read_file_bhead_idname_map_create(fd);
-#endif
+    read_file_bhead_id_index_create(fd);
   }
   else {
     mainptr->curlib->filedata = NULL;
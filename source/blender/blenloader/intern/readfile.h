@@ -134,6 +134,7 @@ typedef struct FileData {
   struct OldNewMap *packedmap;
   struct BLOCacheStorage *cache_storage;
 
+  /** ID blocks sorted by their old address, see #read_file_bhead_id_index_create. */
   struct BHeadSort *bheadmap;
   int tot_bheadmap;
 
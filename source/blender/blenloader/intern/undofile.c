@@ -42,6 +42,7 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
 
 #include "BLO_readfile.h"
 #include "BLO_undofile.h"
@@ -54,15 +55,132 @@
 
 /* **************** support for memory-write, for undo buffers *************** */
 
+/* -------------------------------------------------------------------- */
+/** \name Chunk Store
+ *
+ * The buffers of all memfile chunks are stored in a single content addressed store shared by all
+ * undo steps. A chunk that is written with the same content as any chunk that is still referenced
+ * (not only the matching chunk of the previous step) reuses its buffer, so e.g. undoing a change
+ * and redoing it again, or data that moves within the file, does not use additional memory.
+ * \{ */
+
+/** Header allocated in front of every chunk buffer in the store. */
+typedef struct MemFileChunkBuffer {
+  const char *buf;
+  size_t size;
+  uint hash;
+  /** Number of #MemFileChunk using this buffer. */
+  uint users;
+} MemFileChunkBuffer;
+
+#define CHUNK_BUFFER_FROM_BUF(buf) (((MemFileChunkBuffer *)(buf)) - 1)
+
+static struct {
+  /** Set of #MemFileChunkBuffer, only allocated while it is not empty. */
+  GSet *buffers;
+  /** Size of the unique buffers in the store. */
+  size_t size_stored;
+  /** Size of all chunks using the buffers, as if they would not be shared. */
+  size_t size_referenced;
+} g_chunk_store = {NULL};
+
+static uint chunk_buffer_hash(const void *key)
+{
+  return ((const MemFileChunkBuffer *)key)->hash;
+}
+
+static bool chunk_buffer_cmp(const void *a, const void *b)
+{
+  const MemFileChunkBuffer *buffer_a = a;
+  const MemFileChunkBuffer *buffer_b = b;
+  return (buffer_a->hash != buffer_b->hash) || (buffer_a->size != buffer_b->size) ||
+         (memcmp(buffer_a->buf, buffer_b->buf, buffer_a->size) != 0);
+}
+
+static void chunk_buffer_user_add(const char *buf)
+{
+  MemFileChunkBuffer *buffer = CHUNK_BUFFER_FROM_BUF(buf);
+  buffer->users++;
+  g_chunk_store.size_referenced += buffer->size;
+}
+
+/**
+ * Find a buffer with the given content in the store or add a new one.
+ *
+ * \param r_is_new: Set to true when the content was not in the store yet.
+ */
+static const char *chunk_buffer_ensure(const char *buf, const size_t size, bool *r_is_new)
+{
+  if (g_chunk_store.buffers == NULL) {
+    g_chunk_store.buffers = BLI_gset_new(chunk_buffer_hash, chunk_buffer_cmp, __func__);
+  }
+
+  const MemFileChunkBuffer key = {
+      .buf = buf,
+      .size = size,
+      .hash = BLI_hash_mm2((const uchar *)buf, size, 0),
+  };
+
+  void **r_key;
+  *r_is_new = !BLI_gset_ensure_p_ex(g_chunk_store.buffers, &key, &r_key);
+  if (*r_is_new) {
+    MemFileChunkBuffer *buffer = MEM_mallocN(sizeof(*buffer) + size, "Chunk buffer");
+    *buffer = key;
+    buffer->buf = (const char *)(buffer + 1);
+    buffer->users = 0;
+    memcpy(buffer + 1, buf, size);
+    *r_key = buffer;
+    g_chunk_store.size_stored += size;
+  }
+
+  MemFileChunkBuffer *buffer = *r_key;
+  chunk_buffer_user_add(buffer->buf);
+  return buffer->buf;
+}
+
+static void chunk_buffer_user_remove(const char *buf)
+{
+  MemFileChunkBuffer *buffer = CHUNK_BUFFER_FROM_BUF(buf);
+  BLI_assert(buffer->users > 0);
+  g_chunk_store.size_referenced -= buffer->size;
+  buffer->users--;
+  if (buffer->users > 0) {
+    return;
+  }
+
+  BLI_gset_remove(g_chunk_store.buffers, buffer, NULL);
+  g_chunk_store.size_stored -= buffer->size;
+  MEM_freeN(buffer);
+
+  if (BLI_gset_len(g_chunk_store.buffers) == 0) {
+    BLI_gset_free(g_chunk_store.buffers, NULL);
+    g_chunk_store.buffers = NULL;
+    BLI_assert(g_chunk_store.size_stored == 0 && g_chunk_store.size_referenced == 0);
+  }
+}
+
+/**
+ * Statistics of the chunk store, the ratio between \a r_size_referenced and \a r_size_stored is
+ * the memory saved by sharing chunk buffers.
+ */
+void BLO_memfile_chunk_store_stats(size_t *r_buffers_num,
+                                   size_t *r_size_stored,
+                                   size_t *r_size_referenced)
+{
+  *r_buffers_num = g_chunk_store.buffers ? BLI_gset_len(g_chunk_store.buffers) : 0;
+  *r_size_stored = g_chunk_store.size_stored;
+  *r_size_referenced = g_chunk_store.size_referenced;
+}
+
+/** \} */
+
 /* not memfile itself */
 void BLO_memfile_free(MemFile *memfile)
 {
   MemFileChunk *chunk;
 
   while ((chunk = BLI_pophead(&memfile->chunks))) {
-    if (chunk->is_identical == false) {
-      MEM_freeN((void *)chunk->buf);
-    }
+    chunk_buffer_user_remove(chunk->buf);
     MEM_freeN(chunk);
   }
   memfile->size = 0;
@@ -72,36 +190,8 @@ void BLO_memfile_free(MemFile *memfile)
 /* result is that 'first' is being freed */
 void BLO_memfile_merge(MemFile *first, MemFile *second)
 {
-  /* We use this mapping to store the memory buffers from second memfile chunks which are not owned
-   * by it (i.e. shared with some previous memory steps). */
-  GHash *buffer_to_second_memchunk = BLI_ghash_new(
-      BLI_ghashutil_ptrhash, BLI_ghashutil_ptrcmp, __func__);
-
-  /* First, detect all memchunks in second memfile that are not owned by it. */
-  for (MemFileChunk *sc = second->chunks.first; sc != NULL; sc = sc->next) {
-    if (sc->is_identical) {
-      BLI_ghash_insert(buffer_to_second_memchunk, (void *)sc->buf, sc);
-    }
-  }
-
-  /* Now, check all chunks from first memfile (the one we are removing), and if a memchunk owned by
-   * it is also used by the second memfile, transfer the ownership. */
-  for (MemFileChunk *fc = first->chunks.first; fc != NULL; fc = fc->next) {
-    if (!fc->is_identical) {
-      MemFileChunk *sc = BLI_ghash_lookup(buffer_to_second_memchunk, fc->buf);
-      if (sc != NULL) {
-        BLI_assert(sc->is_identical);
-        sc->is_identical = false;
-        fc->is_identical = true;
-      }
-      /* Note that if the second memfile does not use that chunk, we assume that the first one
-       * fully owns it without sharing it with any other memfile, and hence it should be freed with
-       * it. */
-    }
-  }
-
-  BLI_ghash_free(buffer_to_second_memchunk, NULL, NULL);
-
+  /* Buffers shared with the second memfile are kept alive by its own references to them. */
+  UNUSED_VARS(second);
   BLO_memfile_free(first);
 }
 
@@ -170,7 +260,7 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
   curchunk->id_session_uuid = mem_data->current_id_session_uuid;
   BLI_addtail(&memfile->chunks, curchunk);
 
-  /* we compare compchunk with buf */
+  /* we compare compchunk with buf, which avoids hashing the chunk in the common case */
   if (*compchunk_step != NULL) {
     MemFileChunk *compchunk = *compchunk_step;
     if (compchunk->size == curchunk->size) {
@@ -178,17 +268,19 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
         curchunk->buf = compchunk->buf;
         curchunk->is_identical = true;
         compchunk->is_identical_future = true;
+        chunk_buffer_user_add(curchunk->buf);
       }
     }
     *compchunk_step = compchunk->next;
   }
 
-  /* not equal... */
+  /* not equal to the previous step, but the content might still be in the store... */
   if (curchunk->buf == NULL) {
-    char *buf_new = MEM_mallocN(size, "Chunk buffer");
-    memcpy(buf_new, buf, size);
-    curchunk->buf = buf_new;
-    memfile->size += size;
+    bool is_new;
+    curchunk->buf = chunk_buffer_ensure(buf, size, &is_new);
+    if (is_new) {
+      memfile->size += size;
+    }
   }
 }
 
@@ -885,6 +885,9 @@ void blo_do_versions_userdef(UserDef *userdef)
    */
   {
     /* Keep this block, even when empty. */
+    if (userdef->geometry_nodes_cache_limit <= 0) {
+      userdef->geometry_nodes_cache_limit = 1024;
+    }
   }
 
   LISTBASE_FOREACH (bTheme *, btheme, &userdef->themes) {
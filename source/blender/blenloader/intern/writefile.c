@@ -101,6 +101,8 @@
 #include "BLI_bitmap.h"
 #include "BLI_blenlib.h"
 #include "BLI_mempool.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #include "MEM_guardedalloc.h" /* MEM_freeN */
 
 #include "BKE_blender_version.h"
@@ -147,9 +149,11 @@
 typedef enum {
   WW_WRAP_NONE = 1,
   WW_WRAP_ZLIB,
+  WW_WRAP_ZLIB_MT,
 } eWriteWrapType;
 
 typedef struct WriteWrap WriteWrap;
+struct ZlibFrameWriter;
 struct WriteWrap {
   /* callbacks */
   bool (*open)(WriteWrap *ww, const char *filepath);
@@ -163,6 +167,7 @@ struct WriteWrap {
   union {
     int file_handle;
     gzFile gz_handle;
+    struct ZlibFrameWriter *zlib_frame_writer;
   } _user_data;
 };
 
@@ -218,6 +223,138 @@ static size_t ww_write_zlib(WriteWrap *ww, const char *buf, size_t buf_len)
 }
 #undef FILE_HANDLE
 
+/* zlib (multi-threaded) */
+#define FILE_HANDLE(ww) (ww)->_user_data.zlib_frame_writer
+
+/**
+ * The data is split into frames that are compressed in parallel. Every frame is written as a
+ * separate gzip member. Concatenated gzip members are a valid gzip stream, so these files are read
+ * exactly like files that were compressed on a single thread (also by older versions).
+ */
+#define ZLIB_FRAME_SIZE (MEM_SIZE_OPTIMAL(1 << 22)) /* 4mb */
+/** Upper limit of frames compressed at once, each holds an input and an output buffer. */
+#define ZLIB_FRAMES_MAX 16
+
+typedef struct ZlibFrame {
+  char *in_buf;
+  size_t in_len;
+  char *out_buf;
+  size_t out_len;
+  bool ok;
+} ZlibFrame;
+
+typedef struct ZlibFrameWriter {
+  int file_handle;
+  /** Frames that are compressed together, `frames[frames_len]` is the one that is filled. */
+  ZlibFrame *frames;
+  int frames_len;
+  int frames_max;
+  bool error;
+} ZlibFrameWriter;
+
+static void ww_zlib_frame_compress(TaskPool *__restrict UNUSED(pool), void *taskdata)
+{
+  ZlibFrame *frame = taskdata;
+  z_stream stream = {NULL};
+
+  /* Same compression level as #ww_open_zlib, `15 + 16` writes a gzip header. */
+  if (deflateInit2(&stream, 1, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    frame->ok = false;
+    return;
+  }
+  const size_t out_max = deflateBound(&stream, frame->in_len);
+  frame->out_buf = MEM_mallocN(out_max, __func__);
+  stream.next_in = (Bytef *)frame->in_buf;
+  stream.avail_in = frame->in_len;
+  stream.next_out = (Bytef *)frame->out_buf;
+  stream.avail_out = out_max;
+  frame->ok = (deflate(&stream, Z_FINISH) == Z_STREAM_END);
+  frame->out_len = stream.total_out;
+  deflateEnd(&stream);
+}
+
+/** Compress all filled frames in parallel and write them to the file in order. */
+static void ww_zlib_mt_flush_frames(ZlibFrameWriter *writer)
+{
+  TaskPool *pool = BLI_task_pool_create(NULL, TASK_PRIORITY_HIGH);
+  for (int i = 0; i < writer->frames_len; i++) {
+    BLI_task_pool_push(pool, ww_zlib_frame_compress, &writer->frames[i], false, NULL);
+  }
+  BLI_task_pool_work_and_wait(pool);
+  BLI_task_pool_free(pool);
+
+  for (int i = 0; i < writer->frames_len; i++) {
+    ZlibFrame *frame = &writer->frames[i];
+    if (!writer->error) {
+      if (!frame->ok || write(writer->file_handle, frame->out_buf, frame->out_len) !=
+                            (ssize_t)frame->out_len) {
+        writer->error = true;
+      }
+    }
+    MEM_SAFE_FREE(frame->out_buf);
+    frame->in_len = 0;
+  }
+  writer->frames_len = 0;
+}
+
+static bool ww_open_zlib_mt(WriteWrap *ww, const char *filepath)
+{
+  int file = BLI_open(filepath, O_BINARY + O_WRONLY + O_CREAT + O_TRUNC, 0666);
+  if (file == -1) {
+    return false;
+  }
+
+  ZlibFrameWriter *writer = MEM_callocN(sizeof(*writer), __func__);
+  writer->file_handle = file;
+  /* Enough frames to keep all threads busy, without using too much memory on many cores. */
+  writer->frames_max = CLAMPIS(BLI_system_thread_count() * 2, 1, ZLIB_FRAMES_MAX);
+  writer->frames = MEM_callocN(sizeof(*writer->frames) * (writer->frames_max + 1), __func__);
+  FILE_HANDLE(ww) = writer;
+  return true;
+}
+
+static bool ww_close_zlib_mt(WriteWrap *ww)
+{
+  ZlibFrameWriter *writer = FILE_HANDLE(ww);
+  if (writer->frames[writer->frames_len].in_len > 0) {
+    writer->frames_len++;
+  }
+  ww_zlib_mt_flush_frames(writer);
+
+  for (int i = 0; i <= writer->frames_max; i++) {
+    MEM_SAFE_FREE(writer->frames[i].in_buf);
+  }
+  const bool ok = !writer->error && (close(writer->file_handle) != -1);
+  MEM_freeN(writer->frames);
+  MEM_freeN(writer);
+  return ok;
+}
+
+static size_t ww_write_zlib_mt(WriteWrap *ww, const char *buf, size_t buf_len)
+{
+  ZlibFrameWriter *writer = FILE_HANDLE(ww);
+  size_t written_len = 0;
+  while (written_len < buf_len) {
+    ZlibFrame *frame = &writer->frames[writer->frames_len];
+    if (frame->in_buf == NULL) {
+      frame->in_buf = MEM_mallocN(ZLIB_FRAME_SIZE, __func__);
+    }
+    const size_t copy_len = MIN2(buf_len - written_len, ZLIB_FRAME_SIZE - frame->in_len);
+    memcpy(frame->in_buf + frame->in_len, buf + written_len, copy_len);
+    frame->in_len += copy_len;
+    written_len += copy_len;
+
+    if (frame->in_len == ZLIB_FRAME_SIZE) {
+      writer->frames_len++;
+      if (writer->frames_len == writer->frames_max) {
+        ww_zlib_mt_flush_frames(writer);
+      }
+    }
+  }
+  return writer->error ? 0 : buf_len;
+}
+#undef FILE_HANDLE
+
 /* --- end compression types --- */
 
 static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
@@ -232,6 +369,13 @@ static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
       r_ww->use_buf = false;
       break;
     }
+    case WW_WRAP_ZLIB_MT: {
+      r_ww->open = ww_open_zlib_mt;
+      r_ww->close = ww_close_zlib_mt;
+      r_ww->write = ww_write_zlib_mt;
+      r_ww->use_buf = false;
+      break;
+    }
     default: {
       r_ww->open = ww_open_none;
       r_ww->close = ww_close_none;
@@ -1152,7 +1296,7 @@ bool BLO_write_file(Main *mainvar,
   BLI_snprintf(tempname, sizeof(tempname), "%s@", filepath);
 
   if (write_flags & G_FILE_COMPRESS) {
-    ww_type = WW_WRAP_ZLIB;
+    ww_type = WW_WRAP_ZLIB_MT;
   }
   else {
     ww_type = WW_WRAP_NONE;
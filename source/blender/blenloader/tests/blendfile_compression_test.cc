@@ -0,0 +1,103 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "blendfile_loading_base_test.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_customdata.h"
+#include "BKE_global.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+
+#include "BLI_fileops.h"
+#include "BLI_path_util.h"
+
+#include "BLO_readfile.h"
+#include "BLO_writefile.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+class BlendfileCompressionTest : public BlendfileLoadingBaseTest {
+ protected:
+  /* Large enough for the compressed file to consist of several frames. */
+  static constexpr int verts_num = 1000000;
+
+  char filepath[FILE_MAX];
+
+  void SetUp() override
+  {
+    BLI_path_join(
+        filepath, sizeof(filepath), testing::TempDir().c_str(), "compression_test.blend", NULL);
+  }
+
+  void TearDown() override
+  {
+    BLI_delete(filepath, false, false);
+    BlendfileLoadingBaseTest::TearDown();
+  }
+
+  bool write_compressed_mesh_file()
+  {
+    Main *bmain = BKE_main_new();
+    Mesh *mesh = BKE_mesh_add(bmain, "Mesh");
+    mesh->totvert = verts_num;
+    CustomData_add_layer(&mesh->vdata, CD_MVERT, CD_CALLOC, nullptr, verts_num);
+    BKE_mesh_update_customdata_pointers(mesh, false);
+    for (int i = 0; i < verts_num; i++) {
+      mesh->mvert[i].co[0] = (float)i;
+    }
+
+    BlendFileWriteParams params{};
+    params.remap_mode = BLO_WRITE_PATH_REMAP_NONE;
+    const bool ok = BLO_write_file(bmain, filepath, G_FILE_COMPRESS, &params, nullptr);
+    BKE_main_free(bmain);
+    return ok;
+  }
+
+  void expect_mesh_read()
+  {
+    ASSERT_NE(bfile, nullptr);
+    const Mesh *mesh = static_cast<const Mesh *>(bfile->main->meshes.first);
+    ASSERT_NE(mesh, nullptr);
+    ASSERT_EQ(mesh->totvert, verts_num);
+    ASSERT_NE(mesh->mvert, nullptr);
+    EXPECT_EQ(mesh->mvert[0].co[0], 0.0f);
+    EXPECT_EQ(mesh->mvert[verts_num / 2].co[0], (float)(verts_num / 2));
+    EXPECT_EQ(mesh->mvert[verts_num - 1].co[0], (float)(verts_num - 1));
+  }
+};
+
+TEST_F(BlendfileCompressionTest, ReadFromFile)
+{
+  ASSERT_TRUE(write_compressed_mesh_file());
+
+  bfile = BLO_read_from_file(filepath, BLO_READ_SKIP_NONE, nullptr);
+  expect_mesh_read();
+}
+
+TEST_F(BlendfileCompressionTest, ReadFromMemory)
+{
+  ASSERT_TRUE(write_compressed_mesh_file());
+
+  size_t mem_size;
+  void *mem = BLI_file_read_binary_as_mem(filepath, 0, &mem_size);
+  ASSERT_NE(mem, nullptr);
+
+  bfile = BLO_read_from_memory(mem, (int)mem_size, BLO_READ_SKIP_NONE, nullptr);
+  MEM_freeN(mem);
+  expect_mesh_read();
+}
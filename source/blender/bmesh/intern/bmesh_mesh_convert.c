@@ -610,9 +610,10 @@ void BM_mesh_bm_to_me(Main *bmain, BMesh *bm, Mesh *me, const struct BMeshToMesh
 #if 0
   oldverts = MEM_dupallocN(me->mvert);
 #else
-    oldverts = me->mvert;
-    me->mvert = NULL;
     CustomData_update_typemap(&me->vdata);
+    /* The array might be shared with the evaluated mesh, only take ownership of our own copy. */
+    oldverts = CustomData_duplicate_referenced_layer(&me->vdata, CD_MVERT, me->totvert);
+    me->mvert = NULL;
     CustomData_set_layer(&me->vdata, CD_MVERT, NULL);
 #endif
   }
@@ -157,8 +157,11 @@ extern "C" {
  * The relevant ExecutionGroup (that can calculate the missing chunks; ExecutionGroup A)
  * is asked to calculate the area ExecutionGroup B is missing.
  * [@ref ExecutionGroup.scheduleAreaWhenPossible]
- * ExecutionGroup B checks what chunks the area spans, and tries to schedule these chunks.
- * If all input data is available these chunks are scheduled [@ref ExecutionGroup.scheduleChunk]
+ * ExecutionGroup A checks what chunks the area spans, and schedules these chunks.
+ * Every chunk of ExecutionGroup B keeps track of the chunks it waits for
+ * [@ref ExecutionGroup.add_dependent]. It is added to the WorkScheduler as soon as the last of
+ * them has been executed [@ref ExecutionGroup.schedule_when_inputs_executed], so chunks of
+ * different ExecutionGroups are executed interleaved instead of group after group.
  *
  * <pre>
  *
@@ -182,7 +185,7 @@ extern "C" {
  *            .                                .  .                                         .  O-------/
  *            .                                .  .                                         .  O
  *            .                                .  .                                         .  O
- *            .                                .  .                                         .  O-------\ ExecutionGroup.scheduleChunk
+ *            .                                .  .                                         .  O-------\ ExecutionGroup.schedule_when_inputs_executed
  *            .                                .  .                                         .  .       |
  *            .                                .  .                                         .  .  O----/
  *            .                                .  .                                         .  O<=O
@@ -226,7 +229,8 @@ extern "C" {
  * \see ExecutionGroup.scheduleAreaWhenPossible
  * Tries to schedule an area. This can be multiple chunks
  * (is called from [@ref ExecutionGroup.scheduleChunkWhenPossible])
- * \see ExecutionGroup.scheduleChunk Schedule a chunk on the WorkScheduler
+ * \see ExecutionGroup.schedule_when_inputs_executed Schedule a chunk on the WorkScheduler
+ * once all its input chunks are executed.
  * \see NodeOperation.determineDependingAreaOfInterest Influence the area of interest of a chunk.
  * \see WriteBufferOperation Operation to write to a MemoryProxy/MemoryBuffer
  * \see ReadBufferOperation Operation to read from a MemoryProxy/MemoryBuffer
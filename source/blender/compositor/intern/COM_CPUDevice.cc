@@ -30,6 +30,11 @@ CPUDevice::CPUDevice(int thread_id) : m_thread_id(thread_id)
 
 void CPUDevice::execute(WorkPackage *work_package)
 {
+  if (work_package->execute_fn) {
+    work_package->execute_fn();
+    return;
+  }
+
   const unsigned int chunkNumber = work_package->chunk_number;
   ExecutionGroup *executionGroup = work_package->execution_group;
 
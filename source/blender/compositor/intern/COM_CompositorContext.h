@@ -260,6 +260,14 @@ class CompositorContext {
     return this->getbNodeTree()->chunksize;
   }
 
+  /**
+   * \brief get the execution model the operations are executed with
+   */
+  eExecutionModel get_execution_model() const
+  {
+    return (eExecutionModel)this->getbNodeTree()->execution_mode;
+  }
+
   void setFastCalculation(bool fastCalculation)
   {
     this->m_fastCalculation = fastCalculation;
@@ -20,6 +20,8 @@
 
 #include "COM_defines.h"
 
+#include "DNA_node_types.h"
+
 #include <ostream>
 
 namespace blender::compositor {
@@ -51,6 +53,18 @@ enum class eCompositorPriority {
   Low = 0,
 };
 
+/**
+ * \brief Possible execution models of the compositor
+ * \see CompositorContext.get_execution_model
+ * \ingroup Execution
+ */
+enum class eExecutionModel {
+  /** \brief Operations are executed chunk by chunk, grouped in ExecutionGroup's */
+  Tiled = NTREE_EXECUTION_MODE_TILED,
+  /** \brief Operations are executed one after the other on whole frames */
+  FullFrame = NTREE_EXECUTION_MODE_FULL_FRAME,
+};
+
 /**
  * \brief the execution state of a chunk in an ExecutionGroup
  * \ingroup Execution
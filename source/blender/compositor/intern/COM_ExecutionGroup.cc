@@ -17,6 +17,7 @@
  */
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstdlib>
 #include <sstream>
@@ -333,8 +334,6 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
   if (this->m_chunks_len == 0) {
     return;
   } /** \note Early break out. */
-  unsigned int chunk_index;
-
   this->m_executionStartTime = PIL_check_seconds_timer();
 
   this->m_chunks_finished = 0;
@@ -345,50 +344,39 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
   DebugInfo::execution_group_started(this);
   DebugInfo::graphviz(graph);
 
+  /* Only a limited number of chunks is scheduled ahead, so they are finished in the requested
+   * order and breaking doesn't have to wait for the whole image. Chunks of the groups they read
+   * from are scheduled along with them and are executed as soon as their own inputs are ready. */
+  const unsigned int maxNumberEvaluated = BLI_system_thread_count() * 2;
+  unsigned int index = 0;
   bool breaked = false;
-  bool finished = false;
-  unsigned int startIndex = 0;
-  const int maxNumberEvaluated = BLI_system_thread_count() * 2;
-
-  while (!finished && !breaked) {
-    bool startEvaluated = false;
-    finished = true;
-    int numberEvaluated = 0;
 
-    for (int index = startIndex;
-         index < this->m_chunks_len && numberEvaluated < maxNumberEvaluated;
+  while (!breaked) {
+    for (; index < this->m_chunks_len && index - this->m_chunks_finished < maxNumberEvaluated;
          index++) {
-      chunk_index = chunk_order[index];
-      int yChunk = chunk_index / this->m_x_chunks_len;
-      int xChunk = chunk_index - (yChunk * this->m_x_chunks_len);
-      const WorkPackage &work_package = m_work_packages[chunk_index];
-      switch (work_package.state) {
-        case eWorkPackageState::NotScheduled: {
-          scheduleChunkWhenPossible(graph, xChunk, yChunk);
-          finished = false;
-          startEvaluated = true;
-          numberEvaluated++;
-
-          if (bTree->update_draw) {
-            bTree->update_draw(bTree->udh);
-          }
-          break;
-        }
-        case eWorkPackageState::Scheduled: {
-          finished = false;
-          startEvaluated = true;
-          numberEvaluated++;
-          break;
-        }
-        case eWorkPackageState::Executed: {
-          if (!startEvaluated) {
-            startIndex = index + 1;
-          }
-        }
-      };
+      const unsigned int chunk_index = chunk_order[index];
+      const int yChunk = chunk_index / this->m_x_chunks_len;
+      const int xChunk = chunk_index - (yChunk * this->m_x_chunks_len);
+      scheduleChunkWhenPossible(graph, xChunk, yChunk);
+
+      if (bTree->update_draw) {
+        bTree->update_draw(bTree->udh);
+      }
     }
 
-    WorkScheduler::finish();
+    {
+      std::unique_lock lock(m_work_packages_mutex);
+      if (this->m_chunks_finished == this->m_chunks_len) {
+        break;
+      }
+      /* Wait until more chunks can be scheduled or all of them are finished. The wait is timed,
+       * so breaking is noticed even when chunks are not executed anymore after a break. */
+      m_chunk_finished_cond.wait_for(lock, std::chrono::milliseconds(100), [&]() {
+        return (index < this->m_chunks_len &&
+                index - this->m_chunks_finished < maxNumberEvaluated) ||
+               this->m_chunks_finished == this->m_chunks_len;
+      });
+    }
 
     if (bTree->test_break && bTree->test_break(bTree->tbh)) {
       breaked = true;
@@ -427,11 +415,21 @@ MemoryBuffer *ExecutionGroup::constructConsolidatedMemoryBuffer(MemoryProxy &mem
 void ExecutionGroup::finalizeChunkExecution(int chunkNumber, MemoryBuffer **memoryBuffers)
 {
   WorkPackage &work_package = m_work_packages[chunkNumber];
-  if (work_package.state == eWorkPackageState::Scheduled) {
-    work_package.state = eWorkPackageState::Executed;
+  Vector<WorkPackage *> dependents;
+  {
+    std::lock_guard lock(m_work_packages_mutex);
+    if (work_package.state == eWorkPackageState::Scheduled) {
+      work_package.state = eWorkPackageState::Executed;
+    }
+    dependents = std::move(work_package.dependents);
+    atomic_add_and_fetch_u(&this->m_chunks_finished, 1);
+  }
+  m_chunk_finished_cond.notify_all();
+
+  for (WorkPackage *dependent : dependents) {
+    schedule_when_inputs_executed(*dependent);
   }
 
-  atomic_add_and_fetch_u(&this->m_chunks_finished, 1);
   if (memoryBuffers) {
     for (unsigned int index = 0; index < this->m_max_read_buffer_offset; index++) {
       MemoryBuffer *buffer = memoryBuffers[index];
@@ -504,10 +502,16 @@ MemoryBuffer *ExecutionGroup::allocateOutputBuffer(rcti &rect)
   return nullptr;
 }
 
-bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area)
+void ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph,
+                                              rcti *area,
+                                              WorkPackage &dependent)
 {
   if (this->m_flags.single_threaded) {
-    return scheduleChunkWhenPossible(graph, 0, 0);
+    WorkPackage *work_package = scheduleChunkWhenPossible(graph, 0, 0);
+    if (work_package) {
+      add_dependent(*work_package, dependent);
+    }
+    return;
   }
   // find all chunks inside the rect
   // determine minxchunk, minychunk, maxxchunk, maxychunk where x and y are chunknumbers
@@ -526,69 +530,70 @@ bool ExecutionGroup::scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area
   maxxchunk = min_ii(maxxchunk, (int)m_x_chunks_len);
   maxychunk = min_ii(maxychunk, (int)m_y_chunks_len);
 
-  bool result = true;
   for (indexx = minxchunk; indexx < maxxchunk; indexx++) {
     for (indexy = minychunk; indexy < maxychunk; indexy++) {
-      if (!scheduleChunkWhenPossible(graph, indexx, indexy)) {
-        result = false;
+      WorkPackage *work_package = scheduleChunkWhenPossible(graph, indexx, indexy);
+      if (work_package) {
+        add_dependent(*work_package, dependent);
       }
     }
   }
+}
 
-  return result;
+void ExecutionGroup::add_dependent(WorkPackage &work_package, WorkPackage &dependent)
+{
+  std::lock_guard lock(m_work_packages_mutex);
+  if (work_package.state == eWorkPackageState::Executed) {
+    return;
+  }
+  atomic_add_and_fetch_int32(&dependent.num_pending_inputs, 1);
+  work_package.dependents.append(&dependent);
 }
 
-bool ExecutionGroup::scheduleChunk(unsigned int chunkNumber)
+void ExecutionGroup::schedule_when_inputs_executed(WorkPackage &work_package)
 {
-  WorkPackage &work_package = m_work_packages[chunkNumber];
-  if (work_package.state == eWorkPackageState::NotScheduled) {
-    work_package.state = eWorkPackageState::Scheduled;
+  if (atomic_sub_and_fetch_int32(&work_package.num_pending_inputs, 1) == 0) {
     WorkScheduler::schedule(&work_package);
-    return true;
   }
-  return false;
 }
 
-bool ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph,
-                                               const int chunk_x,
-                                               const int chunk_y)
+WorkPackage *ExecutionGroup::scheduleChunkWhenPossible(ExecutionSystem *graph,
+                                                       const int chunk_x,
+                                                       const int chunk_y)
 {
   if (chunk_x < 0 || chunk_x >= (int)this->m_x_chunks_len) {
-    return true;
+    return nullptr;
   }
   if (chunk_y < 0 || chunk_y >= (int)this->m_y_chunks_len) {
-    return true;
+    return nullptr;
   }
 
   // Check if chunk is already executed or scheduled and not yet executed.
   const int chunk_index = chunk_y * this->m_x_chunks_len + chunk_x;
   WorkPackage &work_package = m_work_packages[chunk_index];
-  if (work_package.state == eWorkPackageState::Executed) {
-    return true;
-  }
-  if (work_package.state == eWorkPackageState::Scheduled) {
-    return false;
+  {
+    std::lock_guard lock(m_work_packages_mutex);
+    if (work_package.state != eWorkPackageState::NotScheduled) {
+      return &work_package;
+    }
+    work_package.state = eWorkPackageState::Scheduled;
   }
 
-  bool can_be_executed = true;
-  rcti area;
+  /* Hold back the package until all inputs are added, the inputs might be executed meanwhile. */
+  work_package.num_pending_inputs = 1;
 
+  rcti area;
   for (ReadBufferOperation *read_operation : m_read_operations) {
     BLI_rcti_init(&area, 0, 0, 0, 0);
     MemoryProxy *memory_proxy = read_operation->getMemoryProxy();
     determineDependingAreaOfInterest(&work_package.rect, read_operation, &area);
     ExecutionGroup *group = memory_proxy->getExecutor();
-
-    if (!group->scheduleAreaWhenPossible(graph, &area)) {
-      can_be_executed = false;
-    }
+    group->scheduleAreaWhenPossible(graph, &area, work_package);
   }
 
-  if (can_be_executed) {
-    scheduleChunk(chunk_index);
-  }
+  schedule_when_inputs_executed(work_package);
 
-  return false;
+  return &work_package;
 }
 
 void ExecutionGroup::determineDependingAreaOfInterest(rcti *input,
@@ -32,6 +32,8 @@
 #include "COM_Node.h"
 #include "COM_NodeOperation.h"
 #include "COM_WorkPackage.h"
+#include <condition_variable>
+#include <mutex>
 #include <vector>
 
 namespace blender::compositor {
@@ -155,6 +157,17 @@ class ExecutionGroup {
    */
   Vector<WorkPackage> m_work_packages;
 
+  /**
+   * Protects the state and dependents of the work packages, which are changed by the threads
+   * executing them.
+   */
+  std::mutex m_work_packages_mutex;
+
+  /**
+   * Notified when a chunk has been executed, the top execution group waits for it.
+   */
+  std::condition_variable m_chunk_finished_cond;
+
   /**
    * \brief denotes boundary for border compositing
    * \note measured in pixel space
@@ -187,35 +200,37 @@ class ExecutionGroup {
   void init_number_of_chunks();
 
   /**
-   * \brief try to schedule a specific chunk.
-   * \note scheduling succeeds when all input requirements are met and the chunks hasn't been
-   * scheduled yet.
+   * \brief schedule a specific chunk and the chunks of other execution groups it reads from.
+   * \note The chunk is added to the WorkScheduler as soon as all chunks it reads from are
+   * executed, chunks of different execution groups are executed interleaved.
    * \param graph:
    * \param xChunk:
    * \param yChunk:
-   * \return [true:false]
-   * true: package(s) are scheduled
-   * false: scheduling is deferred (depending workpackages are scheduled)
+   * \return the work package of the chunk, nullptr when the chunk is outside of the group.
    */
-  bool scheduleChunkWhenPossible(ExecutionSystem *graph, const int chunk_x, const int chunk_y);
+  WorkPackage *scheduleChunkWhenPossible(ExecutionSystem *graph,
+                                         const int chunk_x,
+                                         const int chunk_y);
 
   /**
-   * \brief try to schedule a specific area.
-   * \note Check if a certain area is available, when not available this are will be checked.
+   * \brief schedule the chunks of a specific area.
    * \note This method is called from other ExecutionGroup's.
    * \param graph:
    * \param area:
-   * \return [true:false]
-   * true: package(s) are scheduled
-   * false: scheduling is deferred (depending workpackages are scheduled)
+   * \param dependent: the work package reading the area, it is executed after all chunks of the
+   * area are executed.
    */
-  bool scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area);
+  void scheduleAreaWhenPossible(ExecutionSystem *graph, rcti *area, WorkPackage &dependent);
 
   /**
-   * \brief add a chunk to the WorkScheduler.
-   * \param chunknumber:
+   * \brief let \a dependent wait for \a work_package when it isn't executed yet.
+   */
+  void add_dependent(WorkPackage &work_package, WorkPackage &dependent);
+
+  /**
+   * \brief add a work package to the WorkScheduler when the last chunk it waits for is executed.
    */
-  bool scheduleChunk(unsigned int chunkNumber);
+  static void schedule_when_inputs_executed(WorkPackage &work_package);
 
   /**
    * \brief determine the area of interest of a certain input area
@@ -28,6 +28,7 @@
 #include "COM_Converter.h"
 #include "COM_Debug.h"
 #include "COM_ExecutionGroup.h"
+#include "COM_FullFrameExecutionModel.h"
 #include "COM_NodeOperation.h"
 #include "COM_NodeOperationBuilder.h"
 #include "COM_ReadBufferOperation.h"
@@ -185,6 +186,12 @@ void ExecutionSystem::execute()
   editingtree->stats_draw(editingtree->sdh, TIP_("Compositing | Initializing execution"));
 
   DebugInfo::execute_started(this);
+  if (m_context.get_execution_model() == eExecutionModel::FullFrame) {
+    FullFrameExecutionModel execution_model(m_context, m_operations);
+    execution_model.execute();
+    return;
+  }
+
   update_read_buffer_offset(m_operations);
 
   init_write_operations_for_execution(m_operations, m_context.getbNodeTree());
@@ -167,6 +167,9 @@ class ExecutionSystem {
    * - initialize the NodeOperation's and ExecutionGroup's
    * - schedule the output ExecutionGroup's based on their priority
    * - deinitialize the ExecutionGroup's and NodeOperation's
+   *
+   * With the full frame execution model the operations are executed by a
+   * FullFrameExecutionModel instead.
    */
   void execute();
 
@@ -0,0 +1,465 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#include "COM_FullFrameExecutionModel.h"
+
+#include "BLI_rect.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
+
+#include "BLT_translation.h"
+
+#include "COM_BufferOperation.h"
+#include "COM_CompositorContext.h"
+#include "COM_ReadBufferOperation.h"
+#include "COM_WorkScheduler.h"
+#include "COM_WriteBufferOperation.h"
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#  include "MEM_guardedalloc.h"
+#endif
+
+namespace blender::compositor {
+
+static NodeOperation *get_input_operation(NodeOperation *operation, const int index)
+{
+  NodeOperationInput *input = operation->getInputSocket(index);
+  return input->isConnected() ? &input->getLink()->getOperation() : nullptr;
+}
+
+static NodeOperation *get_write_buffer_operation(NodeOperation *read_operation)
+{
+  BLI_assert(read_operation->get_flags().is_read_buffer_operation);
+  MemoryProxy *memory_proxy = static_cast<ReadBufferOperation *>(read_operation)->getMemoryProxy();
+  return memory_proxy->getWriteBufferOperation();
+}
+
+FullFrameExecutionModel::FullFrameExecutionModel(CompositorContext &context,
+                                                 Span<NodeOperation *> operations)
+    : m_context(context),
+      m_operations(operations),
+      m_operations_num(0),
+      m_operations_finished(0),
+      m_work_pending(0)
+{
+}
+
+void FullFrameExecutionModel::execute()
+{
+  const bNodeTree *node_tree = m_context.getbNodeTree();
+  const Vector<NodeOperation *> output_operations = get_output_operations();
+
+  Set<NodeOperation *> visited;
+  for (NodeOperation *operation : output_operations) {
+    count_readers(operation, visited);
+  }
+  m_operations_num = visited.size();
+
+  WorkScheduler::start(m_context);
+  for (NodeOperation *operation : output_operations) {
+    render_operation(operation);
+  }
+  WorkScheduler::finish();
+  WorkScheduler::stop();
+
+  node_tree->stats_draw(node_tree->sdh, TIP_("Compositing | De-initializing execution"));
+
+  /* Only operations whose readers were not rendered because of a break are left. */
+  for (NodeOperation *operation : m_initialized_operations) {
+    operation->deinitExecution();
+  }
+  m_initialized_operations.clear();
+  for (MemoryBuffer *buffer : m_output_buffers.values()) {
+    delete buffer;
+  }
+  m_output_buffers.clear();
+}
+
+Vector<NodeOperation *> FullFrameExecutionModel::get_output_operations() const
+{
+  Vector<eCompositorPriority> priorities = {eCompositorPriority::High};
+  if (!m_context.isFastCalculation()) {
+    priorities.append(eCompositorPriority::Medium);
+    priorities.append(eCompositorPriority::Low);
+  }
+
+  const bool rendering = m_context.isRendering();
+  Vector<NodeOperation *> output_operations;
+  for (const eCompositorPriority priority : priorities) {
+    for (NodeOperation *operation : m_operations) {
+      if (operation->isOutputOperation(rendering) && operation->getRenderPriority() == priority) {
+        output_operations.append(operation);
+      }
+    }
+  }
+  return output_operations;
+}
+
+void FullFrameExecutionModel::count_readers(NodeOperation *operation,
+                                            Set<NodeOperation *> &visited)
+{
+  if (!visited.add(operation)) {
+    return;
+  }
+  m_readers_num.add_new(operation, 0);
+
+  for (int i = 0; i < operation->getNumberOfInputSockets(); i++) {
+    NodeOperation *input_operation = get_input_operation(operation, i);
+    if (input_operation) {
+      count_readers(input_operation, visited);
+      m_readers_num.lookup(input_operation)++;
+    }
+  }
+
+  /* The memory proxy of a write buffer operation is read through its read buffer operations. */
+  if (operation->get_flags().is_read_buffer_operation) {
+    NodeOperation *write_operation = get_write_buffer_operation(operation);
+    count_readers(write_operation, visited);
+    m_readers_num.lookup(write_operation)++;
+  }
+}
+
+void FullFrameExecutionModel::render_operation(NodeOperation *operation)
+{
+  if (m_rendered_operations.contains(operation)) {
+    return;
+  }
+
+  const int inputs_num = operation->getNumberOfInputSockets();
+  for (int i = 0; i < inputs_num; i++) {
+    NodeOperation *input_operation = get_input_operation(operation, i);
+    if (input_operation) {
+      render_operation(input_operation);
+    }
+  }
+  const bool is_read_buffer = operation->get_flags().is_read_buffer_operation;
+  if (is_read_buffer) {
+    render_operation(get_write_buffer_operation(operation));
+  }
+  if (is_breaked()) {
+    return;
+  }
+
+  operation->setbNodeTree(m_context.getbNodeTree());
+  if (is_read_buffer) {
+    /* Readers sample the buffer of the memory proxy through the read buffer operation. */
+    operation->initExecution();
+    static_cast<ReadBufferOperation *>(operation)->updateMemoryBuffer();
+    m_initialized_operations.add_new(operation);
+  }
+  else {
+    Vector<MemoryBuffer *> inputs;
+    Vector<NodeOperationOutput *> links;
+    for (int i = 0; i < inputs_num; i++) {
+      NodeOperation *input_operation = get_input_operation(operation, i);
+      inputs.append(input_operation ? m_output_buffers.lookup_default(input_operation, nullptr) :
+                                      nullptr);
+      links.append(operation->getInputSocket(i)->getLink());
+    }
+
+    const rcti area = get_render_area(operation);
+    MemoryBuffer *output = nullptr;
+    if (operation->getNumberOfOutputSockets() > 0) {
+      output = new MemoryBuffer(operation->getOutputSocket()->getDataType(), area);
+    }
+
+    const bool render_buffers = output && can_render_buffers(operation, inputs, area);
+    Vector<BufferOperation *> input_operations;
+    if (!render_buffers) {
+      input_operations = link_input_buffers(operation, inputs);
+    }
+
+    operation->initExecution();
+    if (render_buffers) {
+      render_operation_buffers(operation, output, inputs, area);
+    }
+    else {
+      render_operation_pixels(operation, output, area);
+    }
+
+    if (operation->get_flags().is_write_buffer_operation) {
+      /* The buffer of the memory proxy is freed on de-initialization, keep it until all read
+       * buffer operations are done. */
+      m_initialized_operations.add_new(operation);
+    }
+    else {
+      operation->deinitExecution();
+    }
+    unlink_input_buffers(operation, links, input_operations);
+
+    if (output) {
+      m_output_buffers.add_new(operation, output);
+    }
+  }
+
+  m_rendered_operations.add_new(operation);
+  m_operations_finished++;
+  update_progress_bar();
+
+  for (int i = 0; i < inputs_num; i++) {
+    NodeOperation *input_operation = get_input_operation(operation, i);
+    if (input_operation) {
+      release_reader(input_operation);
+    }
+  }
+  if (m_readers_num.lookup(operation) == 0) {
+    release(operation);
+  }
+}
+
+void FullFrameExecutionModel::render_operation_buffers(NodeOperation *operation,
+                                                       MemoryBuffer *output,
+                                                       Span<MemoryBuffer *> inputs,
+                                                       const rcti &area)
+{
+  execute_work(area, operation->get_flags().single_threaded, [=](const rcti &split_area) {
+    operation->update_memory_buffer(output, split_area, inputs);
+  });
+}
+
+void FullFrameExecutionModel::render_operation_pixels(NodeOperation *operation,
+                                                      MemoryBuffer *output,
+                                                      const rcti &area)
+{
+  const bool single_threaded = operation->get_flags().single_threaded;
+  if (output == nullptr) {
+    /* Output and write buffer operations store the result themselves. */
+    execute_work(area, single_threaded, [=](const rcti &split_area) {
+      rcti rect = split_area;
+      operation->executeRegion(&rect, 0);
+    });
+    return;
+  }
+
+  const bool is_complex = operation->get_flags().complex;
+  const int num_channels = output->get_num_channels();
+  execute_work(area, single_threaded, [=](const rcti &split_area) {
+    rcti rect = split_area;
+    void *data = is_complex ? operation->initializeTileData(&rect) : nullptr;
+    float color[4];
+    for (int y = rect.ymin; y < rect.ymax; y++) {
+      float *elem = output->get_elem(rect.xmin, y);
+      for (int x = rect.xmin; x < rect.xmax; x++) {
+        if (is_complex) {
+          operation->read(color, x, y, data);
+        }
+        else {
+          operation->readSampled(color, x, y, PixelSampler::Nearest);
+        }
+        memcpy(elem, color, sizeof(float) * num_channels);
+        elem += num_channels;
+      }
+    }
+    if (data) {
+      operation->deinitializeTileData(&rect, data);
+    }
+  });
+}
+
+bool FullFrameExecutionModel::can_render_buffers(NodeOperation *operation,
+                                                 Span<MemoryBuffer *> inputs,
+                                                 const rcti &area) const
+{
+  if (!operation->get_flags().is_fullframe_operation) {
+    return false;
+  }
+  for (MemoryBuffer *input : inputs) {
+    /* Inputs read through read buffer operations or with a different resolution (for example
+     * single values) are sampled per pixel. */
+    if (input == nullptr || !BLI_rcti_inside_rcti(&input->get_rect(), &area)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Vector<BufferOperation *> FullFrameExecutionModel::link_input_buffers(NodeOperation *operation,
+                                                                     Span<MemoryBuffer *> inputs)
+{
+  Vector<BufferOperation *> input_operations;
+  for (int i = 0; i < inputs.size(); i++) {
+    MemoryBuffer *buffer = inputs[i];
+    if (buffer == nullptr) {
+      /* Keep links to read buffer operations, they read from their memory proxy. */
+      input_operations.append(nullptr);
+      continue;
+    }
+    NodeOperationInput *input = operation->getInputSocket(i);
+    NodeOperationOutput *link = input->getLink();
+    BufferOperation *buffer_operation = new BufferOperation(
+        buffer, &link->getOperation(), link->getDataType());
+    buffer_operation->setbNodeTree(m_context.getbNodeTree());
+    input->setLink(buffer_operation->getOutputSocket());
+    input_operations.append(buffer_operation);
+  }
+  return input_operations;
+}
+
+void FullFrameExecutionModel::unlink_input_buffers(NodeOperation *operation,
+                                                   Span<NodeOperationOutput *> links,
+                                                   Span<BufferOperation *> input_operations)
+{
+  for (int i = 0; i < input_operations.size(); i++) {
+    if (input_operations[i]) {
+      operation->getInputSocket(i)->setLink(links[i]);
+      delete input_operations[i];
+    }
+  }
+}
+
+rcti FullFrameExecutionModel::get_render_area(NodeOperation *operation) const
+{
+  const int width = operation->getWidth();
+  const int height = operation->getHeight();
+  rcti area;
+  if (operation->getNumberOfOutputSockets() > 0) {
+    if (width == 0 || height == 0) {
+      /* Single value stored at (0,0), the same as a WriteBufferOperation does. */
+      BLI_rcti_init(&area, 0, 1, 0, 1);
+    }
+    else {
+      BLI_rcti_init(&area, 0, width, 0, height);
+    }
+    return area;
+  }
+
+  BLI_rcti_init(&area, 0, width, 0, height);
+  const NodeOperationFlags flags = operation->get_flags();
+  const RenderData *rd = m_context.getRenderData();
+  if (m_context.isRendering() && (rd->mode & R_BORDER) && !(rd->mode & R_CROP) &&
+      operation->isOutputOperation(true) && flags.use_render_border) {
+    /* Case when cropping to render border happens is handled in compositor output and render
+     * layer nodes. */
+    BLI_rcti_init(&area,
+                  rd->border.xmin * width,
+                  rd->border.xmax * width,
+                  rd->border.ymin * height,
+                  rd->border.ymax * height);
+  }
+
+  const bNodeTree *node_tree = m_context.getbNodeTree();
+  const rctf *viewer_border = &node_tree->viewer_border;
+  const bool use_viewer_border = (node_tree->flag & NTREE_VIEWER_BORDER) &&
+                                 viewer_border->xmin < viewer_border->xmax &&
+                                 viewer_border->ymin < viewer_border->ymax;
+  if (use_viewer_border && flags.use_viewer_border) {
+    BLI_rcti_init(&area,
+                  viewer_border->xmin * width,
+                  viewer_border->xmax * width,
+                  viewer_border->ymin * height,
+                  viewer_border->ymax * height);
+  }
+  return area;
+}
+
+void FullFrameExecutionModel::release_reader(NodeOperation *operation)
+{
+  int &readers_num = m_readers_num.lookup(operation);
+  BLI_assert(readers_num > 0);
+  readers_num--;
+  if (readers_num == 0) {
+    release(operation);
+  }
+}
+
+void FullFrameExecutionModel::release(NodeOperation *operation)
+{
+  if (m_initialized_operations.remove(operation)) {
+    operation->deinitExecution();
+  }
+  MemoryBuffer *buffer = m_output_buffers.pop_default(operation, nullptr);
+  delete buffer;
+
+  if (operation->get_flags().is_read_buffer_operation) {
+    release_reader(get_write_buffer_operation(operation));
+  }
+}
+
+void FullFrameExecutionModel::execute_work(const rcti &area,
+                                           const bool single_threaded,
+                                           std::function<void(const rcti &split_area)> work_func)
+{
+  if (BLI_rcti_is_empty(&area) || is_breaked()) {
+    return;
+  }
+
+  /* Split the area in horizontal stripes, a few per thread so threads finishing early can take
+   * over work of slower ones. */
+  const int area_height = BLI_rcti_size_y(&area);
+  const int stripes_num = single_threaded ? 1 :
+                                            min_ii(area_height, BLI_system_thread_count() * 4);
+  const int stripe_height = (area_height + stripes_num - 1) / stripes_num;
+
+  Vector<WorkPackage> work_packages;
+  for (int ymin = area.ymin; ymin < area.ymax; ymin += stripe_height) {
+    WorkPackage package;
+    package.chunk_number = work_packages.size();
+    BLI_rcti_init(
+        &package.rect, area.xmin, area.xmax, ymin, min_ii(ymin + stripe_height, area.ymax));
+    work_packages.append(std::move(package));
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_work_mutex);
+    m_work_pending = work_packages.size();
+  }
+  for (WorkPackage &package : work_packages) {
+    package.execute_fn = [this, &package, &work_func]() {
+      work_func(package.rect);
+      work_finished();
+    };
+    WorkScheduler::schedule(&package);
+  }
+
+  std::unique_lock<std::mutex> lock(m_work_mutex);
+  m_work_finished_cond.wait(lock, [&] { return m_work_pending == 0; });
+}
+
+void FullFrameExecutionModel::work_finished()
+{
+  std::lock_guard<std::mutex> lock(m_work_mutex);
+  m_work_pending--;
+  if (m_work_pending == 0) {
+    m_work_finished_cond.notify_all();
+  }
+}
+
+bool FullFrameExecutionModel::is_breaked() const
+{
+  const bNodeTree *node_tree = m_context.getbNodeTree();
+  return node_tree->test_break && node_tree->test_break(node_tree->tbh);
+}
+
+void FullFrameExecutionModel::update_progress_bar()
+{
+  const bNodeTree *node_tree = m_context.getbNodeTree();
+  if (node_tree) {
+    const float progress = (float)m_operations_finished / m_operations_num;
+    node_tree->progress(node_tree->prh, progress);
+
+    char buf[128];
+    BLI_snprintf(buf,
+                 sizeof(buf),
+                 TIP_("Compositing | Operation %i-%i"),
+                 m_operations_finished,
+                 m_operations_num);
+    node_tree->stats_draw(node_tree->sdh, buf);
+  }
+}
+
+}  // namespace blender::compositor
@@ -0,0 +1,123 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#pragma once
+
+#include "BLI_map.hh"
+#include "BLI_set.hh"
+#include "BLI_span.hh"
+#include "BLI_vector.hh"
+
+#include "DNA_vec_types.h"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+namespace blender::compositor {
+
+class BufferOperation;
+class CompositorContext;
+class MemoryBuffer;
+class NodeOperation;
+class NodeOperationOutput;
+
+/**
+ * \brief Executes the operations of an ExecutionSystem on whole frames.
+ *
+ * Starting at the output operations, the operations are rendered depth first: all inputs of an
+ * operation are completely calculated before the operation itself is rendered in one pass.
+ * The output buffers of the operations are reference counted by the number of operations that
+ * read them and are freed as soon as the last reader has been rendered.
+ *
+ * Operations which implement NodeOperation.update_memory_buffer process their input buffers
+ * directly. Other operations read their inputs per pixel through a BufferOperation.
+ *
+ * \see eExecutionModel::FullFrame
+ * \ingroup Execution
+ */
+class FullFrameExecutionModel {
+ private:
+  CompositorContext &m_context;
+  Span<NodeOperation *> m_operations;
+
+  /** Output buffers of rendered operations that are still going to be read. */
+  Map<NodeOperation *, MemoryBuffer *> m_output_buffers;
+
+  /** Number of operations that still need to read the output of an operation. */
+  Map<NodeOperation *, int> m_readers_num;
+
+  Set<NodeOperation *> m_rendered_operations;
+
+  /** Operations that are kept initialized until all their readers have been rendered. */
+  Set<NodeOperation *> m_initialized_operations;
+
+  int m_operations_num;
+  int m_operations_finished;
+
+  std::mutex m_work_mutex;
+  std::condition_variable m_work_finished_cond;
+  int m_work_pending;
+
+ public:
+  FullFrameExecutionModel(CompositorContext &context, Span<NodeOperation *> operations);
+
+  /**
+   * \brief render all output operations, ordered by their render priority
+   */
+  void execute();
+
+ private:
+  Vector<NodeOperation *> get_output_operations() const;
+  void count_readers(NodeOperation *operation, Set<NodeOperation *> &visited);
+
+  void render_operation(NodeOperation *operation);
+  void render_operation_buffers(NodeOperation *operation,
+                                MemoryBuffer *output,
+                                Span<MemoryBuffer *> inputs,
+                                const rcti &area);
+  void render_operation_pixels(NodeOperation *operation, MemoryBuffer *output, const rcti &area);
+
+  bool can_render_buffers(NodeOperation *operation,
+                          Span<MemoryBuffer *> inputs,
+                          const rcti &area) const;
+  Vector<BufferOperation *> link_input_buffers(NodeOperation *operation,
+                                               Span<MemoryBuffer *> inputs);
+  void unlink_input_buffers(NodeOperation *operation,
+                            Span<NodeOperationOutput *> links,
+                            Span<BufferOperation *> input_operations);
+
+  rcti get_render_area(NodeOperation *operation) const;
+
+  void release_reader(NodeOperation *operation);
+  void release(NodeOperation *operation);
+
+  void execute_work(const rcti &area,
+                    bool single_threaded,
+                    std::function<void(const rcti &split_area)> work_func);
+  void work_finished();
+
+  bool is_breaked() const;
+  void update_progress_bar();
+
+#ifdef WITH_CXX_GUARDEDALLOC
+  MEM_CXX_CLASS_ALLOC_FUNCS("COM:FullFrameExecutionModel")
+#endif
+};
+
+}  // namespace blender::compositor
@@ -117,6 +117,23 @@ class MemoryBuffer {
     return this->m_buffer;
   }
 
+  /**
+   * \brief get the offset of the element at the given coordinates, in floats
+   */
+  int get_coords_offset(int x, int y) const
+  {
+    return ((y - m_rect.ymin) * getWidth() + (x - m_rect.xmin)) * m_num_channels;
+  }
+
+  /**
+   * \brief get a pointer to the element at the given coordinates
+   */
+  float *get_elem(int x, int y)
+  {
+    BLI_assert(x >= m_rect.xmin && x < m_rect.xmax && y >= m_rect.ymin && y < m_rect.ymax);
+    return m_buffer + get_coords_offset(x, y);
+  }
+
   inline void wrap_pixel(int &x, int &y, MemoryBufferExtend extend_x, MemoryBufferExtend extend_y)
   {
     const int w = getWidth();
@@ -267,6 +267,9 @@ std::ostream &operator<<(std::ostream &os, const NodeOperationFlags &node_operat
   if (!node_operation_flags.use_datatype_conversion) {
     os << "no_conversion,";
   }
+  if (node_operation_flags.is_fullframe_operation) {
+    os << "full_frame,";
+  }
 
   return os;
 }
@@ -24,6 +24,7 @@
 
 #include "BLI_math_color.h"
 #include "BLI_math_vector.h"
+#include "BLI_span.hh"
 #include "BLI_threads.h"
 
 #include "COM_Enums.h"
@@ -232,6 +233,13 @@ struct NodeOperationFlags {
    */
   bool use_datatype_conversion : 1;
 
+  /**
+   * Does the operation implement #NodeOperation.update_memory_buffer, so it can calculate whole
+   * buffers at once when using the full frame execution model.
+   * \see eExecutionModel::FullFrame
+   */
+  bool is_fullframe_operation : 1;
+
   NodeOperationFlags()
   {
     complex = false;
@@ -247,6 +255,7 @@ struct NodeOperationFlags {
     is_viewer_operation = false;
     is_preview_operation = false;
     use_datatype_conversion = true;
+    is_fullframe_operation = false;
   }
 };
 
@@ -432,6 +441,20 @@ class NodeOperation {
   }
   virtual void deinitExecution();
 
+  /**
+   * \brief calculate an area of the output at once, used by the full frame execution model
+   * \note only called when NodeOperationFlags.is_fullframe_operation is set
+   * \param output: the buffer to write to, it covers at least \a area
+   * \param area: the area of the output to calculate, may be called concurrently for other areas
+   * \param inputs: fully calculated buffers of the input operations, in input socket order.
+   * Buffers cover at least \a area.
+   */
+  virtual void update_memory_buffer(MemoryBuffer * /*output*/,
+                                    const rcti & /*area*/,
+                                    Span<MemoryBuffer *> /*inputs*/)
+  {
+  }
+
   /**
    * \brief set the resolution
    * \param resolution: the resolution to set
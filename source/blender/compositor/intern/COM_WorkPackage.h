@@ -21,7 +21,9 @@
 #include "COM_Enums.h"
 
 #include "BLI_rect.h"
+#include "BLI_vector.hh"
 
+#include <functional>
 #include <ostream>
 
 namespace blender::compositor {
@@ -37,8 +39,9 @@ struct WorkPackage {
 
   /**
    * \brief executionGroup with the operations-setup to be evaluated
+   * \note nullptr for work packages that only run #execute_fn
    */
-  ExecutionGroup *execution_group;
+  ExecutionGroup *execution_group = nullptr;
 
   /**
    * \brief number of the chunk to be executed
@@ -50,6 +53,24 @@ struct WorkPackage {
    */
   rcti rect;
 
+  /**
+   * Number of work packages of other execution groups which need to be executed before this one
+   * can be executed. Accessed with atomic operations.
+   */
+  int num_pending_inputs = 0;
+
+  /**
+   * Work packages which read from this one and wait for it to be executed. Protected by the
+   * mutex of the execution group.
+   */
+  Vector<WorkPackage *> dependents;
+
+  /**
+   * When set, the work package is executed by calling this function instead of executing a chunk
+   * of #execution_group. Used by the full frame execution model.
+   */
+  std::function<void()> execute_fn;
+
 #ifdef WITH_CXX_GUARDEDALLOC
   MEM_CXX_CLASS_ALLOC_FUNCS("COM:WorkPackage")
 #endif
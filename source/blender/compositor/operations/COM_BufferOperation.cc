@@ -0,0 +1,69 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#include "COM_BufferOperation.h"
+
+namespace blender::compositor {
+
+BufferOperation::BufferOperation(MemoryBuffer *buffer, NodeOperation *source, DataType data_type)
+{
+  this->m_buffer = buffer;
+  this->m_source = source;
+  this->m_single_value = source->getWidth() == 0 || source->getHeight() == 0;
+  this->addOutputSocket(data_type);
+  this->setWidth(source->getWidth());
+  this->setHeight(source->getHeight());
+}
+
+void *BufferOperation::initializeTileData(rcti * /*rect*/)
+{
+  return m_buffer;
+}
+
+void BufferOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
+{
+  if (m_single_value) {
+    m_buffer->read(output, 0, 0);
+  }
+  else if (sampler == PixelSampler::Nearest) {
+    m_buffer->read(output, x, y);
+  }
+  else {
+    m_buffer->readBilinear(output, x, y);
+  }
+}
+
+void BufferOperation::executePixelFiltered(
+    float output[4], float x, float y, float dx[2], float dy[2])
+{
+  if (m_single_value) {
+    m_buffer->read(output, 0, 0);
+  }
+  else {
+    const float uv[2] = {x, y};
+    const float deriv[2][2] = {{dx[0], dx[1]}, {dy[0], dy[1]}};
+    m_buffer->readEWA(output, uv, deriv);
+  }
+}
+
+std::unique_ptr<MetaData> BufferOperation::getMetaData()
+{
+  return m_source->getMetaData();
+}
+
+}  // namespace blender::compositor
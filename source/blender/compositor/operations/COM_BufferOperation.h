@@ -0,0 +1,50 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2021, Blender Foundation.
+ */
+
+#pragma once
+
+#include "COM_MemoryBuffer.h"
+#include "COM_NodeOperation.h"
+
+namespace blender::compositor {
+
+/**
+ * \brief Reads a fully calculated MemoryBuffer of another operation.
+ *
+ * Used by the full frame execution model to feed operations that don't implement
+ * NodeOperation.update_memory_buffer. The buffer is read the same way a ReadBufferOperation reads
+ * the buffer of its WriteBufferOperation.
+ */
+class BufferOperation : public NodeOperation {
+ private:
+  MemoryBuffer *m_buffer;
+  /** Operation that calculated the buffer, used to look up meta data. */
+  NodeOperation *m_source;
+  /** The source has no resolution, a single value is stored at (0,0). */
+  bool m_single_value;
+
+ public:
+  BufferOperation(MemoryBuffer *buffer, NodeOperation *source, DataType data_type);
+
+  void *initializeTileData(rcti *rect) override;
+  void executePixelSampled(float output[4], float x, float y, PixelSampler sampler) override;
+  void executePixelFiltered(float output[4], float x, float y, float dx[2], float dy[2]) override;
+  std::unique_ptr<MetaData> getMetaData() override;
+};
+
+}  // namespace blender::compositor
@@ -18,6 +18,7 @@
 
 #include "COM_ColorBalanceLGGOperation.h"
 #include "BLI_math.h"
+#include "BLI_simd.h"
 
 namespace blender::compositor {
 
@@ -46,6 +47,7 @@ ColorBalanceLGGOperation::ColorBalanceLGGOperation()
   this->m_inputValueOperation = nullptr;
   this->m_inputColorOperation = nullptr;
   this->setResolutionInputSocketIndex(1);
+  flags.is_fullframe_operation = true;
 }
 
 void ColorBalanceLGGOperation::initExecution()
@@ -81,6 +83,49 @@ void ColorBalanceLGGOperation::executePixelSampled(float output[4],
   output[3] = inputColor[3];
 }
 
+void ColorBalanceLGGOperation::update_memory_buffer(MemoryBuffer *output,
+                                                    const rcti &area,
+                                                    Span<MemoryBuffer *> inputs)
+{
+  const int width = BLI_rcti_size_x(&area);
+#ifdef BLI_HAVE_SSE2
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 lift = _mm_setr_ps(m_lift[0], m_lift[1], m_lift[2], 0.0f);
+  const __m128 gain = _mm_setr_ps(m_gain[0], m_gain[1], m_gain[2], 0.0f);
+#endif
+  for (int y = area.ymin; y < area.ymax; y++) {
+    float *out = output->get_elem(area.xmin, y);
+    const float *value = inputs[0]->get_elem(area.xmin, y);
+    const float *color = inputs[1]->get_elem(area.xmin, y);
+    for (int i = 0; i < width; i++, out += 4, value++, color += 4) {
+      const float fac = MIN2(1.0f, value[0]);
+      const float mfac = 1.0f - fac;
+
+      /* Same as #colorbalance_lgg, with lift and gain applied to all channels at once. The
+       * exact sRGB conversions are used so the result matches the per pixel path. */
+      float balanced[4] = {linearrgb_to_srgb(color[0]),
+                           linearrgb_to_srgb(color[1]),
+                           linearrgb_to_srgb(color[2]),
+                           0.0f};
+#ifdef BLI_HAVE_SSE2
+      __m128 x = _mm_loadu_ps(balanced);
+      x = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_sub_ps(x, one), lift), one), gain);
+      /* prevent NaN */
+      _mm_storeu_ps(balanced, _mm_max_ps(x, zero));
+#else
+      for (int k = 0; k < 3; k++) {
+        balanced[k] = max_ff((((balanced[k] - 1.0f) * m_lift[k]) + 1.0f) * m_gain[k], 0.0f);
+      }
+#endif
+      for (int k = 0; k < 3; k++) {
+        out[k] = mfac * color[k] + fac * powf(srgb_to_linearrgb(balanced[k]), m_gamma_inv[k]);
+      }
+      out[3] = color[3];
+    }
+  }
+}
+
 void ColorBalanceLGGOperation::deinitExecution()
 {
   this->m_inputValueOperation = nullptr;
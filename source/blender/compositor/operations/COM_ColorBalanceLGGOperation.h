@@ -59,6 +59,10 @@ class ColorBalanceLGGOperation : public NodeOperation {
    */
   void deinitExecution() override;
 
+  void update_memory_buffer(MemoryBuffer *output,
+                            const rcti &area,
+                            Span<MemoryBuffer *> inputs) override;
+
   void setGain(const float gain[3])
   {
     copy_v3_v3(this->m_gain, gain);
@@ -37,12 +37,24 @@ void ConvertBaseOperation::deinitExecution()
   this->m_inputOperation = nullptr;
 }
 
+void ConvertBaseOperation::update_memory_buffer(MemoryBuffer *output,
+                                                const rcti &area,
+                                                Span<MemoryBuffer *> inputs)
+{
+  const int width = BLI_rcti_size_x(&area);
+  for (int y = area.ymin; y < area.ymax; y++) {
+    update_memory_buffer_row(
+        output->get_elem(area.xmin, y), inputs[0]->get_elem(area.xmin, y), width);
+  }
+}
+
 /* ******** Value to Color ******** */
 
 ConvertValueToColorOperation::ConvertValueToColorOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(DataType::Value);
   this->addOutputSocket(DataType::Color);
+  flags.is_fullframe_operation = true;
 }
 
 void ConvertValueToColorOperation::executePixelSampled(float output[4],
@@ -56,12 +68,23 @@ void ConvertValueToColorOperation::executePixelSampled(float output[4],
   output[3] = 1.0f;
 }
 
+void ConvertValueToColorOperation::update_memory_buffer_row(float *out,
+                                                            const float *in,
+                                                            const int width)
+{
+  for (int i = 0; i < width; i++, out += 4, in++) {
+    out[0] = out[1] = out[2] = in[0];
+    out[3] = 1.0f;
+  }
+}
+
 /* ******** Color to Value ******** */
 
 ConvertColorToValueOperation::ConvertColorToValueOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(DataType::Color);
   this->addOutputSocket(DataType::Value);
+  flags.is_fullframe_operation = true;
 }
 
 void ConvertColorToValueOperation::executePixelSampled(float output[4],
@@ -74,12 +97,22 @@ void ConvertColorToValueOperation::executePixelSampled(float output[4],
   output[0] = (inputColor[0] + inputColor[1] + inputColor[2]) / 3.0f;
 }
 
+void ConvertColorToValueOperation::update_memory_buffer_row(float *out,
+                                                            const float *in,
+                                                            const int width)
+{
+  for (int i = 0; i < width; i++, out++, in += 4) {
+    out[0] = (in[0] + in[1] + in[2]) / 3.0f;
+  }
+}
+
 /* ******** Color to BW ******** */
 
 ConvertColorToBWOperation::ConvertColorToBWOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(DataType::Color);
   this->addOutputSocket(DataType::Value);
+  flags.is_fullframe_operation = true;
 }
 
 void ConvertColorToBWOperation::executePixelSampled(float output[4],
@@ -92,12 +125,22 @@ void ConvertColorToBWOperation::executePixelSampled(float output[4],
   output[0] = IMB_colormanagement_get_luminance(inputColor);
 }
 
+void ConvertColorToBWOperation::update_memory_buffer_row(float *out,
+                                                         const float *in,
+                                                         const int width)
+{
+  for (int i = 0; i < width; i++, out++, in += 4) {
+    out[0] = IMB_colormanagement_get_luminance(in);
+  }
+}
+
 /* ******** Color to Vector ******** */
 
 ConvertColorToVectorOperation::ConvertColorToVectorOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(DataType::Color);
   this->addOutputSocket(DataType::Vector);
+  flags.is_fullframe_operation = true;
 }
 
 void ConvertColorToVectorOperation::executePixelSampled(float output[4],
@@ -110,12 +153,22 @@ void ConvertColorToVectorOperation::executePixelSampled(float output[4],
   copy_v3_v3(output, color);
 }
 
+void ConvertColorToVectorOperation::update_memory_buffer_row(float *out,
+                                                             const float *in,
+                                                             const int width)
+{
+  for (int i = 0; i < width; i++, out += 3, in += 4) {
+    copy_v3_v3(out, in);
+  }
+}
+
 /* ******** Value to Vector ******** */
 
 ConvertValueToVectorOperation::ConvertValueToVectorOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(DataType::Value);
   this->addOutputSocket(DataType::Vector);
+  flags.is_fullframe_operation = true;
 }
 
 void ConvertValueToVectorOperation::executePixelSampled(float output[4],
@@ -128,12 +181,22 @@ void ConvertValueToVectorOperation::executePixelSampled(float output[4],
   output[0] = output[1] = output[2] = value;
 }
 
+void ConvertValueToVectorOperation::update_memory_buffer_row(float *out,
+                                                             const float *in,
+                                                             const int width)
+{
+  for (int i = 0; i < width; i++, out += 3, in++) {
+    out[0] = out[1] = out[2] = in[0];
+  }
+}
+
 /* ******** Vector to Color ******** */
 
 ConvertVectorToColorOperation::ConvertVectorToColorOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(DataType::Vector);
   this->addOutputSocket(DataType::Color);
+  flags.is_fullframe_operation = true;
 }
 
 void ConvertVectorToColorOperation::executePixelSampled(float output[4],
@@ -145,12 +208,23 @@ void ConvertVectorToColorOperation::executePixelSampled(float output[4],
   output[3] = 1.0f;
 }
 
+void ConvertVectorToColorOperation::update_memory_buffer_row(float *out,
+                                                             const float *in,
+                                                             const int width)
+{
+  for (int i = 0; i < width; i++, out += 4, in += 3) {
+    copy_v3_v3(out, in);
+    out[3] = 1.0f;
+  }
+}
+
 /* ******** Vector to Value ******** */
 
 ConvertVectorToValueOperation::ConvertVectorToValueOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(DataType::Vector);
   this->addOutputSocket(DataType::Value);
+  flags.is_fullframe_operation = true;
 }
 
 void ConvertVectorToValueOperation::executePixelSampled(float output[4],
@@ -163,6 +237,15 @@ void ConvertVectorToValueOperation::executePixelSampled(float output[4],
   output[0] = (input[0] + input[1] + input[2]) / 3.0f;
 }
 
+void ConvertVectorToValueOperation::update_memory_buffer_row(float *out,
+                                                             const float *in,
+                                                             const int width)
+{
+  for (int i = 0; i < width; i++, out++, in += 3) {
+    out[0] = (in[0] + in[1] + in[2]) / 3.0f;
+  }
+}
+
 /* ******** RGB to YCC ******** */
 
 ConvertRGBToYCCOperation::ConvertRGBToYCCOperation() : ConvertBaseOperation()
@@ -31,6 +31,19 @@ class ConvertBaseOperation : public NodeOperation {
 
   void initExecution() override;
   void deinitExecution() override;
+
+  void update_memory_buffer(MemoryBuffer *output,
+                            const rcti &area,
+                            Span<MemoryBuffer *> inputs) final;
+
+ protected:
+  /**
+   * Convert \a width elements of the input, used by the full frame execution model.
+   * Only called for conversions that set NodeOperationFlags.is_fullframe_operation.
+   */
+  virtual void update_memory_buffer_row(float * /*out*/, const float * /*in*/, int /*width*/)
+  {
+  }
 };
 
 class ConvertValueToColorOperation : public ConvertBaseOperation {
@@ -38,6 +51,8 @@ class ConvertValueToColorOperation : public ConvertBaseOperation {
   ConvertValueToColorOperation();
 
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler) override;
+ protected:
+  void update_memory_buffer_row(float *out, const float *in, int width) override;
 };
 
 class ConvertColorToValueOperation : public ConvertBaseOperation {
@@ -45,6 +60,8 @@ class ConvertColorToValueOperation : public ConvertBaseOperation {
   ConvertColorToValueOperation();
 
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler) override;
+ protected:
+  void update_memory_buffer_row(float *out, const float *in, int width) override;
 };
 
 class ConvertColorToBWOperation : public ConvertBaseOperation {
@@ -52,6 +69,8 @@ class ConvertColorToBWOperation : public ConvertBaseOperation {
   ConvertColorToBWOperation();
 
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler) override;
+ protected:
+  void update_memory_buffer_row(float *out, const float *in, int width) override;
 };
 
 class ConvertColorToVectorOperation : public ConvertBaseOperation {
@@ -59,6 +78,8 @@ class ConvertColorToVectorOperation : public ConvertBaseOperation {
   ConvertColorToVectorOperation();
 
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler) override;
+ protected:
+  void update_memory_buffer_row(float *out, const float *in, int width) override;
 };
 
 class ConvertValueToVectorOperation : public ConvertBaseOperation {
@@ -66,6 +87,8 @@ class ConvertValueToVectorOperation : public ConvertBaseOperation {
   ConvertValueToVectorOperation();
 
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler) override;
+ protected:
+  void update_memory_buffer_row(float *out, const float *in, int width) override;
 };
 
 class ConvertVectorToColorOperation : public ConvertBaseOperation {
@@ -73,6 +96,8 @@ class ConvertVectorToColorOperation : public ConvertBaseOperation {
   ConvertVectorToColorOperation();
 
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler) override;
+ protected:
+  void update_memory_buffer_row(float *out, const float *in, int width) override;
 };
 
 class ConvertVectorToValueOperation : public ConvertBaseOperation {
@@ -80,6 +105,8 @@ class ConvertVectorToValueOperation : public ConvertBaseOperation {
   ConvertVectorToValueOperation();
 
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler) override;
+ protected:
+  void update_memory_buffer_row(float *out, const float *in, int width) override;
 };
 
 class ConvertRGBToYCCOperation : public ConvertBaseOperation {
@@ -28,6 +28,7 @@ GammaOperation::GammaOperation()
   this->addOutputSocket(DataType::Color);
   this->m_inputProgram = nullptr;
   this->m_inputGammaProgram = nullptr;
+  flags.is_fullframe_operation = true;
 }
 void GammaOperation::initExecution()
 {
@@ -51,6 +52,25 @@ void GammaOperation::executePixelSampled(float output[4], float x, float y, Pixe
   output[3] = inputValue[3];
 }
 
+void GammaOperation::update_memory_buffer(MemoryBuffer *output,
+                                          const rcti &area,
+                                          Span<MemoryBuffer *> inputs)
+{
+  const int width = BLI_rcti_size_x(&area);
+  for (int y = area.ymin; y < area.ymax; y++) {
+    float *out = output->get_elem(area.xmin, y);
+    const float *color = inputs[0]->get_elem(area.xmin, y);
+    const float *gamma = inputs[1]->get_elem(area.xmin, y);
+    for (int i = 0; i < width; i++, out += 4, color += 4, gamma++) {
+      /* check for negative to avoid nan's */
+      for (int k = 0; k < 3; k++) {
+        out[k] = color[k] > 0.0f ? powf(color[k], *gamma) : color[k];
+      }
+      out[3] = color[3];
+    }
+  }
+}
+
 void GammaOperation::deinitExecution()
 {
   this->m_inputProgram = nullptr;
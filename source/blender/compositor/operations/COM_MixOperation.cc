@@ -19,9 +19,17 @@
 #include "COM_MixOperation.h"
 
 #include "BLI_math.h"
+#include "BLI_simd.h"
 
 namespace blender::compositor {
 
+#ifdef BLI_HAVE_SSE2
+BLI_INLINE __m128 abs_ps(const __m128 x)
+{
+  return _mm_andnot_ps(_mm_set1_ps(-0.0f), x);
+}
+#endif
+
 /* ******** Mix Base Operation ******** */
 
 MixBaseOperation::MixBaseOperation()
@@ -97,8 +105,41 @@ void MixBaseOperation::deinitExecution()
   this->m_inputColor2Operation = nullptr;
 }
 
+void MixBaseOperation::update_memory_buffer(MemoryBuffer *output,
+                                            const rcti &area,
+                                            Span<MemoryBuffer *> inputs)
+{
+  const int width = BLI_rcti_size_x(&area);
+  for (int y = area.ymin; y < area.ymax; y++) {
+    float *out = output->get_elem(area.xmin, y);
+    update_memory_buffer_row(out,
+                             inputs[0]->get_elem(area.xmin, y),
+                             inputs[1]->get_elem(area.xmin, y),
+                             inputs[2]->get_elem(area.xmin, y),
+                             width);
+    if (m_useClamp) {
+#ifdef BLI_HAVE_SSE2
+      const __m128 zero = _mm_setzero_ps();
+      const __m128 one = _mm_set1_ps(1.0f);
+      for (int i = 0; i < width; i++, out += 4) {
+        _mm_storeu_ps(out, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(out), zero), one));
+      }
+#else
+      for (int i = 0; i < width; i++, out += 4) {
+        clamp_v4(out, 0.0f, 1.0f);
+      }
+#endif
+    }
+  }
+}
+
 /* ******** Mix Add Operation ******** */
 
+MixAddOperation::MixAddOperation()
+{
+  flags.is_fullframe_operation = true;
+}
+
 void MixAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
   float inputColor1[4];
@@ -121,8 +162,35 @@ void MixAddOperation::executePixelSampled(float output[4], float x, float y, Pix
   clampIfNeeded(output);
 }
 
+void MixAddOperation::update_memory_buffer_row(float *out,
+                                               const float *value,
+                                               const float *color1,
+                                               const float *color2,
+                                               const int width)
+{
+  for (int i = 0; i < width; i++, out += 4, color1 += 4, color2 += 4) {
+    const float fac = get_mix_factor(value[i], color2);
+#ifdef BLI_HAVE_SSE2
+    const __m128 c1 = _mm_loadu_ps(color1);
+    const __m128 c2 = _mm_loadu_ps(color2);
+    const __m128 f = _mm_set1_ps(fac);
+    _mm_storeu_ps(out, _mm_add_ps(c1, _mm_mul_ps(f, c2)));
+#else
+    for (int k = 0; k < 3; k++) {
+      out[k] = color1[k] + fac * color2[k];
+    }
+#endif
+    out[3] = color1[3];
+  }
+}
+
 /* ******** Mix Blend Operation ******** */
 
+MixBlendOperation::MixBlendOperation()
+{
+  flags.is_fullframe_operation = true;
+}
+
 void MixBlendOperation::executePixelSampled(float output[4],
                                             float x,
                                             float y,
@@ -150,6 +218,30 @@ void MixBlendOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixBlendOperation::update_memory_buffer_row(float *out,
+                                                 const float *value,
+                                                 const float *color1,
+                                                 const float *color2,
+                                                 const int width)
+{
+  for (int i = 0; i < width; i++, out += 4, color1 += 4, color2 += 4) {
+    const float fac = get_mix_factor(value[i], color2);
+    const float facm = 1.0f - fac;
+#ifdef BLI_HAVE_SSE2
+    const __m128 c1 = _mm_loadu_ps(color1);
+    const __m128 c2 = _mm_loadu_ps(color2);
+    const __m128 f = _mm_set1_ps(fac);
+    const __m128 fm = _mm_set1_ps(facm);
+    _mm_storeu_ps(out, _mm_add_ps(_mm_mul_ps(fm, c1), _mm_mul_ps(f, c2)));
+#else
+    for (int k = 0; k < 3; k++) {
+      out[k] = facm * color1[k] + fac * color2[k];
+    }
+#endif
+    out[3] = color1[3];
+  }
+}
+
 /* ******** Mix Burn Operation ******** */
 
 void MixColorBurnOperation::executePixelSampled(float output[4],
@@ -270,6 +362,11 @@ void MixColorOperation::executePixelSampled(float output[4],
 
 /* ******** Mix Darken Operation ******** */
 
+MixDarkenOperation::MixDarkenOperation()
+{
+  flags.is_fullframe_operation = true;
+}
+
 void MixDarkenOperation::executePixelSampled(float output[4],
                                              float x,
                                              float y,
@@ -296,8 +393,37 @@ void MixDarkenOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixDarkenOperation::update_memory_buffer_row(float *out,
+                                                  const float *value,
+                                                  const float *color1,
+                                                  const float *color2,
+                                                  const int width)
+{
+  for (int i = 0; i < width; i++, out += 4, color1 += 4, color2 += 4) {
+    const float fac = get_mix_factor(value[i], color2);
+    const float facm = 1.0f - fac;
+#ifdef BLI_HAVE_SSE2
+    const __m128 c1 = _mm_loadu_ps(color1);
+    const __m128 c2 = _mm_loadu_ps(color2);
+    const __m128 f = _mm_set1_ps(fac);
+    const __m128 fm = _mm_set1_ps(facm);
+    _mm_storeu_ps(out, _mm_add_ps(_mm_mul_ps(_mm_min_ps(c1, c2), f), _mm_mul_ps(c1, fm)));
+#else
+    for (int k = 0; k < 3; k++) {
+      out[k] = min_ff(color1[k], color2[k]) * fac + color1[k] * facm;
+    }
+#endif
+    out[3] = color1[3];
+  }
+}
+
 /* ******** Mix Difference Operation ******** */
 
+MixDifferenceOperation::MixDifferenceOperation()
+{
+  flags.is_fullframe_operation = true;
+}
+
 void MixDifferenceOperation::executePixelSampled(float output[4],
                                                  float x,
                                                  float y,
@@ -324,6 +450,30 @@ void MixDifferenceOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixDifferenceOperation::update_memory_buffer_row(float *out,
+                                                      const float *value,
+                                                      const float *color1,
+                                                      const float *color2,
+                                                      const int width)
+{
+  for (int i = 0; i < width; i++, out += 4, color1 += 4, color2 += 4) {
+    const float fac = get_mix_factor(value[i], color2);
+    const float facm = 1.0f - fac;
+#ifdef BLI_HAVE_SSE2
+    const __m128 c1 = _mm_loadu_ps(color1);
+    const __m128 c2 = _mm_loadu_ps(color2);
+    const __m128 f = _mm_set1_ps(fac);
+    const __m128 fm = _mm_set1_ps(facm);
+    _mm_storeu_ps(out, _mm_add_ps(_mm_mul_ps(fm, c1), _mm_mul_ps(f, abs_ps(_mm_sub_ps(c1, c2)))));
+#else
+    for (int k = 0; k < 3; k++) {
+      out[k] = facm * color1[k] + fac * fabsf(color1[k] - color2[k]);
+    }
+#endif
+    out[3] = color1[3];
+  }
+}
+
 /* ******** Mix Difference Operation ******** */
 
 void MixDivideOperation::executePixelSampled(float output[4],
@@ -526,6 +676,11 @@ void MixHueOperation::executePixelSampled(float output[4], float x, float y, Pix
 
 /* ******** Mix Lighten Operation ******** */
 
+MixLightenOperation::MixLightenOperation()
+{
+  flags.is_fullframe_operation = true;
+}
+
 void MixLightenOperation::executePixelSampled(float output[4],
                                               float x,
                                               float y,
@@ -570,6 +725,28 @@ void MixLightenOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixLightenOperation::update_memory_buffer_row(float *out,
+                                                   const float *value,
+                                                   const float *color1,
+                                                   const float *color2,
+                                                   const int width)
+{
+  for (int i = 0; i < width; i++, out += 4, color1 += 4, color2 += 4) {
+    const float fac = get_mix_factor(value[i], color2);
+#ifdef BLI_HAVE_SSE2
+    const __m128 c1 = _mm_loadu_ps(color1);
+    const __m128 c2 = _mm_loadu_ps(color2);
+    const __m128 f = _mm_set1_ps(fac);
+    _mm_storeu_ps(out, _mm_max_ps(_mm_mul_ps(f, c2), c1));
+#else
+    for (int k = 0; k < 3; k++) {
+      out[k] = max_ff(fac * color2[k], color1[k]);
+    }
+#endif
+    out[3] = color1[3];
+  }
+}
+
 /* ******** Mix Linear Light Operation ******** */
 
 void MixLinearLightOperation::executePixelSampled(float output[4],
@@ -615,6 +792,11 @@ void MixLinearLightOperation::executePixelSampled(float output[4],
 
 /* ******** Mix Multiply Operation ******** */
 
+MixMultiplyOperation::MixMultiplyOperation()
+{
+  flags.is_fullframe_operation = true;
+}
+
 void MixMultiplyOperation::executePixelSampled(float output[4],
                                                float x,
                                                float y,
@@ -641,6 +823,30 @@ void MixMultiplyOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixMultiplyOperation::update_memory_buffer_row(float *out,
+                                                    const float *value,
+                                                    const float *color1,
+                                                    const float *color2,
+                                                    const int width)
+{
+  for (int i = 0; i < width; i++, out += 4, color1 += 4, color2 += 4) {
+    const float fac = get_mix_factor(value[i], color2);
+    const float facm = 1.0f - fac;
+#ifdef BLI_HAVE_SSE2
+    const __m128 c1 = _mm_loadu_ps(color1);
+    const __m128 c2 = _mm_loadu_ps(color2);
+    const __m128 f = _mm_set1_ps(fac);
+    const __m128 fm = _mm_set1_ps(facm);
+    _mm_storeu_ps(out, _mm_mul_ps(c1, _mm_add_ps(fm, _mm_mul_ps(f, c2))));
+#else
+    for (int k = 0; k < 3; k++) {
+      out[k] = color1[k] * (facm + fac * color2[k]);
+    }
+#endif
+    out[3] = color1[3];
+  }
+}
+
 /* ******** Mix Overlay Operation ******** */
 
 void MixOverlayOperation::executePixelSampled(float output[4],
@@ -725,6 +931,11 @@ void MixSaturationOperation::executePixelSampled(float output[4],
 
 /* ******** Mix Screen Operation ******** */
 
+MixScreenOperation::MixScreenOperation()
+{
+  flags.is_fullframe_operation = true;
+}
+
 void MixScreenOperation::executePixelSampled(float output[4],
                                              float x,
                                              float y,
@@ -752,6 +963,34 @@ void MixScreenOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixScreenOperation::update_memory_buffer_row(float *out,
+                                                  const float *value,
+                                                  const float *color1,
+                                                  const float *color2,
+                                                  const int width)
+{
+#ifdef BLI_HAVE_SSE2
+  const __m128 one = _mm_set1_ps(1.0f);
+#endif
+  for (int i = 0; i < width; i++, out += 4, color1 += 4, color2 += 4) {
+    const float fac = get_mix_factor(value[i], color2);
+    const float facm = 1.0f - fac;
+#ifdef BLI_HAVE_SSE2
+    const __m128 c1 = _mm_loadu_ps(color1);
+    const __m128 c2 = _mm_loadu_ps(color2);
+    const __m128 f = _mm_set1_ps(fac);
+    const __m128 fm = _mm_set1_ps(facm);
+    const __m128 inv = _mm_add_ps(fm, _mm_mul_ps(f, _mm_sub_ps(one, c2)));
+    _mm_storeu_ps(out, _mm_sub_ps(one, _mm_mul_ps(inv, _mm_sub_ps(one, c1))));
+#else
+    for (int k = 0; k < 3; k++) {
+      out[k] = 1.0f - (facm + fac * (1.0f - color2[k])) * (1.0f - color1[k]);
+    }
+#endif
+    out[3] = color1[3];
+  }
+}
+
 /* ******** Mix Soft Light Operation ******** */
 
 void MixSoftLightOperation::executePixelSampled(float output[4],
@@ -795,6 +1034,11 @@ void MixSoftLightOperation::executePixelSampled(float output[4],
 
 /* ******** Mix Subtract Operation ******** */
 
+MixSubtractOperation::MixSubtractOperation()
+{
+  flags.is_fullframe_operation = true;
+}
+
 void MixSubtractOperation::executePixelSampled(float output[4],
                                                float x,
                                                float y,
@@ -820,6 +1064,28 @@ void MixSubtractOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixSubtractOperation::update_memory_buffer_row(float *out,
+                                                    const float *value,
+                                                    const float *color1,
+                                                    const float *color2,
+                                                    const int width)
+{
+  for (int i = 0; i < width; i++, out += 4, color1 += 4, color2 += 4) {
+    const float fac = get_mix_factor(value[i], color2);
+#ifdef BLI_HAVE_SSE2
+    const __m128 c1 = _mm_loadu_ps(color1);
+    const __m128 c2 = _mm_loadu_ps(color2);
+    const __m128 f = _mm_set1_ps(fac);
+    _mm_storeu_ps(out, _mm_sub_ps(c1, _mm_mul_ps(f, c2)));
+#else
+    for (int k = 0; k < 3; k++) {
+      out[k] = color1[k] - fac * color2[k];
+    }
+#endif
+    out[3] = color1[3];
+  }
+}
+
 /* ******** Mix Value Operation ******** */
 
 void MixValueOperation::executePixelSampled(float output[4],
@@ -45,6 +45,24 @@ class MixBaseOperation : public NodeOperation {
     }
   }
 
+  inline float get_mix_factor(const float value, const float color2[4]) const
+  {
+    return m_valueAlphaMultiply ? value * color2[3] : value;
+  }
+
+  /**
+   * Mix \a width pixels of the input rows, used by the full frame execution model.
+   * Only called for blend types that set NodeOperationFlags.is_fullframe_operation.
+   * Clamping is done afterwards by #update_memory_buffer.
+   */
+  virtual void update_memory_buffer_row(float * /*out*/,
+                                        const float * /*value*/,
+                                        const float * /*color1*/,
+                                        const float * /*color2*/,
+                                        int /*width*/)
+  {
+  }
+
  public:
   /**
    * Default constructor
@@ -69,6 +87,10 @@ class MixBaseOperation : public NodeOperation {
   void determineResolution(unsigned int resolution[2],
                            unsigned int preferredResolution[2]) override;
 
+  void update_memory_buffer(MemoryBuffer *output,
+                            const rcti &area,
+                            Span<MemoryBuffer *> inputs) final;
+
   void setUseValueAlphaMultiply(const bool value)
   {
     this->m_valueAlphaMultiply = value;
@@ -85,12 +107,30 @@ class MixBaseOperation : public NodeOperation {
 
 class MixAddOperation : public MixBaseOperation {
  public:
+  MixAddOperation();
+
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler) override;
+
+ protected:
+  void update_memory_buffer_row(float *out,
+                                const float *value,
+                                const float *color1,
+                                const float *color2,
+                                int width) override;
 };
 
 class MixBlendOperation : public MixBaseOperation {
  public:
+  MixBlendOperation();
+
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler) override;
+
+ protected:
+  void update_memory_buffer_row(float *out,
+                                const float *value,
+                                const float *color1,
+                                const float *color2,
+                                int width) override;
 };
 
 class MixColorBurnOperation : public MixBaseOperation {
@@ -105,12 +145,30 @@ class MixColorOperation : public MixBaseOperation {
 
 class MixDarkenOperation : public MixBaseOperation {
  public:
+  MixDarkenOperation();
+
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler) override;
+
+ protected:
+  void update_memory_buffer_row(float *out,
+                                const float *value,
+                                const float *color1,
+                                const float *color2,
+                                int width) override;
 };
 
 class MixDifferenceOperation : public MixBaseOperation {
  public:
+  MixDifferenceOperation();
+
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler) override;
+
+ protected:
+  void update_memory_buffer_row(float *out,
+                                const float *value,
+                                const float *color1,
+                                const float *color2,
+                                int width) override;
 };
 
 class MixDivideOperation : public MixBaseOperation {
@@ -135,7 +193,16 @@ class MixHueOperation : public MixBaseOperation {
 
 class MixLightenOperation : public MixBaseOperation {
  public:
+  MixLightenOperation();
+
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler) override;
+
+ protected:
+  void update_memory_buffer_row(float *out,
+                                const float *value,
+                                const float *color1,
+                                const float *color2,
+                                int width) override;
 };
 
 class MixLinearLightOperation : public MixBaseOperation {
@@ -145,7 +212,16 @@ class MixLinearLightOperation : public MixBaseOperation {
 
 class MixMultiplyOperation : public MixBaseOperation {
  public:
+  MixMultiplyOperation();
+
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler) override;
+
+ protected:
+  void update_memory_buffer_row(float *out,
+                                const float *value,
+                                const float *color1,
+                                const float *color2,
+                                int width) override;
 };
 
 class MixOverlayOperation : public MixBaseOperation {
@@ -160,7 +236,16 @@ class MixSaturationOperation : public MixBaseOperation {
 
 class MixScreenOperation : public MixBaseOperation {
  public:
+  MixScreenOperation();
+
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler) override;
+
+ protected:
+  void update_memory_buffer_row(float *out,
+                                const float *value,
+                                const float *color1,
+                                const float *color2,
+                                int width) override;
 };
 
 class MixSoftLightOperation : public MixBaseOperation {
@@ -170,7 +255,16 @@ class MixSoftLightOperation : public MixBaseOperation {
 
 class MixSubtractOperation : public MixBaseOperation {
  public:
+  MixSubtractOperation();
+
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler) override;
+
+ protected:
+  void update_memory_buffer_row(float *out,
+                                const float *value,
+                                const float *color1,
+                                const float *color2,
+                                int width) override;
 };
 
 class MixValueOperation : public MixBaseOperation {
@@ -24,6 +24,7 @@ SetColorOperation::SetColorOperation()
 {
   this->addOutputSocket(DataType::Color);
   flags.is_set_operation = true;
+  flags.is_fullframe_operation = true;
 }
 
 void SetColorOperation::executePixelSampled(float output[4],
@@ -41,4 +42,16 @@ void SetColorOperation::determineResolution(unsigned int resolution[2],
   resolution[1] = preferredResolution[1];
 }
 
+void SetColorOperation::update_memory_buffer(MemoryBuffer *output,
+                                             const rcti &area,
+                                             Span<MemoryBuffer *> /*inputs*/)
+{
+  for (int y = area.ymin; y < area.ymax; y++) {
+    float *elem = output->get_elem(area.xmin, y);
+    for (int x = area.xmin; x < area.xmax; x++, elem += 4) {
+      copy_v4_v4(elem, this->m_color);
+    }
+  }
+}
+
 }  // namespace blender::compositor
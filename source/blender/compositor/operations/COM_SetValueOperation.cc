@@ -24,6 +24,7 @@ SetValueOperation::SetValueOperation()
 {
   this->addOutputSocket(DataType::Value);
   flags.is_set_operation = true;
+  flags.is_fullframe_operation = true;
 }
 
 void SetValueOperation::executePixelSampled(float output[4],
@@ -41,4 +42,13 @@ void SetValueOperation::determineResolution(unsigned int resolution[2],
   resolution[1] = preferredResolution[1];
 }
 
+void SetValueOperation::update_memory_buffer(MemoryBuffer *output,
+                                             const rcti &area,
+                                             Span<MemoryBuffer *> /*inputs*/)
+{
+  for (int y = area.ymin; y < area.ymax; y++) {
+    copy_vn_fl(output->get_elem(area.xmin, y), BLI_rcti_size_x(&area), this->m_value);
+  }
+}
+
 }  // namespace blender::compositor
@@ -25,6 +25,7 @@ SetVectorOperation::SetVectorOperation()
 {
   this->addOutputSocket(DataType::Vector);
   flags.is_set_operation = true;
+  flags.is_fullframe_operation = true;
 }
 
 void SetVectorOperation::executePixelSampled(float output[4],
@@ -44,4 +45,18 @@ void SetVectorOperation::determineResolution(unsigned int resolution[2],
   resolution[1] = preferredResolution[1];
 }
 
+void SetVectorOperation::update_memory_buffer(MemoryBuffer *output,
+                                              const rcti &area,
+                                              Span<MemoryBuffer *> /*inputs*/)
+{
+  for (int y = area.ymin; y < area.ymax; y++) {
+    float *elem = output->get_elem(area.xmin, y);
+    for (int x = area.xmin; x < area.xmax; x++, elem += 3) {
+      elem[0] = this->m_x;
+      elem[1] = this->m_y;
+      elem[2] = this->m_z;
+    }
+  }
+}
+
 }  // namespace blender::compositor
@@ -80,6 +80,10 @@ class SetVectorOperation : public NodeOperation {
   void determineResolution(unsigned int resolution[2],
                            unsigned int preferredResolution[2]) override;
 
+  void update_memory_buffer(MemoryBuffer *output,
+                            const rcti &area,
+                            Span<MemoryBuffer *> inputs) override;
+
   void setVector(const float vector[3])
   {
     setX(vector[0]);
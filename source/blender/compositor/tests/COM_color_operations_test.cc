@@ -0,0 +1,250 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <functional>
+#include <memory>
+
+#include "BLI_rand.hh"
+#include "BLI_timeit.hh"
+#include "BLI_vector.hh"
+
+#include "COM_BufferOperation.h"
+#include "COM_ColorBalanceLGGOperation.h"
+#include "COM_GammaOperation.h"
+#include "COM_MixOperation.h"
+#include "COM_SetColorOperation.h"
+
+namespace blender::compositor::tests {
+
+/**
+ * Feeds all inputs of an operation with buffers of random values, like the full frame execution
+ * model does. The buffers are also linked so that the operation can be read per pixel.
+ */
+class InputBuffers {
+ private:
+  SetColorOperation m_source;
+  Vector<std::unique_ptr<MemoryBuffer>> m_buffers;
+  Vector<std::unique_ptr<BufferOperation>> m_buffer_operations;
+
+ public:
+  rcti area;
+
+  InputBuffers(NodeOperation &operation, const int width, const int height)
+  {
+    unsigned int resolution[2] = {(unsigned int)width, (unsigned int)height};
+    m_source.setResolution(resolution);
+    BLI_rcti_init(&area, 0, width, 0, height);
+
+    RandomNumberGenerator rng(0);
+    for (int i = 0; i < operation.getNumberOfInputSockets(); i++) {
+      const DataType data_type = operation.getInputSocket(i)->getDataType();
+      MemoryBuffer *buffer = new MemoryBuffer(data_type, area);
+      float *values = buffer->getBuffer();
+      const int64_t values_num = (int64_t)width * height * buffer->get_num_channels();
+      for (int64_t j = 0; j < values_num; j++) {
+        /* Include values out of the [0, 1] range to cover clamping. */
+        values[j] = rng.get_float() * 1.2f - 0.1f;
+      }
+      BufferOperation *buffer_operation = new BufferOperation(buffer, &m_source, data_type);
+      operation.getInputSocket(i)->setLink(buffer_operation->getOutputSocket());
+      m_buffers.append(std::unique_ptr<MemoryBuffer>(buffer));
+      m_buffer_operations.append(std::unique_ptr<BufferOperation>(buffer_operation));
+    }
+  }
+
+  Vector<MemoryBuffer *> buffers() const
+  {
+    Vector<MemoryBuffer *> result;
+    for (const std::unique_ptr<MemoryBuffer> &buffer : m_buffers) {
+      result.append(buffer.get());
+    }
+    return result;
+  }
+};
+
+static void render_pixels(NodeOperation &operation, MemoryBuffer &output)
+{
+  const rcti &rect = output.get_rect();
+  for (int y = rect.ymin; y < rect.ymax; y++) {
+    for (int x = rect.xmin; x < rect.xmax; x++) {
+      operation.readSampled(output.get_elem(x, y), x, y, PixelSampler::Nearest);
+    }
+  }
+}
+
+/** Check that rendering whole buffers gives the same result as rendering per pixel. */
+static void test_buffers_match_pixels(NodeOperation &operation, const float tolerance)
+{
+  InputBuffers inputs(operation, 67, 13);
+  MemoryBuffer expected(DataType::Color, inputs.area);
+  MemoryBuffer result(DataType::Color, inputs.area);
+
+  operation.initExecution();
+  render_pixels(operation, expected);
+  operation.update_memory_buffer(&result, inputs.area, inputs.buffers());
+  operation.deinitExecution();
+
+  const float *expected_values = expected.getBuffer();
+  const float *result_values = result.getBuffer();
+  const int values_num = BLI_rcti_size_x(&inputs.area) * BLI_rcti_size_y(&inputs.area) * 4;
+  for (int i = 0; i < values_num; i++) {
+    EXPECT_NEAR(expected_values[i], result_values[i], tolerance);
+  }
+}
+
+static void test_mix_operation(MixBaseOperation &operation)
+{
+  EXPECT_TRUE(operation.get_flags().is_fullframe_operation);
+  for (const bool use_alpha : {false, true}) {
+    for (const bool use_clamp : {false, true}) {
+      operation.setUseValueAlphaMultiply(use_alpha);
+      operation.setUseClamp(use_clamp);
+      test_buffers_match_pixels(operation, 1e-6f);
+    }
+  }
+}
+
+TEST(color_operations, MixBlend)
+{
+  MixBlendOperation operation;
+  test_mix_operation(operation);
+}
+
+TEST(color_operations, MixAdd)
+{
+  MixAddOperation operation;
+  test_mix_operation(operation);
+}
+
+TEST(color_operations, MixSubtract)
+{
+  MixSubtractOperation operation;
+  test_mix_operation(operation);
+}
+
+TEST(color_operations, MixMultiply)
+{
+  MixMultiplyOperation operation;
+  test_mix_operation(operation);
+}
+
+TEST(color_operations, MixScreen)
+{
+  MixScreenOperation operation;
+  test_mix_operation(operation);
+}
+
+TEST(color_operations, MixDarken)
+{
+  MixDarkenOperation operation;
+  test_mix_operation(operation);
+}
+
+TEST(color_operations, MixLighten)
+{
+  MixLightenOperation operation;
+  test_mix_operation(operation);
+}
+
+TEST(color_operations, MixDifference)
+{
+  MixDifferenceOperation operation;
+  test_mix_operation(operation);
+}
+
+static void init_color_balance(ColorBalanceLGGOperation &operation)
+{
+  const float lift[3] = {0.9f, 1.0f, 1.1f};
+  const float gain[3] = {1.2f, 1.0f, 0.8f};
+  const float gamma_inv[3] = {1.0f / 0.8f, 1.0f, 1.0f / 1.3f};
+  operation.setLift(lift);
+  operation.setGain(gain);
+  operation.setGammaInv(gamma_inv);
+}
+
+TEST(color_operations, ColorBalanceLGG)
+{
+  ColorBalanceLGGOperation operation;
+  init_color_balance(operation);
+  EXPECT_TRUE(operation.get_flags().is_fullframe_operation);
+  test_buffers_match_pixels(operation, 1e-6f);
+}
+
+TEST(color_operations, Gamma)
+{
+  GammaOperation operation;
+  EXPECT_TRUE(operation.get_flags().is_fullframe_operation);
+  test_buffers_match_pixels(operation, 1e-6f);
+}
+
+/**
+ * Set this to 1 to activate the benchmark. It is disabled by default, because it renders several
+ * 8K images.
+ */
+#if 0
+static void benchmark_operation(StringRef name, NodeOperation &operation)
+{
+  InputBuffers inputs(operation, 7680, 4320);
+  MemoryBuffer output(DataType::Color, inputs.area);
+
+  operation.initExecution();
+  {
+    SCOPED_TIMER(name + " Pixels");
+    render_pixels(operation, output);
+  }
+  {
+    SCOPED_TIMER(name + " Buffers");
+    operation.update_memory_buffer(&output, inputs.area, inputs.buffers());
+  }
+  operation.deinitExecution();
+}
+
+TEST(color_operations, Benchmark8K)
+{
+  {
+    MixBlendOperation operation;
+    operation.setUseClamp(true);
+    benchmark_operation("Mix Blend       ", operation);
+  }
+  {
+    MixMultiplyOperation operation;
+    benchmark_operation("Mix Multiply    ", operation);
+  }
+  {
+    MixScreenOperation operation;
+    benchmark_operation("Mix Screen      ", operation);
+  }
+  {
+    MixDifferenceOperation operation;
+    benchmark_operation("Mix Difference  ", operation);
+  }
+  {
+    ColorBalanceLGGOperation operation;
+    init_color_balance(operation);
+    benchmark_operation("Color Balance   ", operation);
+  }
+  {
+    GammaOperation operation;
+    benchmark_operation("Gamma           ", operation);
+  }
+}
+
+/**
+ * Timer 'Mix Blend        Pixels' took 2896.57 ms
+ * Timer 'Mix Blend        Buffers' took 198.914 ms
+ * Timer 'Mix Multiply     Pixels' took 1929.59 ms
+ * Timer 'Mix Multiply     Buffers' took 173.365 ms
+ * Timer 'Mix Screen       Pixels' took 2373.68 ms
+ * Timer 'Mix Screen       Buffers' took 172.275 ms
+ * Timer 'Mix Difference   Pixels' took 2144.36 ms
+ * Timer 'Mix Difference   Buffers' took 147.216 ms
+ * Timer 'Color Balance    Pixels' took 6.82336 s
+ * Timer 'Color Balance    Buffers' took 4083.94 ms
+ * Timer 'Gamma            Pixels' took 2386.75 ms
+ * Timer 'Gamma            Buffers' took 1069.25 ms
+ */
+
+#endif /* Benchmark */
+
+}  // namespace blender::compositor::tests
@@ -77,6 +77,11 @@ void DEG_graph_relations_update(struct Depsgraph *graph);
 /* Tag all relations in the database for update.*/
 void DEG_relations_tag_update(struct Main *bmain);
 
+/* Tag relations of the given ID for update. Is cheaper than DEG_relations_tag_update() for
+ * changes which only affect relations of this ID, such as adding or removing a modifier, since
+ * the dependency graph is patched instead of being re-built from scratch when possible. */
+void DEG_id_tag_relations_update(struct Main *bmain, struct ID *id);
+
 /* Add Dependencies  ----------------------------- */
 
 /* Handle for components to define their dependencies from callbacks.
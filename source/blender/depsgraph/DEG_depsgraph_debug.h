@@ -52,6 +52,14 @@ void DEG_stats_simple(const struct Depsgraph *graph,
                       size_t *r_operations,
                       size_t *r_relations);
 
+/* Simulate evaluation of the whole graph on the given number of threads using the recorded timing
+ * of the operations, to compare scheduling operations in the order they become ready with
+ * scheduling them by their critical path. Returns the total times in seconds. */
+void DEG_debug_scheduling_simulate(const struct Depsgraph *graph,
+                                   int threads_num,
+                                   double *r_time_in_order,
+                                   double *r_time_critical_path);
+
 /* ************************************************ */
 /* Diagram-Based Graph Debugging */
 
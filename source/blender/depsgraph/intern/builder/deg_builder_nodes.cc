@@ -382,6 +382,81 @@ void DepsgraphNodeBuilder::end_build()
   }
 }
 
+void DepsgraphNodeBuilder::begin_patch(const Set<IDNode *> &patch_id_nodes)
+{
+  for (IDNode *id_node : graph_->id_nodes) {
+    /* Keep the previous state of all the ID nodes, so that add_id_node() does not reset it when
+     * an existing ID node is referenced by the newly built nodes. Ownership of the copy-on-write
+     * datablocks stays with the ID nodes. */
+    IDInfo *id_info = (IDInfo *)MEM_mallocN(sizeof(IDInfo), "depsgraph id info");
+    id_info->id_cow = nullptr;
+    id_info->previously_visible_components_mask = id_node->visible_components_mask;
+    id_info->previous_eval_flags = id_node->eval_flags;
+    id_info->previous_customdata_masks = id_node->customdata_masks;
+    id_info_hash_.add_new(id_node->id_orig_session_uuid, id_info);
+    id_node->previously_visible_components_mask = id_node->visible_components_mask;
+    id_node->previous_eval_flags = id_node->eval_flags;
+    id_node->previous_customdata_masks = id_node->customdata_masks;
+    if (!patch_id_nodes.contains(id_node)) {
+      built_map_.tagBuild(id_node->id_orig);
+    }
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      comp_node->restore_operations_map();
+    }
+  }
+
+  Vector<OperationNode *> removed_entry_tags;
+  for (OperationNode *op_node : graph_->entry_tags) {
+    ComponentNode *comp_node = op_node->owner;
+    IDNode *id_node = comp_node->owner;
+    if (comp_node->type == NodeType::COPY_ON_WRITE || !patch_id_nodes.contains(id_node)) {
+      continue;
+    }
+    SavedEntryTag entry_tag;
+    entry_tag.id_orig = id_node->id_orig;
+    entry_tag.component_type = comp_node->type;
+    entry_tag.opcode = op_node->opcode;
+    entry_tag.name = op_node->name;
+    entry_tag.name_tag = op_node->name_tag;
+    saved_entry_tags_.append(entry_tag);
+    removed_entry_tags.append(op_node);
+  }
+  for (OperationNode *op_node : removed_entry_tags) {
+    graph_->entry_tags.remove(op_node);
+  }
+
+  /* Remove operations of the patched IDs, keeping the order of all the other ones. */
+  Vector<OperationNode *> operations;
+  operations.reserve(graph_->operations.size());
+  for (OperationNode *op_node : graph_->operations) {
+    ComponentNode *comp_node = op_node->owner;
+    if (comp_node->type == NodeType::COPY_ON_WRITE || !patch_id_nodes.contains(comp_node->owner)) {
+      operations.append(op_node);
+    }
+  }
+  graph_->operations = std::move(operations);
+
+  for (IDNode *id_node : patch_id_nodes) {
+    ComponentNode *comp_cow = id_node->find_component(NodeType::COPY_ON_WRITE);
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      if (comp_node != comp_cow) {
+        BLI_assert(comp_node->inlinks.is_empty() && comp_node->outlinks.is_empty());
+        delete comp_node;
+      }
+    }
+    id_node->components.clear();
+    if (comp_cow != nullptr) {
+      id_node->components.add_new(IDNode::ComponentIDKey(NodeType::COPY_ON_WRITE), comp_cow);
+    }
+    /* Accumulated from scratch by the builders. */
+    id_node->eval_flags = 0;
+    id_node->customdata_masks = DEGCustomDataMeshMasks();
+    id_node->is_directly_visible = false;
+    id_node->linked_state = DEG_ID_LINKED_INDIRECTLY;
+    id_node->has_base = false;
+  }
+}
+
 void DepsgraphNodeBuilder::build_id(ID *id)
 {
   if (id == nullptr) {
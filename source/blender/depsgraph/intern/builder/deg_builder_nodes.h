@@ -101,6 +101,12 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   virtual void begin_build();
   virtual void end_build();
 
+  /* Prepare the builder for re-building nodes of the given IDs in an existing graph, all the
+   * other IDs are considered to be built already. Relations of the given ID nodes are expected to
+   * be removed by the caller. The node builder removes their components, except of the
+   * copy-on-write one, so that the evaluated datablock is kept. */
+  virtual void begin_patch(const Set<IDNode *> &patch_id_nodes);
+
   IDNode *add_id_node(ID *id);
   IDNode *find_id_node(ID *id);
   TimeSourceNode *add_time_source();
@@ -165,6 +171,10 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   virtual void build_view_layer(Scene *scene,
                                 ViewLayer *view_layer,
                                 eDepsNode_LinkedState_Type linked_state);
+  /* Build nodes of the given objects the same way as build_view_layer() would do. */
+  virtual void build_view_layer_objects(Scene *scene,
+                                        ViewLayer *view_layer,
+                                        const Set<Object *> &objects);
   virtual void build_collection(LayerCollection *from_layer_collection, Collection *collection);
   virtual void build_object(int base_index,
                             Object *object,
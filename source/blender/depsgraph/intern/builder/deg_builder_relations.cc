@@ -245,7 +245,10 @@ bool object_have_geometry_component(const Object *object)
 DepsgraphRelationBuilder::DepsgraphRelationBuilder(Main *bmain,
                                                    Depsgraph *graph,
                                                    DepsgraphBuilderCache *cache)
-    : DepsgraphBuilder(bmain, graph, cache), scene_(nullptr), rna_node_query_(graph, this)
+    : DepsgraphBuilder(bmain, graph, cache),
+      scene_(nullptr),
+      check_relations_before_add_(false),
+      rna_node_query_(graph, this)
 {
 }
 
@@ -350,6 +353,9 @@ Relation *DepsgraphRelationBuilder::add_time_relation(TimeSourceNode *timesrc,
                                                       const char *description,
                                                       int flags)
 {
+  if (check_relations_before_add_) {
+    flags |= RELATION_CHECK_BEFORE_ADD;
+  }
   if (timesrc && node_to) {
     return graph_->add_new_relation(timesrc, node_to, description, flags);
   }
@@ -371,6 +377,9 @@ Relation *DepsgraphRelationBuilder::add_operation_relation(OperationNode *node_f
                                                            const char *description,
                                                            int flags)
 {
+  if (check_relations_before_add_) {
+    flags |= RELATION_CHECK_BEFORE_ADD;
+  }
   if (node_from && node_to) {
     return graph_->add_new_relation(node_from, node_to, description, flags);
   }
@@ -486,6 +495,16 @@ void DepsgraphRelationBuilder::begin_build()
 {
 }
 
+void DepsgraphRelationBuilder::begin_patch(const Set<IDNode *> &patch_id_nodes)
+{
+  for (IDNode *id_node : graph_->id_nodes) {
+    if (!patch_id_nodes.contains(id_node)) {
+      built_map_.tagBuild(id_node->id_orig);
+    }
+  }
+  check_relations_before_add_ = true;
+}
+
 void DepsgraphRelationBuilder::build_id(ID *id)
 {
   if (id == nullptr) {
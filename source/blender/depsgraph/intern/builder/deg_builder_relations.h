@@ -164,6 +164,11 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
 
   void begin_build();
 
+  /* Prepare the builder for re-building relations of the given IDs in an existing graph, all the
+   * other IDs are considered to have their relations built already. Relations which already
+   * exist in the graph are not added again. */
+  void begin_patch(const Set<IDNode *> &patch_id_nodes);
+
   template<typename KeyFrom, typename KeyTo>
   Relation *add_relation(const KeyFrom &key_from,
                          const KeyTo &key_to,
@@ -211,6 +216,8 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
   virtual void build_view_layer(Scene *scene,
                                 ViewLayer *view_layer,
                                 eDepsNode_LinkedState_Type linked_state);
+  /* Build relations of the given IDs, in the context of the view layer of the given scene. */
+  virtual void build_view_layer_ids(Scene *scene, Span<ID *> ids);
   virtual void build_collection(LayerCollection *from_layer_collection,
                                 Object *object,
                                 Collection *collection);
@@ -373,6 +380,9 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
   /* State which demotes currently built entities. */
   Scene *scene_;
 
+  /* Relations are added to a graph which already has some of them, see begin_patch(). */
+  bool check_relations_before_add_;
+
   BuilderMap built_map_;
   RNANodeQuery rna_node_query_;
 };
@@ -154,4 +154,13 @@ void DepsgraphRelationBuilder::build_view_layer(Scene *scene,
   }
 }
 
+void DepsgraphRelationBuilder::build_view_layer_ids(Scene *scene, Span<ID *> ids)
+{
+  /* Setup currently building context. */
+  scene_ = scene;
+  for (ID *id : ids) {
+    build_id(id);
+  }
+}
+
 }  // namespace blender::deg
@@ -60,6 +60,8 @@ class AllObjectsRelationBuilder : public DepsgraphRelationBuilder {
 AllObjectsBuilderPipeline::AllObjectsBuilderPipeline(::Depsgraph *graph)
     : ViewLayerBuilderPipeline(graph)
 {
+  /* Objects which are not in the view layer are pulled in, which the patch builder can't do. */
+  deg_graph_->is_view_layer_depsgraph = false;
 }
 
 unique_ptr<DepsgraphNodeBuilder> AllObjectsBuilderPipeline::construct_node_builder()
@@ -29,6 +29,7 @@ CompositorBuilderPipeline::CompositorBuilderPipeline(::Depsgraph *graph, bNodeTr
     : AbstractBuilderPipeline(graph), nodetree_(nodetree)
 {
   deg_graph_->is_render_pipeline_depsgraph = true;
+  deg_graph_->is_view_layer_depsgraph = false;
 }
 
 void CompositorBuilderPipeline::build_nodes(DepsgraphNodeBuilder &node_builder)
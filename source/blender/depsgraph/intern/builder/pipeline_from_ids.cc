@@ -116,6 +116,7 @@ class DepsgraphFromIDsRelationBuilder : public DepsgraphRelationBuilder {
 FromIDsBuilderPipeline::FromIDsBuilderPipeline(::Depsgraph *graph, Span<ID *> ids)
     : AbstractBuilderPipeline(graph), ids_(ids)
 {
+  deg_graph_->is_view_layer_depsgraph = false;
 }
 
 unique_ptr<DepsgraphNodeBuilder> FromIDsBuilderPipeline::construct_node_builder()
@@ -0,0 +1,366 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+#include "pipeline_patch.h"
+
+#include "PIL_time.h"
+
+#include "BKE_global.h"
+
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+#include "intern/builder/deg_builder_nodes.h"
+#include "intern/builder/deg_builder_relations.h"
+#include "intern/depsgraph.h"
+#include "intern/depsgraph_physics.h"
+#include "intern/depsgraph_relation.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
+
+namespace blender::deg {
+
+namespace {
+
+IDNode *get_relation_id_node(const Node *node)
+{
+  if (node->type == NodeType::OPERATION) {
+    return static_cast<const OperationNode *>(node)->owner->owner;
+  }
+  if (node->type >= NodeType::PARAMETERS) {
+    return static_cast<const ComponentNode *>(node)->owner;
+  }
+  return nullptr;
+}
+
+/* Check whether any other ID depends on the given one. Relations go from the used ID to its
+ * users, so an ID which is only used by the objects whose relations were removed by the patch
+ * has no outgoing relations to other IDs. */
+bool id_node_has_users(const IDNode *id_node)
+{
+  auto is_user_relation = [id_node](const Relation *rel) {
+    const IDNode *id_node_to = get_relation_id_node(rel->to);
+    return id_node_to != nullptr && id_node_to != id_node;
+  };
+  for (const ComponentNode *comp_node : id_node->components.values()) {
+    for (const Relation *rel : comp_node->outlinks) {
+      if (is_user_relation(rel)) {
+        return true;
+      }
+    }
+    for (const OperationNode *op_node : comp_node->operations) {
+      for (const Relation *rel : op_node->outlinks) {
+        if (is_user_relation(rel)) {
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+bool is_copy_on_write_operation(const Node *node)
+{
+  return node->type == NodeType::OPERATION &&
+         static_cast<const OperationNode *>(node)->owner->type == NodeType::COPY_ON_WRITE;
+}
+
+string relation_identifier(const Relation *rel)
+{
+  const string from = (rel->from->type == NodeType::OPERATION) ?
+                          static_cast<const OperationNode *>(rel->from)->full_identifier() :
+                          rel->from->identifier();
+  const string to = (rel->to->type == NodeType::OPERATION) ?
+                        static_cast<const OperationNode *>(rel->to)->full_identifier() :
+                        rel->to->identifier();
+  return from + " -> " + to + " (" + rel->name + ")";
+}
+
+Set<string> graph_relation_identifiers(const Depsgraph *graph)
+{
+  Set<string> identifiers;
+  for (const OperationNode *op_node : graph->operations) {
+    for (const Relation *rel : op_node->inlinks) {
+      identifiers.add(relation_identifier(rel));
+    }
+  }
+  return identifiers;
+}
+
+/* Compare relations of the patched graph against the graph which is fully built from scratch,
+ * and report all the differences. */
+bool patch_validate(Main *bmain, Depsgraph *graph)
+{
+  ::Depsgraph *full_graph = DEG_graph_new(bmain, graph->scene, graph->view_layer, graph->mode);
+  DEG_graph_build_from_view_layer(full_graph);
+
+  const Set<string> patched_relations = graph_relation_identifiers(graph);
+  const Set<string> full_relations = graph_relation_identifiers(
+      reinterpret_cast<Depsgraph *>(full_graph));
+  bool valid = true;
+  for (const string &identifier : full_relations) {
+    if (!patched_relations.contains(identifier)) {
+      fprintf(stderr, "Depsgraph patch is missing relation %s\n", identifier.c_str());
+      valid = false;
+    }
+  }
+  for (const string &identifier : patched_relations) {
+    if (!full_relations.contains(identifier)) {
+      fprintf(stderr, "Depsgraph patch has extra relation %s\n", identifier.c_str());
+      valid = false;
+    }
+  }
+  const int64_t full_operations_num = reinterpret_cast<Depsgraph *>(full_graph)->operations.size();
+  if (graph->operations.size() != full_operations_num) {
+    fprintf(stderr,
+            "Depsgraph patch has %d operations, full build has %d\n",
+            int(graph->operations.size()),
+            int(full_operations_num));
+    valid = false;
+  }
+
+  DEG_graph_free(full_graph);
+  return valid;
+}
+
+}  // namespace
+
+PatchBuilderPipeline::PatchBuilderPipeline(::Depsgraph *graph, Span<ID *> ids)
+    : AbstractBuilderPipeline(graph), ids_(ids), id_nodes_num_(0)
+{
+}
+
+bool PatchBuilderPipeline::patch()
+{
+  double start_time = 0.0;
+  if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
+    start_time = PIL_check_seconds_timer();
+  }
+
+  build_step_sanity_check();
+  if (!collect_patch_id_nodes()) {
+    if (G.debug & G_DEBUG_DEPSGRAPH_BUILD) {
+      printf("Depsgraph can not be patched, doing full rebuild.\n");
+    }
+    return false;
+  }
+  remove_patch_relations();
+  patch_step_nodes();
+  patch_step_relations();
+  if (has_orphaned_id_nodes()) {
+    if (G.debug & G_DEBUG_DEPSGRAPH_BUILD) {
+      printf("Depsgraph patch leaves unused IDs behind, doing full rebuild.\n");
+    }
+    return false;
+  }
+  /* Cycles are detected from scratch, same as for the full build. */
+  for (OperationNode *op_node : deg_graph_->operations) {
+    for (Relation *rel : op_node->inlinks) {
+      rel->flag &= ~RELATION_FLAG_CYCLIC;
+    }
+  }
+  build_step_finalize();
+
+  if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
+    printf("Depsgraph patched in %f seconds (%d of %d IDs).\n",
+           PIL_check_seconds_timer() - start_time,
+           int(relations_id_nodes_.size()),
+           int(deg_graph_->id_nodes.size()));
+  }
+
+  /* Validation mode: compare against the full build. */
+  if (G.debug_value == 798) {
+    if (!patch_validate(bmain_, deg_graph_)) {
+      BLI_assert(!"Patched depsgraph does not match the full build");
+    }
+  }
+
+  return true;
+}
+
+bool PatchBuilderPipeline::collect_patch_id_nodes()
+{
+  if (!deg_graph_->is_view_layer_depsgraph) {
+    return false;
+  }
+  /* Physics relations are built from the whole scene, so adding or removing a collision or
+   * effector to an object affects relations of objects which are not connected to it yet. */
+  for (int i = 0; i < DEG_PHYSICS_RELATIONS_NUM; i++) {
+    if (deg_graph_->physics_relations[i] != nullptr &&
+        !deg_graph_->physics_relations[i]->is_empty()) {
+      return false;
+    }
+  }
+  for (ID *id : ids_) {
+    if (GS(id->name) != ID_OB) {
+      return false;
+    }
+    IDNode *id_node = deg_graph_->find_id_node(id);
+    if (id_node == nullptr || !id_node->has_base ||
+        id_node->linked_state != DEG_ID_LINKED_DIRECTLY) {
+      return false;
+    }
+    /* Proxies and rigid bodies have relations which are built from other objects and from the
+     * scene. */
+    Object *object = (Object *)id;
+    if (object->proxy != nullptr || object->proxy_from != nullptr ||
+        object->rigidbody_object != nullptr || object->rigidbody_constraint != nullptr) {
+      return false;
+    }
+    objects_.add(object);
+    patch_id_nodes_.add(id_node);
+  }
+
+  /* Relations of the patched objects might have been added when building any of the IDs which
+   * they are connected to, so re-build relations of those IDs as well. */
+  for (IDNode *id_node : patch_id_nodes_) {
+    relations_id_nodes_.add(id_node);
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      for (OperationNode *op_node : comp_node->operations) {
+        /* ID properties nodes are created by builders of the drivers which read them, those
+         * nodes would not be re-created. */
+        if (op_node->opcode == OperationCode::ID_PROPERTY) {
+          return false;
+        }
+        for (Relation *rel : op_node->inlinks) {
+          /* Relations from the scene are coming from the object's own builder. */
+          IDNode *id_node_from = get_relation_id_node(rel->from);
+          if (id_node_from != nullptr && id_node_from->id_type != ID_SCE) {
+            relations_id_nodes_.add(id_node_from);
+          }
+        }
+        for (Relation *rel : op_node->outlinks) {
+          IDNode *id_node_to = get_relation_id_node(rel->to);
+          if (id_node_to == nullptr) {
+            continue;
+          }
+          /* Scene depends on the object: relation is coming from the scene builder, which is not
+           * re-built partially. */
+          if (id_node_to->id_type == ID_SCE) {
+            return false;
+          }
+          relations_id_nodes_.add(id_node_to);
+        }
+      }
+    }
+  }
+
+  /* Patching does not give any benefit when a big part of the graph is to be re-built. */
+  if (relations_id_nodes_.size() > deg_graph_->id_nodes.size() / 2) {
+    return false;
+  }
+  return true;
+}
+
+void PatchBuilderPipeline::remove_patch_relations()
+{
+  Set<Relation *> relations;
+  for (IDNode *id_node : patch_id_nodes_) {
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      relations.add_multiple(comp_node->inlinks);
+      relations.add_multiple(comp_node->outlinks);
+      for (OperationNode *op_node : comp_node->operations) {
+        relations.add_multiple(op_node->inlinks);
+        relations.add_multiple(op_node->outlinks);
+      }
+    }
+  }
+  /* Copy-on-write relations are re-built for all IDs which relations are re-built. */
+  for (IDNode *id_node : relations_id_nodes_) {
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      for (OperationNode *op_node : comp_node->operations) {
+        for (Relation *rel : op_node->inlinks) {
+          if (is_copy_on_write_operation(rel->from)) {
+            relations.add(rel);
+          }
+        }
+      }
+    }
+  }
+  for (Relation *rel : relations) {
+    rel->unlink();
+    delete rel;
+  }
+  clear_physics_relations(deg_graph_);
+}
+
+void PatchBuilderPipeline::patch_step_nodes()
+{
+  id_nodes_num_ = deg_graph_->id_nodes.size();
+  unique_ptr<DepsgraphNodeBuilder> node_builder = construct_node_builder();
+  node_builder->begin_patch(patch_id_nodes_);
+  build_nodes(*node_builder);
+  node_builder->end_build();
+}
+
+void PatchBuilderPipeline::patch_step_relations()
+{
+  for (const int64_t i : IndexRange(id_nodes_num_, deg_graph_->id_nodes.size() - id_nodes_num_)) {
+    relations_id_nodes_.add(deg_graph_->id_nodes[i]);
+  }
+  unique_ptr<DepsgraphRelationBuilder> relation_builder = construct_relation_builder();
+  relation_builder->begin_patch(relations_id_nodes_);
+  build_relations(*relation_builder);
+  for (IDNode *id_node : relations_id_nodes_) {
+    relation_builder->build_copy_on_write_relations(id_node);
+  }
+  for (IDNode *id_node : relations_id_nodes_) {
+    relation_builder->build_driver_relations(id_node);
+  }
+}
+
+/* IDs which are pulled into the graph by the patched objects only are removed from the fully
+ * built graph once the objects stop using them. Objects of the view layer are kept, since they
+ * are pulled in by their bases. */
+bool PatchBuilderPipeline::has_orphaned_id_nodes() const
+{
+  for (const int64_t i : IndexRange(id_nodes_num_)) {
+    IDNode *id_node = deg_graph_->id_nodes[i];
+    if (!relations_id_nodes_.contains(id_node) || patch_id_nodes_.contains(id_node)) {
+      continue;
+    }
+    if (id_node->has_base || id_node->id_type == ID_SCE) {
+      continue;
+    }
+    if (!id_node_has_users(id_node)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void PatchBuilderPipeline::build_nodes(DepsgraphNodeBuilder &node_builder)
+{
+  node_builder.build_view_layer_objects(scene_, view_layer_, objects_);
+}
+
+void PatchBuilderPipeline::build_relations(DepsgraphRelationBuilder &relation_builder)
+{
+  Vector<ID *> ids;
+  for (IDNode *id_node : relations_id_nodes_) {
+    ids.append(id_node->id_orig);
+  }
+  relation_builder.build_view_layer_ids(scene_, ids);
+}
+
+}  // namespace blender::deg
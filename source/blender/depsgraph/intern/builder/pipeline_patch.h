@@ -0,0 +1,77 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2021 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#pragma once
+
+#include "pipeline.h"
+
+struct ID;
+struct Object;
+
+namespace blender {
+namespace deg {
+
+struct IDNode;
+
+/* Builder which patches relations of an already built view layer dependency graph.
+ *
+ * Nodes of the tagged objects are re-created, and relations are re-built for those objects and
+ * for all the IDs which are directly connected to them. All the other IDs keep their nodes and
+ * relations. ID nodes are never removed by the patch: when an ID which is not in the view layer
+ * is no longer used after the patch, the graph is to be fully rebuilt.
+ *
+ * Patching is only supported for objects which are pulled into the graph via a base of the view
+ * layer. Changes which affect scene-level relations, or which touch too big part of the graph,
+ * are refused, and the caller is expected to do a full rebuild in that case. */
+
+class PatchBuilderPipeline : public AbstractBuilderPipeline {
+ public:
+  PatchBuilderPipeline(::Depsgraph *graph, Span<ID *> ids);
+
+  /* Returns false if the graph can not be patched, the caller is to do a full rebuild then. */
+  bool patch();
+
+ protected:
+  virtual void build_nodes(DepsgraphNodeBuilder &node_builder) override;
+  virtual void build_relations(DepsgraphRelationBuilder &relation_builder) override;
+
+ private:
+  bool collect_patch_id_nodes();
+  void remove_patch_relations();
+  void patch_step_nodes();
+  void patch_step_relations();
+  bool has_orphaned_id_nodes() const;
+
+  Span<ID *> ids_;
+  /* Number of ID nodes in the graph before patching, ID nodes which are added after that are
+   * created by the patch. */
+  int64_t id_nodes_num_;
+  /* Objects which nodes are re-created. */
+  Set<Object *> objects_;
+  Set<IDNode *> patch_id_nodes_;
+  /* ID nodes which relations are re-built, includes the patched ID nodes. */
+  Set<IDNode *> relations_id_nodes_;
+};
+
+}  // namespace deg
+}  // namespace blender
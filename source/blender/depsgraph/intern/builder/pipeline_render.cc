@@ -28,6 +28,7 @@ namespace blender::deg {
 RenderBuilderPipeline::RenderBuilderPipeline(::Depsgraph *graph) : AbstractBuilderPipeline(graph)
 {
   deg_graph_->is_render_pipeline_depsgraph = true;
+  deg_graph_->is_view_layer_depsgraph = false;
 }
 
 void RenderBuilderPipeline::build_nodes(DepsgraphNodeBuilder &node_builder)
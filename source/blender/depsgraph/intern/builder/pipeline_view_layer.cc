@@ -28,6 +28,7 @@ namespace blender::deg {
 ViewLayerBuilderPipeline::ViewLayerBuilderPipeline(::Depsgraph *graph)
     : AbstractBuilderPipeline(graph)
 {
+  deg_graph_->is_view_layer_depsgraph = true;
 }
 
 void ViewLayerBuilderPipeline::build_nodes(DepsgraphNodeBuilder &node_builder)
@@ -71,6 +71,7 @@ Depsgraph::Depsgraph(Main *bmain, Scene *scene, ViewLayer *view_layer, eEvaluati
       is_active(false),
       is_evaluating(false),
       is_render_pipeline_depsgraph(false),
+      is_view_layer_depsgraph(false),
       use_editors_update(false)
 {
   BLI_spin_init(&lock);
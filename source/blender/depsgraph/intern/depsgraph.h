@@ -108,6 +108,10 @@ struct Depsgraph {
   /* Indicates whether relations needs to be updated. */
   bool need_update;
 
+  /* IDs which relations are to be updated. Allows to patch the graph instead of re-building it
+   * from scratch. Not used when need_update is set. */
+  Set<ID *> relations_update_ids;
+
   /* Indicates which ID types were updated. */
   char id_type_updated[INDEX_ID_MAX];
 
@@ -161,6 +165,11 @@ struct Depsgraph {
    * does not need any bases. */
   bool is_render_pipeline_depsgraph;
 
+  /* Is set to truth for dependency graph which is built from the bases of its view layer. Only
+   * such dependency graph can be patched when relations of individual IDs are tagged for update,
+   * see #PatchBuilderPipeline. */
+  bool is_view_layer_depsgraph;
+
   /* Notify editors about changes to IDs in this depsgraph. */
   bool use_editors_update;
 
@@ -48,6 +48,7 @@
 #include "builder/pipeline_all_objects.h"
 #include "builder/pipeline_compositor.h"
 #include "builder/pipeline_from_ids.h"
+#include "builder/pipeline_patch.h"
 #include "builder/pipeline_render.h"
 #include "builder/pipeline_view_layer.h"
 
@@ -275,8 +276,19 @@ void DEG_graph_relations_update(Depsgraph *graph)
 {
   deg::Depsgraph *deg_graph = (deg::Depsgraph *)graph;
   if (!deg_graph->need_update) {
-    /* Graph is up to date, nothing to do. */
-    return;
+    if (deg_graph->relations_update_ids.is_empty()) {
+      /* Graph is up to date, nothing to do. */
+      return;
+    }
+    /* Only relations of some IDs are to be updated, try to patch the graph. */
+    blender::Vector<ID *> ids;
+    for (ID *id : deg_graph->relations_update_ids) {
+      ids.append(id);
+    }
+    deg::PatchBuilderPipeline builder(graph, ids);
+    if (builder.patch()) {
+      return;
+    }
   }
   DEG_graph_build_from_view_layer(graph);
 }
@@ -289,3 +301,17 @@ void DEG_relations_tag_update(Main *bmain)
     DEG_graph_tag_relations_update(reinterpret_cast<Depsgraph *>(depsgraph));
   }
 }
+
+void DEG_id_tag_relations_update(Main *bmain, ID *id)
+{
+  DEG_GLOBAL_DEBUG_PRINTF(TAG, "%s: Tagging relations of %s for update.\n", __func__, id->name);
+  for (deg::Depsgraph *depsgraph : deg::get_all_registered_graphs(bmain)) {
+    if (depsgraph->is_view_layer_depsgraph) {
+      depsgraph->relations_update_ids.add(id);
+    }
+    else {
+      /* Only graphs which are built from a view layer can be patched. */
+      DEG_graph_tag_relations_update(reinterpret_cast<Depsgraph *>(depsgraph));
+    }
+  }
+}
@@ -38,6 +38,7 @@
 #include "intern/depsgraph.h"
 #include "intern/depsgraph_relation.h"
 #include "intern/depsgraph_type.h"
+#include "intern/eval/deg_eval_stats.h"
 #include "intern/node/deg_node_component.h"
 #include "intern/node/deg_node_id.h"
 #include "intern/node/deg_node_time.h"
@@ -245,6 +246,16 @@ void DEG_stats_simple(const Depsgraph *graph,
   }
 }
 
+void DEG_debug_scheduling_simulate(const Depsgraph *graph,
+                                   const int threads_num,
+                                   double *r_time_in_order,
+                                   double *r_time_critical_path)
+{
+  const deg::Depsgraph *deg_graph = reinterpret_cast<const deg::Depsgraph *>(graph);
+  *r_time_in_order = deg::deg_eval_stats_simulate_schedule(deg_graph, threads_num, false);
+  *r_time_critical_path = deg::deg_eval_stats_simulate_schedule(deg_graph, threads_num, true);
+}
+
 static deg::string depsgraph_name_for_logging(struct Depsgraph *depsgraph)
 {
   const char *name = DEG_debug_name_get(depsgraph);
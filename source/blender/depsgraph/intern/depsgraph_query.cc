@@ -319,7 +319,7 @@ bool DEG_is_fully_evaluated(const struct Depsgraph *depsgraph)
 {
   const deg::Depsgraph *deg_graph = (const deg::Depsgraph *)depsgraph;
   /* Check whether relations are up to date. */
-  if (deg_graph->need_update) {
+  if (deg_graph->need_update || !deg_graph->relations_update_ids.is_empty()) {
     return false;
   }
   /* Check whether IDs are up to date. */
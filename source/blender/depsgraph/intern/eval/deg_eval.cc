@@ -25,12 +25,16 @@
 
 #include "intern/eval/deg_eval.h"
 
+#include <algorithm>
+#include <mutex>
+
 #include "PIL_time.h"
 
 #include "BLI_compiler_attrs.h"
 #include "BLI_gsqueue.h"
 #include "BLI_task.h"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BKE_global.h"
 
@@ -68,11 +72,6 @@ void schedule_children(DepsgraphEvalState *state,
                        ScheduleFunction *schedule_function,
                        ScheduleFunctionArgs... schedule_function_args);
 
-void schedule_node_to_pool(OperationNode *node, const int UNUSED(thread_id), TaskPool *pool)
-{
-  BLI_task_pool_push(pool, deg_task_run_func, node, false, nullptr);
-}
-
 /* Denotes which part of dependency graph is being evaluated. */
 enum class EvaluationStage {
   /* Stage 1: Only  Copy-on-Write operations are to be evaluated, prior to anything else.
@@ -95,32 +94,60 @@ struct DepsgraphEvalState {
   bool do_stats;
   EvaluationStage stage;
   bool need_single_thread_pass;
+
+  /* Operations which are ready to be evaluated, as a heap ordered by their critical path time.
+   * Every task in the pool evaluates the operation at the top of the heap at the time it starts,
+   * rather than the operation it was created for, so that long chains of dependent operations
+   * (e.g. heavy modifier stacks of a few objects) are not started last. */
+  std::mutex ready_mutex;
+  Vector<OperationNode *> ready_heap;
 };
 
+bool operation_critical_path_less(const OperationNode *a, const OperationNode *b)
+{
+  return a->critical_path_time < b->critical_path_time;
+}
+
+void schedule_node_to_pool(OperationNode *node, const int UNUSED(thread_id), TaskPool *pool)
+{
+  DepsgraphEvalState *state = (DepsgraphEvalState *)BLI_task_pool_user_data(pool);
+  {
+    std::lock_guard lock{state->ready_mutex};
+    state->ready_heap.append(node);
+    std::push_heap(
+        state->ready_heap.begin(), state->ready_heap.end(), operation_critical_path_less);
+  }
+  BLI_task_pool_push(pool, deg_task_run_func, nullptr, false, nullptr);
+}
+
+OperationNode *pop_ready_node(DepsgraphEvalState *state)
+{
+  std::lock_guard lock{state->ready_mutex};
+  /* There is one task for every node which has been added to the heap. */
+  BLI_assert(!state->ready_heap.is_empty());
+  std::pop_heap(state->ready_heap.begin(), state->ready_heap.end(), operation_critical_path_less);
+  return state->ready_heap.pop_last();
+}
+
 void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_node)
 {
   ::Depsgraph *depsgraph = reinterpret_cast<::Depsgraph *>(state->graph);
 
   /* Sanity checks. */
   BLI_assert(!operation_node->is_noop() && "NOOP nodes should not actually be scheduled");
-  /* Perform operation. */
-  if (state->do_stats) {
-    const double start_time = PIL_check_seconds_timer();
-    operation_node->evaluate(depsgraph);
-    operation_node->stats.current_time += PIL_check_seconds_timer() - start_time;
-  }
-  else {
-    operation_node->evaluate(depsgraph);
-  }
+  /* Perform operation. The time is always measured, since it is used for scheduling. */
+  const double start_time = PIL_check_seconds_timer();
+  operation_node->evaluate(depsgraph);
+  operation_node->stats.current_time += PIL_check_seconds_timer() - start_time;
 }
 
-void deg_task_run_func(TaskPool *pool, void *taskdata)
+void deg_task_run_func(TaskPool *pool, void *UNUSED(taskdata))
 {
   void *userdata_v = BLI_task_pool_user_data(pool);
   DepsgraphEvalState *state = (DepsgraphEvalState *)userdata_v;
 
   /* Evaluate node. */
-  OperationNode *operation_node = reinterpret_cast<OperationNode *>(taskdata);
+  OperationNode *operation_node = pop_ready_node(state);
   evaluate_node(state, operation_node);
 
   /* Schedule children. */
@@ -177,16 +204,72 @@ void calculate_pending_parents(Depsgraph *graph)
   }
 }
 
-void initialize_execution(DepsgraphEvalState *state, Depsgraph *graph)
+bool operation_needs_evaluation(OperationNode *node)
+{
+  return (node->flag & DEPSOP_FLAG_NEEDS_UPDATE) && check_operation_node_visible(node);
+}
+
+/* Critical path time of operations which are not yet calculated or currently being calculated. */
+static constexpr double CRITICAL_PATH_UNKNOWN = -1.0;
+static constexpr double CRITICAL_PATH_IN_PROGRESS = -2.0;
+
+/* Calculate #OperationNode.critical_path_time for all operations which are to be evaluated, from
+ * the average evaluation times of previous evaluations. */
+void calculate_critical_path_times(Depsgraph *graph)
+{
+  for (OperationNode *node : graph->operations) {
+    node->critical_path_time = operation_needs_evaluation(node) ? CRITICAL_PATH_UNKNOWN : 0.0;
+  }
+
+  /* Depth first traversal, the time of an operation is known once all its children are done. */
+  struct StackEntry {
+    OperationNode *node;
+    int64_t next_relation;
+    double children_time;
+  };
+  Vector<StackEntry, 64> stack;
+  for (OperationNode *root : graph->operations) {
+    if (root->critical_path_time != CRITICAL_PATH_UNKNOWN) {
+      continue;
+    }
+    root->critical_path_time = CRITICAL_PATH_IN_PROGRESS;
+    stack.append({root, 0, 0.0});
+    while (!stack.is_empty()) {
+      StackEntry &entry = stack.last();
+      if (entry.next_relation < entry.node->outlinks.size()) {
+        const Relation *rel = entry.node->outlinks[entry.next_relation++];
+        if (rel->flag & RELATION_FLAG_CYCLIC) {
+          continue;
+        }
+        OperationNode *child = (OperationNode *)rel->to;
+        if (child->critical_path_time == CRITICAL_PATH_UNKNOWN) {
+          child->critical_path_time = CRITICAL_PATH_IN_PROGRESS;
+          stack.append({child, 0, 0.0});
+        }
+        else if (child->critical_path_time != CRITICAL_PATH_IN_PROGRESS) {
+          entry.children_time = std::max(entry.children_time, child->critical_path_time);
+        }
+        continue;
+      }
+      OperationNode *node = entry.node;
+      node->critical_path_time = entry.children_time + node->stats.average_time;
+      stack.remove_last();
+      if (!stack.is_empty()) {
+        stack.last().children_time = std::max(stack.last().children_time,
+                                              node->critical_path_time);
+      }
+    }
+  }
+}
+
+void initialize_execution(DepsgraphEvalState *UNUSED(state), Depsgraph *graph)
 {
-  const bool do_stats = state->do_stats;
   calculate_pending_parents(graph);
   /* Clear tags and other things which needs to be clear. */
   for (OperationNode *node : graph->operations) {
-    if (do_stats) {
-      node->stats.reset_current();
-    }
+    node->stats.reset_current();
   }
+  calculate_critical_path_times(graph);
 }
 
 bool is_metaball_object_operation(const OperationNode *operation_node)
@@ -329,6 +412,103 @@ void evaluate_graph_single_threaded(DepsgraphEvalState *state)
   BLI_gsqueue_free(evaluation_queue);
 }
 
+/* Depth of a copy-on-write operation in the relations between copy-on-write operations (nested IDs
+ * and object data are expanded before their owner). Returns -1 when the operation waits for an
+ * operation of another kind, it is then left for the threaded evaluation. */
+int copy_on_write_pass_level(DepsgraphEvalState *state,
+                             OperationNode *node,
+                             Map<OperationNode *, int> &levels)
+{
+  if (const int *level = levels.lookup_ptr(node)) {
+    return *level;
+  }
+  int level = 0;
+  for (Relation *rel : node->inlinks) {
+    if (rel->from->type != NodeType::OPERATION || (rel->flag & RELATION_FLAG_CYCLIC)) {
+      continue;
+    }
+    OperationNode *from = (OperationNode *)rel->from;
+    if (!operation_needs_evaluation(from)) {
+      continue;
+    }
+    if (!need_evaluate_operation_at_stage(state, from)) {
+      level = -1;
+      break;
+    }
+    const int from_level = copy_on_write_pass_level(state, from, levels);
+    if (from_level == -1) {
+      level = -1;
+      break;
+    }
+    level = std::max(level, from_level + 1);
+  }
+  levels.add_new(node, level);
+  return level;
+}
+
+struct CopyOnWritePassData {
+  DepsgraphEvalState *state;
+  Span<OperationNode *> nodes;
+};
+
+void copy_on_write_pass_func(void *__restrict data_v,
+                             const int i,
+                             const TaskParallelTLS *__restrict /*tls*/)
+{
+  CopyOnWritePassData *data = (CopyOnWritePassData *)data_v;
+  OperationNode *operation_node = data->nodes[i];
+  evaluate_node(data->state, operation_node);
+
+  /* Children are scheduled by the threaded evaluation, only account for this parent. Children
+   * which are part of the pass are marked as scheduled already. */
+  for (Relation *rel : operation_node->outlinks) {
+    OperationNode *child = (OperationNode *)rel->to;
+    if (child->scheduled || (rel->flag & RELATION_FLAG_CYCLIC)) {
+      continue;
+    }
+    if (!operation_needs_evaluation(child)) {
+      continue;
+    }
+    BLI_assert(child->num_links_pending > 0);
+    atomic_sub_and_fetch_uint32(&child->num_links_pending, 1);
+  }
+}
+
+/* Expand copy-on-write datablocks as a pre-pass of the evaluation. Instead of scheduling every
+ * operation through the task pool, which makes the copying of many small IDs bound by the
+ * scheduling overhead, operations are grouped by their depth in the copy-on-write relations and
+ * every group is expanded in parallel. The remapping of ID pointers only does lookups in the ID
+ * map of the graph, so it is safe to do from multiple threads. */
+void evaluate_copy_on_write_pass(DepsgraphEvalState *state)
+{
+  BLI_assert(state->stage == EvaluationStage::COPY_ON_WRITE);
+  Map<OperationNode *, int> levels;
+  Vector<Vector<OperationNode *>> nodes_by_level;
+  for (OperationNode *node : state->graph->operations) {
+    if (!operation_needs_evaluation(node) || !need_evaluate_operation_at_stage(state, node)) {
+      continue;
+    }
+    const int level = copy_on_write_pass_level(state, node, levels);
+    if (level == -1) {
+      continue;
+    }
+    if (level >= nodes_by_level.size()) {
+      nodes_by_level.resize(level + 1);
+    }
+    nodes_by_level[level].append(node);
+    node->scheduled = true;
+  }
+
+  for (const Vector<OperationNode *> &level_nodes : nodes_by_level) {
+    CopyOnWritePassData data = {state, level_nodes};
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.use_threading = (G.debug & G_DEBUG_DEPSGRAPH_NO_THREADS) == 0;
+    settings.min_iter_per_thread = 1;
+    BLI_task_parallel_range(0, level_nodes.size(), &data, copy_on_write_pass_func, &settings);
+  }
+}
+
 void depsgraph_ensure_view_layer(Depsgraph *graph)
 {
   /* We update copy-on-write scene in the following cases:
@@ -385,14 +565,11 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   /* Do actual evaluation now. */
   /* First, process all Copy-On-Write nodes. */
   state.stage = EvaluationStage::COPY_ON_WRITE;
-  TaskPool *task_pool = deg_evaluate_task_pool_create(&state);
-  schedule_graph(&state, schedule_node_to_pool, task_pool);
-  BLI_task_pool_work_and_wait(task_pool);
-  BLI_task_pool_free(task_pool);
+  evaluate_copy_on_write_pass(&state);
 
   /* After that, process all other nodes. */
   state.stage = EvaluationStage::THREADED_EVALUATION;
-  task_pool = deg_evaluate_task_pool_create(&state);
+  TaskPool *task_pool = deg_evaluate_task_pool_create(&state);
   schedule_graph(&state, schedule_node_to_pool, task_pool);
   BLI_task_pool_work_and_wait(task_pool);
   BLI_task_pool_free(task_pool);
@@ -405,6 +582,7 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   /* Finalize statistics gathering. This is because we only gather single
    * operation timing here, without aggregating anything to avoid any extra
    * synchronization. */
+  deg_eval_stats_accumulate_average(graph);
   if (state.do_stats) {
     deg_eval_stats_aggregate(graph);
   }
@@ -284,7 +284,7 @@ struct ValidateData {
 
 /* Similar to generic BKE_id_copy() but does not require main and assumes pointer
  * is already allocated. */
-bool id_copy_inplace_no_main(const ID *id, ID *newid)
+bool id_copy_inplace_no_main(const ID *id, ID *newid, const int extra_flag = 0)
 {
   const ID *id_for_copy = id;
 
@@ -304,7 +304,8 @@ bool id_copy_inplace_no_main(const ID *id, ID *newid)
   bool result = (BKE_id_copy_ex(nullptr,
                                 (ID *)id_for_copy,
                                 &newid,
-                                LIB_ID_COPY_LOCALIZE | LIB_ID_CREATE_NO_ALLOCATE) != nullptr);
+                                LIB_ID_COPY_LOCALIZE | LIB_ID_CREATE_NO_ALLOCATE |
+                                    extra_flag) != nullptr);
 
 #ifdef NESTED_ID_NASTY_WORKAROUND
   if (result) {
@@ -894,8 +895,12 @@ ID *deg_expand_copy_on_write_datablock(const Depsgraph *depsgraph,
       break;
     }
     case ID_ME: {
-      /* TODO(sergey): Ideally we want to handle meshes in a special
-       * manner here to avoid initial copy of all the geometry arrays. */
+      /* Share the geometry arrays with the original mesh, they are only copied when the evaluation
+       * modifies them. The render pipeline keeps its own copy since the original might be edited
+       * while rendering. */
+      if (!depsgraph->is_render_pipeline_depsgraph) {
+        done = id_copy_inplace_no_main(id_orig, id_cow, LIB_ID_COPY_CD_SHARE);
+      }
       break;
     }
     default:
@@ -23,9 +23,17 @@
 
 #include "intern/eval/deg_eval_stats.h"
 
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+#include "BLI_array.hh"
+#include "BLI_map.hh"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "intern/depsgraph.h"
+#include "intern/depsgraph_relation.h"
 
 #include "intern/node/deg_node.h"
 #include "intern/node/deg_node_component.h"
@@ -54,4 +62,110 @@ void deg_eval_stats_aggregate(Depsgraph *graph)
   }
 }
 
+void deg_eval_stats_accumulate_average(Depsgraph *graph)
+{
+  for (OperationNode *op_node : graph->operations) {
+    op_node->stats.accumulate_current();
+  }
+}
+
+double deg_eval_stats_simulate_schedule(const Depsgraph *graph,
+                                        const int threads_num,
+                                        const bool use_critical_path)
+{
+  const int64_t nodes_num = graph->operations.size();
+  Map<const OperationNode *, int64_t> node_indices;
+  node_indices.reserve(nodes_num);
+  for (const int64_t i : graph->operations.index_range()) {
+    node_indices.add_new(graph->operations[i], i);
+  }
+
+  auto for_each_child = [&](const int64_t index, const auto &fn) {
+    for (const Relation *rel : graph->operations[index]->outlinks) {
+      if ((rel->flag & RELATION_FLAG_CYCLIC) == 0) {
+        fn(node_indices.lookup((const OperationNode *)rel->to));
+      }
+    }
+  };
+
+  Array<int> pending(nodes_num, 0);
+  for (const int64_t i : IndexRange(nodes_num)) {
+    for_each_child(i, [&](const int64_t child) { pending[child]++; });
+  }
+
+  /* Critical path times of all operations, in reverse topological order. */
+  Array<double> critical_path(nodes_num, 0.0);
+  {
+    Array<int> pending_copy = pending;
+    Vector<int64_t> order;
+    order.reserve(nodes_num);
+    for (const int64_t i : IndexRange(nodes_num)) {
+      if (pending_copy[i] == 0) {
+        order.append(i);
+      }
+    }
+    for (int64_t i = 0; i < order.size(); i++) {
+      for_each_child(order[i], [&](const int64_t child) {
+        if (--pending_copy[child] == 0) {
+          order.append(child);
+        }
+      });
+    }
+    for (int64_t i = order.size() - 1; i >= 0; i--) {
+      const int64_t index = order[i];
+      double children_time = 0.0;
+      for_each_child(index, [&](const int64_t child) {
+        children_time = std::max(children_time, critical_path[child]);
+      });
+      critical_path[index] = children_time + graph->operations[index]->stats.average_time;
+    }
+  }
+
+  /* Ready operations, either in order or prioritized by the critical path. */
+  Vector<int64_t> ready;
+  int64_t ready_start = 0;
+  auto critical_path_less = [&](const int64_t a, const int64_t b) {
+    return critical_path[a] < critical_path[b];
+  };
+  auto push_ready = [&](const int64_t index) {
+    ready.append(index);
+    if (use_critical_path) {
+      std::push_heap(ready.begin() + ready_start, ready.end(), critical_path_less);
+    }
+  };
+  auto pop_ready = [&]() {
+    if (use_critical_path) {
+      std::pop_heap(ready.begin() + ready_start, ready.end(), critical_path_less);
+      return ready.pop_last();
+    }
+    return ready[ready_start++];
+  };
+
+  for (const int64_t i : IndexRange(nodes_num)) {
+    if (pending[i] == 0) {
+      push_ready(i);
+    }
+  }
+
+  /* Running operations with the time at which they finish. */
+  using RunningNode = std::pair<double, int64_t>;
+  std::priority_queue<RunningNode, std::vector<RunningNode>, std::greater<RunningNode>> running;
+  double time = 0.0;
+  while (ready.size() > ready_start || !running.empty()) {
+    while (ready.size() > ready_start && running.size() < (size_t)threads_num) {
+      const int64_t index = pop_ready();
+      running.push({time + graph->operations[index]->stats.average_time, index});
+    }
+    const RunningNode finished = running.top();
+    running.pop();
+    time = finished.first;
+    for_each_child(finished.second, [&](const int64_t child) {
+      if (--pending[child] == 0) {
+        push_ready(child);
+      }
+    });
+  }
+  return time;
+}
+
 }  // namespace blender::deg
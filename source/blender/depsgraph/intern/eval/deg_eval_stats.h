@@ -31,5 +31,15 @@ struct Depsgraph;
 /* Aggregate operation timings to overall component and ID nodes timing. */
 void deg_eval_stats_aggregate(Depsgraph *graph);
 
+/* Accumulate timing of the current evaluation into the average timing of the operations. */
+void deg_eval_stats_accumulate_average(Depsgraph *graph);
+
+/* Simulate evaluation of all operations of the graph on the given number of threads, using the
+ * average timing of the operations, and return the total time it would take. Ready operations are
+ * either picked in the order they became ready or by their critical path. */
+double deg_eval_stats_simulate_schedule(const Depsgraph *graph,
+                                        int threads_num,
+                                        bool use_critical_path);
+
 }  // namespace deg
 }  // namespace blender
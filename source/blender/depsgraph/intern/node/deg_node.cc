@@ -278,6 +278,7 @@ Node::Stats::Stats()
 void Node::Stats::reset()
 {
   current_time = 0.0;
+  average_time = 0.0;
 }
 
 void Node::Stats::reset_current()
@@ -285,6 +286,20 @@ void Node::Stats::reset_current()
   current_time = 0.0;
 }
 
+void Node::Stats::accumulate_current()
+{
+  if (current_time == 0.0) {
+    /* Not evaluated, keep the history. */
+    return;
+  }
+  if (average_time == 0.0) {
+    average_time = current_time;
+  }
+  else {
+    average_time = average_time * 0.75 + current_time * 0.25;
+  }
+}
+
 /*******************************************************************************
  * Node itself.
  */
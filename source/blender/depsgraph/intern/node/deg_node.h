@@ -161,8 +161,13 @@ struct Node {
     /* Reset counters needed for the current graph evaluation, does not
      * touch averaging accumulators. */
     void reset_current();
+    /* Accumulate time of the current graph evaluation into the average. */
+    void accumulate_current();
     /* Time spend on this node during current graph evaluation. */
     double current_time;
+    /* Moving average of the time spent on this node in the evaluations which included it. Used by
+     * the scheduler to predict the cost of operations. */
+    double average_time;
   };
   /* Relationships between nodes
    * The reason why all depsgraph nodes are descended from this type (apart
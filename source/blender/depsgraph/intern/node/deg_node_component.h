@@ -106,6 +106,9 @@ struct ComponentNode : public Node {
   virtual OperationNode *get_exit_operation() override;
 
   void finalize_build(Depsgraph *graph);
+  /* Revert the operations storage to the one used during build, so that new operations can be
+   * added to the component of an already built graph. */
+  void restore_operations_map();
 
   IDNode *owner;
 
@@ -265,6 +265,11 @@ struct OperationNode : public Node {
   uint32_t num_links_pending;
   bool scheduled;
 
+  /* Estimated time from the start of this operation until all operations which depend on it are
+   * evaluated, based on the average evaluation time of the operations. Ready operations with the
+   * longest critical path are evaluated first. */
+  double critical_path_time;
+
   /* Identifier for the operation being performed. */
   OperationCode opcode;
   int name_tag;
@@ -315,6 +315,31 @@ class GVArray_For_SingleValue : public GVArray_For_SingleValueRef {
   ~GVArray_For_SingleValue();
 };
 
+/* Generic virtual array that only exposes the elements of another virtual array that are
+ * referenced by an index mask. The i-th element corresponds to the element at `mask[i]`. This is
+ * used to process a large virtual array in smaller chunks. */
+class GVArray_For_MaskedGVArray : public GVArray {
+ protected:
+  const GVArray &varray_;
+  IndexMask mask_;
+
+ public:
+  GVArray_For_MaskedGVArray(const GVArray &varray, const IndexMask mask)
+      : GVArray(varray.type(), mask.size()), varray_(varray), mask_(mask)
+  {
+  }
+
+ protected:
+  void get_impl(const int64_t index, void *r_value) const override;
+  void get_to_uninitialized_impl(const int64_t index, void *r_value) const override;
+
+  bool is_span_impl() const override;
+  GSpan get_internal_span_impl() const override;
+
+  bool is_single_impl() const override;
+  void get_internal_single_impl(void *r_value) const override;
+};
+
 /* Used to convert a typed virtual array into a generic one. */
 template<typename T> class GVArray_For_VArray : public GVArray {
  protected:
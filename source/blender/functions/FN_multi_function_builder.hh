@@ -61,6 +61,16 @@ template<typename In1, typename Out1> class CustomMF_SI_SO : public MultiFunctio
   template<typename ElementFuncT> static FunctionT create_function(ElementFuncT element_fn)
   {
     return [=](IndexMask mask, const VArray<In1> &in1, MutableSpan<Out1> out1) {
+      if (mask.is_range() && in1.is_span()) {
+        /* Fast path for the most common case. The loop can be vectorized by the compiler. */
+        const IndexRange range = mask.as_range();
+        const In1 *__restrict in1_data = in1.get_internal_span().data();
+        Out1 *__restrict out1_data = out1.data();
+        for (int64_t i = range.start(); i < range.one_after_last(); i++) {
+          new (static_cast<void *>(out1_data + i)) Out1(element_fn(in1_data[i]));
+        }
+        return;
+      }
       /* Devirtualization results in a 2-3x speedup for some simple functions. */
       devirtualize_varray(in1, [&](const auto &in1) {
         mask.foreach_index(
@@ -114,6 +124,10 @@ class CustomMF_SI_SI_SO : public MultiFunction {
                const VArray<In1> &in1,
                const VArray<In2> &in2,
                MutableSpan<Out1> out1) {
+      if (mask.is_range() &&
+          CustomMF_SI_SI_SO::try_call_range(mask.as_range(), in1, in2, out1, element_fn)) {
+        return;
+      }
       /* Devirtualization results in a 2-3x speedup for some simple functions. */
       devirtualize_varray2(in1, in2, [&](const auto &in1, const auto &in2) {
         mask.foreach_index(
@@ -122,6 +136,48 @@ class CustomMF_SI_SI_SO : public MultiFunction {
     };
   }
 
+  /**
+   * Fast path for a contiguous mask when every input is a span or a single value. The loops use
+   * raw pointers, so that the compiler can vectorize them. Returns false when the inputs are
+   * stored differently.
+   */
+  template<typename ElementFuncT>
+  static bool try_call_range(const IndexRange range,
+                             const VArray<In1> &in1,
+                             const VArray<In2> &in2,
+                             MutableSpan<Out1> out1,
+                             const ElementFuncT &element_fn)
+  {
+    Out1 *__restrict out1_data = out1.data();
+    const int64_t start = range.start();
+    const int64_t end = range.one_after_last();
+    if (in1.is_span() && in2.is_span()) {
+      const In1 *__restrict in1_data = in1.get_internal_span().data();
+      const In2 *__restrict in2_data = in2.get_internal_span().data();
+      for (int64_t i = start; i < end; i++) {
+        new (static_cast<void *>(out1_data + i)) Out1(element_fn(in1_data[i], in2_data[i]));
+      }
+      return true;
+    }
+    if (in1.is_span() && in2.is_single()) {
+      const In1 *__restrict in1_data = in1.get_internal_span().data();
+      const In2 in2_value = in2.get_internal_single();
+      for (int64_t i = start; i < end; i++) {
+        new (static_cast<void *>(out1_data + i)) Out1(element_fn(in1_data[i], in2_value));
+      }
+      return true;
+    }
+    if (in1.is_single() && in2.is_span()) {
+      const In1 in1_value = in1.get_internal_single();
+      const In2 *__restrict in2_data = in2.get_internal_span().data();
+      for (int64_t i = start; i < end; i++) {
+        new (static_cast<void *>(out1_data + i)) Out1(element_fn(in1_value, in2_data[i]));
+      }
+      return true;
+    }
+    return false;
+  }
+
   void call(IndexMask mask, MFParams params, MFContext UNUSED(context)) const override
   {
     const VArray<In1> &in1 = params.readonly_single_input<In1>(0);
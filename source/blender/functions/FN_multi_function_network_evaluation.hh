@@ -31,15 +31,25 @@ class MFNetworkEvaluator : public MultiFunction {
   MFSignature signature_;
   Vector<const MFOutputSocket *> inputs_;
   Vector<const MFInputSocket *> outputs_;
+  /**
+   * When this is larger than zero, large masks are split into chunks of at most this many indices
+   * that are evaluated one after another. This keeps temporary buffers small enough to stay in the
+   * cache. Only networks that contain element-wise functions can be evaluated this way.
+   */
+  int64_t chunk_size_;
 
  public:
-  MFNetworkEvaluator(Vector<const MFOutputSocket *> inputs, Vector<const MFInputSocket *> outputs);
+  MFNetworkEvaluator(Vector<const MFOutputSocket *> inputs,
+                     Vector<const MFInputSocket *> outputs,
+                     int64_t chunk_size = 0);
 
   void call(IndexMask mask, MFParams params, MFContext context) const override;
 
  private:
   using Storage = MFNetworkEvaluationStorage;
 
+  void call_in_chunks(IndexMask mask, MFParams params, MFContext context) const;
+
   void copy_inputs_to_storage(MFParams params, Storage &storage) const;
   void copy_outputs_to_storage(
       MFParams params,
@@ -25,5 +25,6 @@ namespace blender::fn::mf_network_optimization {
 void dead_node_removal(MFNetwork &network);
 void constant_folding(MFNetwork &network, ResourceScope &scope);
 void common_subnetwork_elimination(MFNetwork &network);
+void fuse_element_wise_nodes(MFNetwork &network, ResourceScope &scope);
 
 }  // namespace blender::fn::mf_network_optimization
@@ -197,6 +197,42 @@ void GVArray_For_SingleValueRef::get_internal_single_impl(void *r_value) const
   type_->copy_to_initialized(value_, r_value);
 }
 
+/* --------------------------------------------------------------------
+ * GVArray_For_MaskedGVArray.
+ */
+
+void GVArray_For_MaskedGVArray::get_impl(const int64_t index, void *r_value) const
+{
+  varray_.get(mask_[index], r_value);
+}
+
+void GVArray_For_MaskedGVArray::get_to_uninitialized_impl(const int64_t index,
+                                                          void *r_value) const
+{
+  varray_.get_to_uninitialized(mask_[index], r_value);
+}
+
+bool GVArray_For_MaskedGVArray::is_span_impl() const
+{
+  return mask_.is_range() && varray_.is_span();
+}
+
+GSpan GVArray_For_MaskedGVArray::get_internal_span_impl() const
+{
+  const IndexRange range = mask_.as_range();
+  return varray_.get_internal_span().slice(range.start(), range.size());
+}
+
+bool GVArray_For_MaskedGVArray::is_single_impl() const
+{
+  return varray_.is_single();
+}
+
+void GVArray_For_MaskedGVArray::get_internal_single_impl(void *r_value) const
+{
+  varray_.get_internal_single(r_value);
+}
+
 /* --------------------------------------------------------------------
  * GVArray_For_SingleValue.
  */
@@ -28,6 +28,8 @@
  * - Avoids data copies in many cases.
  * - Every node is executed at most once.
  * - Can compute sub-functions on a single element, when the result is the same for all elements.
+ * - Can split large masks into chunks, so that temporary buffers of element-wise networks stay
+ *   small (see `mf_network_optimization::fuse_element_wise_nodes`).
  *
  * Possible improvements:
  * - Cache and reuse buffers.
@@ -108,10 +110,12 @@ class MFNetworkEvaluationStorage {
 };
 
 MFNetworkEvaluator::MFNetworkEvaluator(Vector<const MFOutputSocket *> inputs,
-                                       Vector<const MFInputSocket *> outputs)
-    : inputs_(std::move(inputs)), outputs_(std::move(outputs))
+                                       Vector<const MFInputSocket *> outputs,
+                                       const int64_t chunk_size)
+    : inputs_(std::move(inputs)), outputs_(std::move(outputs)), chunk_size_(chunk_size)
 {
   BLI_assert(outputs_.size() > 0);
+  BLI_assert(chunk_size_ >= 0);
   MFSignatureBuilder signature{"Function Tree"};
 
   for (const MFOutputSocket *socket : inputs_) {
@@ -151,6 +155,10 @@ void MFNetworkEvaluator::call(IndexMask mask, MFParams params, MFContext context
   if (mask.size() == 0) {
     return;
   }
+  if (chunk_size_ > 0 && mask.size() > chunk_size_) {
+    this->call_in_chunks(mask, params, context);
+    return;
+  }
 
   const MFNetwork &network = outputs_[0]->node().network();
   Storage storage(mask, network.socket_id_amount());
@@ -163,6 +171,68 @@ void MFNetworkEvaluator::call(IndexMask mask, MFParams params, MFContext context
   this->initialize_remaining_outputs(params, storage, outputs_to_initialize_in_the_end);
 }
 
+/**
+ * Evaluate the entire network for one chunk of the mask after the other. Every chunk is evaluated
+ * with a dense mask, so that the temporary buffers only have to be as large as a chunk, instead of
+ * as large as the largest index in the mask.
+ */
+BLI_NOINLINE void MFNetworkEvaluator::call_in_chunks(IndexMask mask,
+                                                     MFParams params,
+                                                     MFContext context) const
+{
+  /* Outputs are written to these buffers first when the indices of a chunk are not contiguous. */
+  Array<void *> chunk_buffers(outputs_.size(), nullptr);
+
+  for (int64_t chunk_start = 0; chunk_start < mask.size(); chunk_start += chunk_size_) {
+    const int64_t chunk_size = std::min(chunk_size_, mask.size() - chunk_start);
+    const IndexMask chunk_mask = mask.indices().slice(chunk_start, chunk_size);
+    const bool chunk_is_range = chunk_mask.is_range();
+
+    ResourceScope scope;
+    MFParamsBuilder chunk_params{*this, chunk_size};
+    for (int input_index : inputs_.index_range()) {
+      const GVArray &varray = params.readonly_single_input(input_index);
+      chunk_params.add_readonly_single_input(
+          scope.construct<GVArray_For_MaskedGVArray>(__func__, varray, chunk_mask));
+    }
+    for (int output_index : outputs_.index_range()) {
+      const int param_index = output_index + inputs_.size();
+      GMutableSpan span = params.uninitialized_single_output(param_index);
+      if (chunk_is_range) {
+        chunk_params.add_uninitialized_single_output(span.slice(chunk_mask[0], chunk_size));
+        continue;
+      }
+      const CPPType &type = span.type();
+      if (chunk_buffers[output_index] == nullptr) {
+        chunk_buffers[output_index] = MEM_mallocN_aligned(
+            chunk_size_ * type.size(), type.alignment(), AT);
+      }
+      chunk_params.add_uninitialized_single_output(
+          GMutableSpan(type, chunk_buffers[output_index], chunk_size));
+    }
+
+    this->call(IndexRange(chunk_size), chunk_params, context);
+
+    if (!chunk_is_range) {
+      for (int output_index : outputs_.index_range()) {
+        const int param_index = output_index + inputs_.size();
+        GMutableSpan span = params.uninitialized_single_output(param_index);
+        const CPPType &type = span.type();
+        for (int64_t i : IndexRange(chunk_size)) {
+          type.relocate_to_uninitialized(
+              POINTER_OFFSET(chunk_buffers[output_index], type.size() * i), span[chunk_mask[i]]);
+        }
+      }
+    }
+  }
+
+  for (void *buffer : chunk_buffers) {
+    if (buffer != nullptr) {
+      MEM_freeN(buffer);
+    }
+  }
+}
+
 BLI_NOINLINE void MFNetworkEvaluator::copy_inputs_to_storage(MFParams params,
                                                              Storage &storage) const
 {
@@ -498,4 +498,183 @@ void common_subnetwork_elimination(MFNetwork &network)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Element-wise Node Fusion
+ * \{ */
+
+/* The temporary buffers of a fused node should fit into the L2 cache together. */
+static constexpr int64_t fused_nodes_buffer_size = 128 * 1024;
+static constexpr int64_t fused_nodes_min_chunk_size = 64;
+
+/**
+ * Element-wise nodes compute every output element only from the input elements at the same index.
+ * Those can be evaluated on a part of the mask at a time.
+ */
+static bool function_node_is_element_wise(const MFFunctionNode &node)
+{
+  const MultiFunction &fn = node.function();
+  if (fn.depends_on_context()) {
+    return false;
+  }
+  if (node.has_unlinked_inputs()) {
+    return false;
+  }
+  for (int param_index : fn.param_indices()) {
+    const MFParamType::Category category = fn.param_type(param_index).category();
+    if (!ELEM(category, MFParamType::SingleInput, MFParamType::SingleOutput)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Returns the element-wise node that uses all outputs of the given node. When the outputs are used
+ * by any other node as well, the node cannot be fused with its target and null is returned.
+ */
+static MFFunctionNode *find_fusion_target(MFFunctionNode &node, Span<bool> is_element_wise)
+{
+  MFNode *target_node = nullptr;
+  for (MFOutputSocket *output_socket : node.outputs()) {
+    for (MFInputSocket *target_socket : output_socket->targets()) {
+      if (target_node == nullptr) {
+        target_node = &target_socket->node();
+      }
+      else if (target_node != &target_socket->node()) {
+        return nullptr;
+      }
+    }
+  }
+  if (target_node == nullptr || !is_element_wise[target_node->id()]) {
+    return nullptr;
+  }
+  return &target_node->as_function();
+}
+
+/**
+ * Groups element-wise nodes whose outputs are only used within the group. Every group has a
+ * single root node, all other nodes are (indirectly) used only by that root.
+ */
+static MultiValueMap<MFFunctionNode *, MFFunctionNode *> find_nodes_to_fuse(MFNetwork &network)
+{
+  Array<bool> is_element_wise(network.node_id_amount(), false);
+  for (MFFunctionNode *node : network.function_nodes()) {
+    is_element_wise[node->id()] = function_node_is_element_wise(*node);
+  }
+
+  Array<MFFunctionNode *> fusion_targets(network.node_id_amount(), nullptr);
+  for (MFFunctionNode *node : network.function_nodes()) {
+    if (is_element_wise[node->id()]) {
+      fusion_targets[node->id()] = find_fusion_target(*node, is_element_wise);
+    }
+  }
+
+  MultiValueMap<MFFunctionNode *, MFFunctionNode *> nodes_by_root;
+  for (MFFunctionNode *node : network.function_nodes()) {
+    if (!is_element_wise[node->id()]) {
+      continue;
+    }
+    MFFunctionNode *root = node;
+    while (fusion_targets[root->id()] != nullptr) {
+      root = fusion_targets[root->id()];
+    }
+    nodes_by_root.add(root, node);
+  }
+  return nodes_by_root;
+}
+
+/**
+ * Moves the given nodes into a separate network that is evaluated in chunks by a single function
+ * node, which replaces the nodes in the original network.
+ */
+static void fuse_nodes(MFNetwork &network,
+                       MFFunctionNode &root,
+                       Span<MFFunctionNode *> nodes,
+                       ResourceScope &scope)
+{
+  MFNetwork &fused_network = scope.construct<MFNetwork>(__func__);
+
+  Map<const MFNode *, MFFunctionNode *> fused_nodes;
+  for (MFFunctionNode *node : nodes) {
+    fused_nodes.add_new(node, &fused_network.add_function(node->function()));
+  }
+
+  Map<MFOutputSocket *, MFOutputSocket *> fused_input_by_origin;
+  Vector<MFOutputSocket *> origins;
+  Vector<const MFOutputSocket *> fused_inputs;
+  int64_t element_size = 0;
+  for (MFFunctionNode *node : nodes) {
+    MFFunctionNode &fused_node = *fused_nodes.lookup(node);
+    for (MFInputSocket *input_socket : node->inputs()) {
+      MFOutputSocket &origin = *input_socket->origin();
+      MFInputSocket &fused_input_socket = fused_node.input(input_socket->index());
+      MFFunctionNode *fused_origin_node = fused_nodes.lookup_default(&origin.node(), nullptr);
+      if (fused_origin_node != nullptr) {
+        fused_network.add_link(fused_origin_node->output(origin.index()), fused_input_socket);
+        continue;
+      }
+      MFOutputSocket *fused_input = fused_input_by_origin.lookup_or_add_cb(&origin, [&]() {
+        MFOutputSocket &socket = fused_network.add_input(origin.name(), origin.data_type());
+        origins.append(&origin);
+        fused_inputs.append(&socket);
+        return &socket;
+      });
+      fused_network.add_link(*fused_input, fused_input_socket);
+    }
+    for (MFOutputSocket *output_socket : node->outputs()) {
+      element_size += output_socket->data_type().single_type().size();
+    }
+  }
+
+  Vector<MFOutputSocket *> replaced_outputs;
+  Vector<const MFInputSocket *> fused_outputs;
+  for (MFOutputSocket *output_socket : root.outputs()) {
+    if (output_socket->targets().is_empty()) {
+      continue;
+    }
+    MFInputSocket &fused_output = fused_network.add_output(output_socket->name(),
+                                                           output_socket->data_type());
+    fused_network.add_link(fused_nodes.lookup(&root)->output(output_socket->index()),
+                           fused_output);
+    replaced_outputs.append(output_socket);
+    fused_outputs.append(&fused_output);
+  }
+  if (fused_outputs.is_empty()) {
+    /* The nodes are not used, they are removed by #dead_node_removal. */
+    return;
+  }
+
+  const int64_t chunk_size = std::max(fused_nodes_buffer_size / std::max<int64_t>(element_size, 1),
+                                      fused_nodes_min_chunk_size);
+  const MultiFunction &fused_fn = scope.construct<MFNetworkEvaluator>(
+      __func__, std::move(fused_inputs), std::move(fused_outputs), chunk_size);
+
+  MFFunctionNode &fused_node = network.add_function(fused_fn);
+  for (int i : origins.index_range()) {
+    network.add_link(*origins[i], fused_node.input(i));
+  }
+  for (int i : replaced_outputs.index_range()) {
+    network.relink(*replaced_outputs[i], fused_node.output(i));
+  }
+  network.remove(nodes.cast<MFNode *>());
+}
+
+/**
+ * Finds chains of element-wise function nodes and replaces every chain with a single node that
+ * evaluates the entire chain on small chunks of the mask at a time. That way the intermediate
+ * values of the chain never have to be stored for the entire mask, which reduces the memory
+ * bandwidth required to evaluate large networks.
+ */
+void fuse_element_wise_nodes(MFNetwork &network, ResourceScope &scope)
+{
+  MultiValueMap<MFFunctionNode *, MFFunctionNode *> nodes_by_root = find_nodes_to_fuse(network);
+  for (auto item : nodes_by_root.items()) {
+    if (item.value.size() >= 2) {
+      fuse_nodes(network, *item.key, item.value, scope);
+    }
+  }
+}
+
+/** \} */
+
 }  // namespace blender::fn::mf_network_optimization
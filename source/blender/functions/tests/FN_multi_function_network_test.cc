@@ -5,6 +5,7 @@
 #include "FN_multi_function_builder.hh"
 #include "FN_multi_function_network.hh"
 #include "FN_multi_function_network_evaluation.hh"
+#include "FN_multi_function_network_optimization.hh"
 
 namespace blender::fn::tests {
 namespace {
@@ -276,5 +277,60 @@ TEST(multi_function_network, Test2)
   }
 }
 
+TEST(multi_function_network, FuseElementWiseNodes)
+{
+  CustomMF_SI_SO<int, int> add_10_fn("add 10", [](int value) { return value + 10; });
+  CustomMF_SI_SI_SO<int, int, int> multiply_fn("multiply", [](int a, int b) { return a * b; });
+  CustomMF_SI_SO<int, int> negate_fn("negate", [](int value) { return -value; });
+
+  MFNetwork network;
+
+  MFNode &node1 = network.add_function(add_10_fn);
+  MFNode &node2 = network.add_function(multiply_fn);
+  MFNode &node3 = network.add_function(negate_fn);
+  MFOutputSocket &input_socket = network.add_input("Input", MFDataType::ForSingle<int>());
+  MFInputSocket &output_socket1 = network.add_output("Output 1", MFDataType::ForSingle<int>());
+  MFInputSocket &output_socket2 = network.add_output("Output 2", MFDataType::ForSingle<int>());
+  network.add_link(input_socket, node1.input(0));
+  network.add_link(node1.output(0), node2.input(0));
+  network.add_link(input_socket, node2.input(1));
+  network.add_link(node2.output(0), node3.input(0));
+  network.add_link(node3.output(0), output_socket1);
+  network.add_link(node3.output(0), output_socket2);
+
+  ResourceScope scope;
+  mf_network_optimization::fuse_element_wise_nodes(network, scope);
+  EXPECT_EQ(network.function_nodes().size(), 1);
+
+  MFNetworkEvaluator network_fn{{&input_socket}, {&output_socket1, &output_socket2}};
+
+  const int size = 100000;
+  Array<int> values(size);
+  for (int i : values.index_range()) {
+    values[i] = i % 100;
+  }
+  Vector<int64_t> indices;
+  for (int i = 0; i < size; i += (i < size / 2) ? 1 : 3) {
+    indices.append(i);
+  }
+  Array<int> results1(size, 0);
+  Array<int> results2(size, 0);
+
+  MFParamsBuilder params(network_fn, size);
+  params.add_readonly_single_input(values.as_span());
+  params.add_uninitialized_single_output(results1.as_mutable_span());
+  params.add_uninitialized_single_output(results2.as_mutable_span());
+
+  MFContextBuilder context;
+
+  network_fn.call(indices.as_span(), params, context);
+
+  for (const int64_t i : indices) {
+    EXPECT_EQ(results1[i], -(values[i] + 10) * values[i]);
+    EXPECT_EQ(results2[i], -(values[i] + 10) * values[i]);
+  }
+  EXPECT_EQ(results1[size / 2 + 1], 0);
+}
+
 }  // namespace
 }  // namespace blender::fn::tests
@@ -2,6 +2,9 @@
 
 #include "testing/testing.h"
 
+#include "BLI_float3.hh"
+#include "BLI_timeit.hh"
+
 #include "FN_multi_function.hh"
 #include "FN_multi_function_builder.hh"
 
@@ -278,6 +281,51 @@ TEST(multi_function, CustomMF_SI_SI_SO)
   EXPECT_EQ(outputs[3], 90);
 }
 
+TEST(multi_function, CustomMF_SI_SI_SO_Range)
+{
+  CustomMF_SI_SI_SO<int, int, int> fn("sub", [](int a, int b) { return a - b; });
+
+  Array<int> values_a = {4, 6, 8, 9, 2};
+  Array<int> values_b = {1, 2, 3, 4, 5};
+  int value_single = 10;
+  MFContextBuilder context;
+
+  {
+    Array<int> outputs(values_a.size(), -1);
+    MFParamsBuilder params(fn, values_a.size());
+    params.add_readonly_single_input(values_a.as_span());
+    params.add_readonly_single_input(values_b.as_span());
+    params.add_uninitialized_single_output(outputs.as_mutable_span());
+    fn.call(IndexRange(1, 3), params, context);
+    EXPECT_EQ(outputs[0], -1);
+    EXPECT_EQ(outputs[1], 4);
+    EXPECT_EQ(outputs[2], 5);
+    EXPECT_EQ(outputs[3], 5);
+    EXPECT_EQ(outputs[4], -1);
+  }
+  {
+    Array<int> outputs(values_a.size(), -1);
+    MFParamsBuilder params(fn, values_a.size());
+    params.add_readonly_single_input(values_a.as_span());
+    params.add_readonly_single_input(&value_single);
+    params.add_uninitialized_single_output(outputs.as_mutable_span());
+    fn.call(IndexRange(5), params, context);
+    EXPECT_EQ(outputs[0], -6);
+    EXPECT_EQ(outputs[4], -8);
+  }
+  {
+    Array<int> outputs(values_a.size(), -1);
+    MFParamsBuilder params(fn, values_a.size());
+    params.add_readonly_single_input(&value_single);
+    params.add_readonly_single_input(values_b.as_span());
+    params.add_uninitialized_single_output(outputs.as_mutable_span());
+    fn.call(IndexRange(2, 3), params, context);
+    EXPECT_EQ(outputs[1], -1);
+    EXPECT_EQ(outputs[2], 7);
+    EXPECT_EQ(outputs[4], 5);
+  }
+}
+
 TEST(multi_function, CustomMF_SI_SI_SI_SO)
 {
   CustomMF_SI_SI_SI_SO<int, std::string, bool, uint> fn{
@@ -412,5 +460,62 @@ TEST(multi_function, CustomMF_Convert)
   EXPECT_EQ(outputs[2], 9);
 }
 
+/**
+ * Set this to 1 to activate the benchmark. It compares the contiguous fast path of the builder
+ * functions with the generic devirtualized path that is used for other masks.
+ */
+#if 0
+BLI_NOINLINE static void benchmark_float3_add(const MultiFunction &fn, StringRef name)
+{
+  const int64_t size = 10000000;
+  Array<float3> values_a(size);
+  Array<float3> values_b(size);
+  for (const int64_t i : IndexRange(size)) {
+    values_a[i] = float3(i, i * 2, i * 3);
+    values_b[i] = float3(1.0f, 2.0f, 3.0f);
+  }
+  Array<float3> outputs(size);
+
+  MFParamsBuilder params(fn, size);
+  params.add_readonly_single_input(values_a.as_span());
+  params.add_readonly_single_input(values_b.as_span());
+  params.add_uninitialized_single_output(outputs.as_mutable_span());
+  MFContextBuilder context;
+  {
+    SCOPED_TIMER(name);
+    fn.call(IndexRange(size), params, context);
+  }
+
+  /* Print the value for simple error checking and to avoid some compiler optimizations. */
+  std::cout << "Value: " << outputs[size / 2] << "\n";
+}
+
+TEST(multi_function, BenchmarkBuilderFastPath)
+{
+  using AddFn = CustomMF_SI_SI_SO<float3, float3, float3>;
+  const auto element_fn = [](float3 a, float3 b) { return a + b; };
+
+  AddFn fast_fn{"add", element_fn};
+  /* Same as the element-wise path that is used when the mask is not a range. */
+  using FunctionT = std::function<void(
+      IndexMask, const VArray<float3> &, const VArray<float3> &, MutableSpan<float3>)>;
+  FunctionT generic_function = [&](IndexMask mask,
+                                   const VArray<float3> &in1,
+                                   const VArray<float3> &in2,
+                                   MutableSpan<float3> out1) {
+    devirtualize_varray2(in1, in2, [&](const auto &in1, const auto &in2) {
+      mask.foreach_index([&](int i) { new (&out1[i]) float3(element_fn(in1[i], in2[i])); });
+    });
+  };
+  AddFn generic_fn{"add", generic_function};
+
+  for (int i = 0; i < 3; i++) {
+    benchmark_float3_add(generic_fn, "Generic  ");
+    benchmark_float3_add(fast_fn, "Fast Path");
+  }
+}
+
+#endif /* Benchmark */
+
 }  // namespace
 }  // namespace blender::fn::tests
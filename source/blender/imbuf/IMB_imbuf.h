@@ -452,6 +452,24 @@ struct ImBuf *IMB_onehalf(struct ImBuf *ibuf1);
  */
 bool IMB_scaleImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy);
 
+typedef enum eIMBScaleFilter {
+  /** Average of the covered pixels, nearest pixel when enlarging. */
+  IMB_SCALE_FILTER_BOX = 0,
+  IMB_SCALE_FILTER_BILINEAR = 1,
+  /** Sharpest result, but can overshoot near edges. */
+  IMB_SCALE_FILTER_LANCZOS = 2,
+} eIMBScaleFilter;
+
+/**
+ * Multi-threaded scaling of the byte and float buffers with the given filter.
+ *
+ * \attention Defined in scaling.c
+ */
+bool IMB_scaleImBuf_filtered(struct ImBuf *ibuf,
+                             unsigned int newx,
+                             unsigned int newy,
+                             eIMBScaleFilter filter);
+
 /**
  *
  * \attention Defined in scaling.c
@@ -47,6 +47,7 @@
 #include "BLI_math_color.h"
 #include "BLI_rect.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BKE_appdir.h"
@@ -101,7 +102,9 @@ static float imbuf_linear_srgb_to_xyz[3][3] = {{0.0f}};
 static pthread_mutex_t processor_lock = BLI_MUTEX_INITIALIZER;
 
 typedef struct ColormanageProcessor {
+  /* Owned by the processor cache entry. */
   OCIO_ConstCPUProcessorRcPtr *cpu_processor;
+  struct ProcessorCacheEntry *cache_entry;
   CurveMapping *curve_mapping;
   bool is_data_result;
 } ColormanageProcessor;
@@ -124,6 +127,8 @@ static struct global_color_picking_state {
   bool failed;
 } global_color_picking_state = {NULL};
 
+static void processor_cache_free(void);
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -588,6 +593,8 @@ static void colormanage_free_config(void)
   ColorSpace *colorspace;
   ColorManagedDisplay *display;
 
+  processor_cache_free();
+
   /* free color spaces */
   colorspace = global_colorspaces.first;
   while (colorspace) {
@@ -872,6 +879,152 @@ static OCIO_ConstProcessorRcPtr *create_colorspace_transform_processor(const cha
   return processor;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name CPU Processor Cache
+ *
+ * Creating a CPU processor is expensive, it is done for every display buffer update. Recently
+ * used processors are kept, keyed by all settings that affect the transform. Entries are
+ * reference counted, only unused entries are freed when the cache is full.
+ * \{ */
+
+/* Maximum number of cached processors which are not used by any #ColormanageProcessor. */
+#define PROCESSOR_CACHE_MAX_UNUSED 16
+
+typedef struct ProcessorCacheKey {
+  /* Display transform, empty display for color space transforms. */
+  char look[MAX_COLORSPACE_NAME];
+  char view_transform[MAX_COLORSPACE_NAME];
+  char display[MAX_COLORSPACE_NAME];
+  float exposure;
+  float gamma;
+
+  char from_colorspace[MAX_COLORSPACE_NAME];
+  char to_colorspace[MAX_COLORSPACE_NAME];
+} ProcessorCacheKey;
+
+typedef struct ProcessorCacheEntry {
+  struct ProcessorCacheEntry *next, *prev;
+
+  ProcessorCacheKey key;
+  /* Can be NULL when the processor could not be created, so it's not retried. */
+  OCIO_ConstCPUProcessorRcPtr *cpu_processor;
+  int users;
+} ProcessorCacheEntry;
+
+static struct global_processor_cache {
+  /* Most recently used entries first. */
+  ListBase entries;
+  int tot_unused;
+} global_processor_cache = {{NULL}};
+
+static pthread_mutex_t processor_cache_lock = BLI_MUTEX_INITIALIZER;
+
+static void processor_cache_entry_free(ProcessorCacheEntry *entry)
+{
+  if (entry->cpu_processor) {
+    OCIO_cpuProcessorRelease(entry->cpu_processor);
+  }
+  MEM_freeN(entry);
+}
+
+/* Free least recently used entries, must be called with the cache locked. */
+static void processor_cache_trim(void)
+{
+  ProcessorCacheEntry *entry = global_processor_cache.entries.last;
+  while (entry && global_processor_cache.tot_unused > PROCESSOR_CACHE_MAX_UNUSED) {
+    ProcessorCacheEntry *entry_prev = entry->prev;
+    if (entry->users == 0) {
+      BLI_remlink(&global_processor_cache.entries, entry);
+      processor_cache_entry_free(entry);
+      global_processor_cache.tot_unused--;
+    }
+    entry = entry_prev;
+  }
+}
+
+/**
+ * Get the processor for \a key, creating it when it's not cached yet.
+ * The entry must be released with #processor_cache_release.
+ */
+static ProcessorCacheEntry *processor_cache_acquire(const ProcessorCacheKey *key)
+{
+  BLI_mutex_lock(&processor_cache_lock);
+
+  ProcessorCacheEntry *entry;
+  for (entry = global_processor_cache.entries.first; entry; entry = entry->next) {
+    if (memcmp(&entry->key, key, sizeof(ProcessorCacheKey)) == 0) {
+      break;
+    }
+  }
+
+  if (entry) {
+    BLI_remlink(&global_processor_cache.entries, entry);
+    if (entry->users == 0) {
+      global_processor_cache.tot_unused--;
+    }
+  }
+  else {
+    entry = MEM_callocN(sizeof(ProcessorCacheEntry), "colormanagement processor cache entry");
+    entry->key = *key;
+
+    if (key->display[0] != '\0') {
+      entry->cpu_processor = create_display_buffer_processor(key->look,
+                                                             key->view_transform,
+                                                             key->display,
+                                                             key->exposure,
+                                                             key->gamma,
+                                                             key->from_colorspace);
+    }
+    else {
+      OCIO_ConstProcessorRcPtr *processor = create_colorspace_transform_processor(
+          key->from_colorspace, key->to_colorspace);
+      if (processor != NULL) {
+        entry->cpu_processor = OCIO_processorGetCPUProcessor(processor);
+        OCIO_processorRelease(processor);
+      }
+    }
+  }
+
+  entry->users++;
+  BLI_addhead(&global_processor_cache.entries, entry);
+
+  BLI_mutex_unlock(&processor_cache_lock);
+
+  return entry;
+}
+
+static void processor_cache_release(ProcessorCacheEntry *entry)
+{
+  BLI_mutex_lock(&processor_cache_lock);
+
+  BLI_assert(entry->users > 0);
+  entry->users--;
+  if (entry->users == 0) {
+    global_processor_cache.tot_unused++;
+    processor_cache_trim();
+  }
+
+  BLI_mutex_unlock(&processor_cache_lock);
+}
+
+/* Processors depend on the configuration, the cache is cleared when it's freed. */
+static void processor_cache_free(void)
+{
+  BLI_mutex_lock(&processor_cache_lock);
+
+  LISTBASE_FOREACH_MUTABLE (ProcessorCacheEntry *, entry, &global_processor_cache.entries) {
+    BLI_assert(entry->users == 0);
+    processor_cache_entry_free(entry);
+  }
+  BLI_listbase_clear(&global_processor_cache.entries);
+  global_processor_cache.tot_unused = 0;
+
+  BLI_mutex_unlock(&processor_cache_lock);
+}
+
+/** \} */
+
+
 static OCIO_ConstCPUProcessorRcPtr *colorspace_to_scene_linear_cpu_processor(
     ColorSpace *colorspace)
 {
@@ -1420,6 +1573,15 @@ const float *IMB_colormangement_get_xyz_to_rgb()
 /** \name Threaded Display Buffer Transform Routines
  * \{ */
 
+/* Transforms run in parallel on bands of whole lines with about this many pixels, so that the
+ * amount of work per task doesn't depend on the image width. */
+#define COLORMANAGE_PIXELS_PER_TASK 65536
+
+static int colormanage_lines_per_task(const int width)
+{
+  return max_ii(COLORMANAGE_PIXELS_PER_TASK / max_ii(width, 1), 1);
+}
+
 typedef struct DisplayBufferThread {
   ColormanageProcessor *cm_processor;
 
@@ -1452,6 +1614,7 @@ typedef struct DisplayBufferInitData {
   unsigned char *display_buffer_byte;
 
   int width;
+  int lines_per_task;
 
   const char *byte_colorspace;
   const char *float_colorspace;
@@ -1679,6 +1842,19 @@ static void *do_display_buffer_apply_thread(void *handle_v)
   return NULL;
 }
 
+static void display_buffer_apply_task(void *__restrict userdata,
+                                      const int task_index,
+                                      const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  DisplayBufferInitData *init_data = (DisplayBufferInitData *)userdata;
+  const int start_line = task_index * init_data->lines_per_task;
+  const int tot_line = min_ii(init_data->lines_per_task, init_data->ibuf->y - start_line);
+
+  DisplayBufferThread handle;
+  display_buffer_init_handle(&handle, start_line, tot_line, init_data);
+  do_display_buffer_apply_thread(&handle);
+}
+
 static void display_buffer_apply_threaded(ImBuf *ibuf,
                                           const float *buffer,
                                           unsigned char *byte_buffer,
@@ -1713,11 +1889,13 @@ static void display_buffer_apply_threaded(ImBuf *ibuf,
     init_data.float_colorspace = NULL;
   }
 
-  IMB_processor_apply_threaded(ibuf->y,
-                               sizeof(DisplayBufferThread),
-                               &init_data,
-                               display_buffer_init_handle,
-                               do_display_buffer_apply_thread);
+  init_data.lines_per_task = colormanage_lines_per_task(ibuf->x);
+  const int tot_tasks = divide_ceil_u(ibuf->y, init_data.lines_per_task);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, tot_tasks, &init_data, display_buffer_apply_task, &settings);
 }
 
 static bool is_ibuf_rect_in_display_space(ImBuf *ibuf,
@@ -1811,6 +1989,7 @@ typedef struct ProcessorTransformInit {
   int width;
   int height;
   int channels;
+  int lines_per_task;
   bool predivide;
   bool float_from_byte;
 } ProcessorTransformInitData;
@@ -1891,6 +2070,19 @@ static void *do_processor_transform_thread(void *handle_v)
   return NULL;
 }
 
+static void processor_transform_apply_task(void *__restrict userdata,
+                                           const int task_index,
+                                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ProcessorTransformInitData *init_data = (ProcessorTransformInitData *)userdata;
+  const int start_line = task_index * init_data->lines_per_task;
+  const int tot_line = min_ii(init_data->lines_per_task, init_data->height - start_line);
+
+  ProcessorTransformThread handle;
+  processor_transform_init_handle(&handle, start_line, tot_line, init_data);
+  do_processor_transform_thread(&handle);
+}
+
 static void processor_transform_apply_threaded(unsigned char *byte_buffer,
                                                float *float_buffer,
                                                const int width,
@@ -1911,11 +2103,13 @@ static void processor_transform_apply_threaded(unsigned char *byte_buffer,
   init_data.predivide = predivide;
   init_data.float_from_byte = float_from_byte;
 
-  IMB_processor_apply_threaded(height,
-                               sizeof(ProcessorTransformThread),
-                               &init_data,
-                               processor_transform_init_handle,
-                               do_processor_transform_thread);
+  init_data.lines_per_task = colormanage_lines_per_task(width);
+  const int tot_tasks = divide_ceil_u(height, init_data.lines_per_task);
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, tot_tasks, &init_data, processor_transform_apply_task, &settings);
 }
 
 /** \} */
@@ -3772,13 +3966,18 @@ ColormanageProcessor *IMB_colormanagement_display_processor_new(
     cm_processor->is_data_result = display_space->is_data;
   }
 
-  cm_processor->cpu_processor = create_display_buffer_processor(
-      applied_view_settings->look,
-      applied_view_settings->view_transform,
-      display_settings->display_device,
-      applied_view_settings->exposure,
-      applied_view_settings->gamma,
-      global_role_scene_linear);
+  ProcessorCacheKey key;
+  memset(&key, 0, sizeof(key));
+  BLI_strncpy(key.look, applied_view_settings->look, sizeof(key.look));
+  BLI_strncpy(
+      key.view_transform, applied_view_settings->view_transform, sizeof(key.view_transform));
+  BLI_strncpy(key.display, display_settings->display_device, sizeof(key.display));
+  key.exposure = applied_view_settings->exposure;
+  key.gamma = applied_view_settings->gamma;
+  BLI_strncpy(key.from_colorspace, global_role_scene_linear, sizeof(key.from_colorspace));
+
+  cm_processor->cache_entry = processor_cache_acquire(&key);
+  cm_processor->cpu_processor = cm_processor->cache_entry->cpu_processor;
 
   if (applied_view_settings->flag & COLORMANAGE_VIEW_USE_CURVES) {
     cm_processor->curve_mapping = BKE_curvemapping_copy(applied_view_settings->curve_mapping);
@@ -3799,12 +3998,13 @@ ColormanageProcessor *IMB_colormanagement_colorspace_processor_new(const char *f
   color_space = colormanage_colorspace_get_named(to_colorspace);
   cm_processor->is_data_result = color_space->is_data;
 
-  OCIO_ConstProcessorRcPtr *processor = create_colorspace_transform_processor(from_colorspace,
-                                                                              to_colorspace);
-  if (processor != NULL) {
-    cm_processor->cpu_processor = OCIO_processorGetCPUProcessor(processor);
-  }
-  OCIO_processorRelease(processor);
+  ProcessorCacheKey key;
+  memset(&key, 0, sizeof(key));
+  BLI_strncpy(key.from_colorspace, from_colorspace, sizeof(key.from_colorspace));
+  BLI_strncpy(key.to_colorspace, to_colorspace, sizeof(key.to_colorspace));
+
+  cm_processor->cache_entry = processor_cache_acquire(&key);
+  cm_processor->cpu_processor = cm_processor->cache_entry->cpu_processor;
 
   return cm_processor;
 }
@@ -3930,8 +4130,8 @@ void IMB_colormanagement_processor_free(ColormanageProcessor *cm_processor)
   if (cm_processor->curve_mapping) {
     BKE_curvemapping_free(cm_processor->curve_mapping);
   }
-  if (cm_processor->cpu_processor) {
-    OCIO_cpuProcessorRelease(cm_processor->cpu_processor);
+  if (cm_processor->cache_entry) {
+    processor_cache_release(cm_processor->cache_entry);
   }
 
   MEM_freeN(cm_processor);
@@ -23,9 +23,13 @@
  */
 
 #include <math.h>
+#include <string.h>
 
+#include "BLI_math_base.h"
 #include "BLI_math_color.h"
 #include "BLI_math_interp.h"
+#include "BLI_math_vector.h"
+#include "BLI_simd.h"
 #include "BLI_utildefines.h"
 #include "MEM_guardedalloc.h"
 
@@ -908,712 +912,419 @@ static bool q_scale_linear_interpolation(struct ImBuf *ibuf, int newx, int newy)
   return true;
 }
 
-static ImBuf *scaledownx(struct ImBuf *ibuf, int newx)
+static void scalefast_Z_ImBuf(ImBuf *ibuf, int newx, int newy)
 {
-  const int do_rect = (ibuf->rect != NULL);
-  const int do_float = (ibuf->rect_float != NULL);
-  const size_t rect_size = ibuf->x * ibuf->y * 4;
-
-  uchar *rect, *_newrect, *newrect;
-  float *rectf, *_newrectf, *newrectf;
-  float sample, add, val[4], nval[4], valf[4], nvalf[4];
+  int *zbuf, *newzbuf, *_newzbuf = NULL;
+  float *zbuf_float, *newzbuf_float, *_newzbuf_float = NULL;
   int x, y;
+  int ofsx, ofsy, stepx, stepy;
 
-  rectf = _newrectf = newrectf = NULL;
-  rect = _newrect = newrect = NULL;
-  nval[0] = nval[1] = nval[2] = nval[3] = 0.0f;
-  nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
-
-  if (!do_rect && !do_float) {
-    return ibuf;
-  }
-
-  if (do_rect) {
-    _newrect = MEM_mallocN(sizeof(uchar[4]) * newx * ibuf->y, "scaledownx");
-    if (_newrect == NULL) {
-      return ibuf;
+  if (ibuf->zbuf) {
+    _newzbuf = MEM_mallocN(newx * newy * sizeof(int), __func__);
+    if (_newzbuf == NULL) {
+      IMB_freezbufImBuf(ibuf);
     }
   }
-  if (do_float) {
-    _newrectf = MEM_mallocN(sizeof(float[4]) * newx * ibuf->y, "scaledownxf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return ibuf;
+
+  if (ibuf->zbuf_float) {
+    _newzbuf_float = MEM_mallocN((size_t)newx * newy * sizeof(float), __func__);
+    if (_newzbuf_float == NULL) {
+      IMB_freezbuffloatImBuf(ibuf);
     }
   }
 
-  add = (ibuf->x - 0.01) / newx;
-
-  if (do_rect) {
-    rect = (uchar *)ibuf->rect;
-    newrect = _newrect;
-  }
-  if (do_float) {
-    rectf = ibuf->rect_float;
-    newrectf = _newrectf;
+  if (!_newzbuf && !_newzbuf_float) {
+    return;
   }
 
-  for (y = ibuf->y; y > 0; y--) {
-    sample = 0.0f;
-    val[0] = val[1] = val[2] = val[3] = 0.0f;
-    valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
-
-    for (x = newx; x > 0; x--) {
-      if (do_rect) {
-        nval[0] = -val[0] * sample;
-        nval[1] = -val[1] * sample;
-        nval[2] = -val[2] * sample;
-        nval[3] = -val[3] * sample;
-      }
-      if (do_float) {
-        nvalf[0] = -valf[0] * sample;
-        nvalf[1] = -valf[1] * sample;
-        nvalf[2] = -valf[2] * sample;
-        nvalf[3] = -valf[3] * sample;
-      }
+  stepx = round(65536.0 * (ibuf->x - 1.0) / (newx - 1.0));
+  stepy = round(65536.0 * (ibuf->y - 1.0) / (newy - 1.0));
+  ofsy = 32768;
 
-      sample += add;
-
-      while (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          nval[0] += rect[0];
-          nval[1] += rect[1];
-          nval[2] += rect[2];
-          nval[3] += rect[3];
-          rect += 4;
-        }
-        if (do_float) {
-          nvalf[0] += rectf[0];
-          nvalf[1] += rectf[1];
-          nvalf[2] += rectf[2];
-          nvalf[3] += rectf[3];
-          rectf += 4;
-        }
-      }
+  newzbuf = _newzbuf;
+  newzbuf_float = _newzbuf_float;
 
-      if (do_rect) {
-        val[0] = rect[0];
-        val[1] = rect[1];
-        val[2] = rect[2];
-        val[3] = rect[3];
-        rect += 4;
-
-        newrect[0] = roundf((nval[0] + sample * val[0]) / add);
-        newrect[1] = roundf((nval[1] + sample * val[1]) / add);
-        newrect[2] = roundf((nval[2] + sample * val[2]) / add);
-        newrect[3] = roundf((nval[3] + sample * val[3]) / add);
-
-        newrect += 4;
+  for (y = newy; y > 0; y--, ofsy += stepy) {
+    if (newzbuf) {
+      zbuf = ibuf->zbuf;
+      zbuf += (ofsy >> 16) * ibuf->x;
+      ofsx = 32768;
+      for (x = newx; x > 0; x--, ofsx += stepx) {
+        *newzbuf++ = zbuf[ofsx >> 16];
       }
-      if (do_float) {
-
-        valf[0] = rectf[0];
-        valf[1] = rectf[1];
-        valf[2] = rectf[2];
-        valf[3] = rectf[3];
-        rectf += 4;
-
-        newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-        newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-        newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-        newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
+    }
 
-        newrectf += 4;
+    if (newzbuf_float) {
+      zbuf_float = ibuf->zbuf_float;
+      zbuf_float += (ofsy >> 16) * ibuf->x;
+      ofsx = 32768;
+      for (x = newx; x > 0; x--, ofsx += stepx) {
+        *newzbuf_float++ = zbuf_float[ofsx >> 16];
       }
-
-      sample -= 1.0f;
     }
   }
 
-  if (do_rect) {
-    // printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-    BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug T26502. */
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
-  }
-  if (do_float) {
-    // printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-    BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug T26502. */
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = _newrectf;
+  if (_newzbuf) {
+    IMB_freezbufImBuf(ibuf);
+    ibuf->mall |= IB_zbuf;
+    ibuf->zbuf = _newzbuf;
   }
-  (void)rect_size; /* UNUSED in release builds */
 
-  ibuf->x = newx;
-  return ibuf;
+  if (_newzbuf_float) {
+    IMB_freezbuffloatImBuf(ibuf);
+    ibuf->mall |= IB_zbuffloat;
+    ibuf->zbuf_float = _newzbuf_float;
+  }
 }
 
-static ImBuf *scaledowny(struct ImBuf *ibuf, int newy)
+/* -------------------------------------------------------------------- */
+/** \name Filtered Scaling
+ *
+ * Separable resampling, the image is first scaled horizontally into a float buffer and then
+ * vertically into the final buffer. Both passes are multi-threaded over scan-lines. The filter
+ * weights of the source pixels contributing to an output pixel are computed once per axis.
+ * \{ */
+
+typedef struct ScaleFilterWeights {
+  /** First contributing source pixel of every output pixel. */
+  int *start;
+  /** Number of contributing source pixels of every output pixel. */
+  int *count;
+  /** Normalized weights, `max_count` per output pixel. */
+  float *weights;
+  int max_count;
+} ScaleFilterWeights;
+
+static float scale_filter_support(const eIMBScaleFilter filter)
 {
-  const int do_rect = (ibuf->rect != NULL);
-  const int do_float = (ibuf->rect_float != NULL);
-  const size_t rect_size = ibuf->x * ibuf->y * 4;
-
-  uchar *rect, *_newrect, *newrect;
-  float *rectf, *_newrectf, *newrectf;
-  float sample, add, val[4], nval[4], valf[4], nvalf[4];
-  int x, y, skipx;
-
-  rectf = _newrectf = newrectf = NULL;
-  rect = _newrect = newrect = NULL;
-  nval[0] = nval[1] = nval[2] = nval[3] = 0.0f;
-  nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
-
-  if (!do_rect && !do_float) {
-    return ibuf;
-  }
+  switch (filter) {
+    case IMB_SCALE_FILTER_BOX:
+      return 0.5f;
+    case IMB_SCALE_FILTER_BILINEAR:
+      return 1.0f;
+    case IMB_SCALE_FILTER_LANCZOS:
+      return 3.0f;
+  }
+  BLI_assert_unreachable();
+  return 1.0f;
+}
 
-  if (do_rect) {
-    _newrect = MEM_mallocN(sizeof(uchar[4]) * newy * ibuf->x, "scaledowny");
-    if (_newrect == NULL) {
-      return ibuf;
-    }
-  }
-  if (do_float) {
-    _newrectf = MEM_mallocN(sizeof(float[4]) * newy * ibuf->x, "scaledownyf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
+static float scale_filter_eval(const eIMBScaleFilter filter, float x)
+{
+  switch (filter) {
+    case IMB_SCALE_FILTER_BOX:
+      /* Weighted by the covered area instead, see #scale_filter_weights_init. */
+      break;
+    case IMB_SCALE_FILTER_BILINEAR:
+      x = fabsf(x);
+      return (x < 1.0f) ? 1.0f - x : 0.0f;
+    case IMB_SCALE_FILTER_LANCZOS: {
+      x = fabsf(x);
+      if (x < 1e-6f) {
+        return 1.0f;
+      }
+      if (x >= 3.0f) {
+        return 0.0f;
       }
-      return ibuf;
+      const float pix = (float)M_PI * x;
+      return 3.0f * sinf(pix) * sinf(pix / 3.0f) / (pix * pix);
     }
   }
+  BLI_assert_unreachable();
+  return 0.0f;
+}
 
-  add = (ibuf->y - 0.01) / newy;
-  skipx = 4 * ibuf->x;
-
-  for (x = skipx - 4; x >= 0; x -= 4) {
-    if (do_rect) {
-      rect = ((uchar *)ibuf->rect) + x;
-      newrect = _newrect + x;
-    }
-    if (do_float) {
-      rectf = ibuf->rect_float + x;
-      newrectf = _newrectf + x;
-    }
-
-    sample = 0.0f;
-    val[0] = val[1] = val[2] = val[3] = 0.0f;
-    valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
-
-    for (y = newy; y > 0; y--) {
-      if (do_rect) {
-        nval[0] = -val[0] * sample;
-        nval[1] = -val[1] * sample;
-        nval[2] = -val[2] * sample;
-        nval[3] = -val[3] * sample;
-      }
-      if (do_float) {
-        nvalf[0] = -valf[0] * sample;
-        nvalf[1] = -valf[1] * sample;
-        nvalf[2] = -valf[2] * sample;
-        nvalf[3] = -valf[3] * sample;
+static void scale_filter_weights_init(ScaleFilterWeights *fw,
+                                      const eIMBScaleFilter filter,
+                                      const int src_size,
+                                      const int dst_size)
+{
+  const float scale = (float)src_size / (float)dst_size;
+  /* When shrinking the filter is widened, so that every source pixel contributes. */
+  const float filter_scale = max_ff(scale, 1.0f);
+  const float support = scale_filter_support(filter) * filter_scale;
+
+  fw->max_count = (int)ceilf(support) * 2 + 1;
+  fw->start = MEM_mallocN(sizeof(int) * dst_size, __func__);
+  fw->count = MEM_mallocN(sizeof(int) * dst_size, __func__);
+  fw->weights = MEM_mallocN(sizeof(float) * fw->max_count * dst_size, __func__);
+
+  for (int i = 0; i < dst_size; i++) {
+    const float center = ((float)i + 0.5f) * scale;
+    float *weights = fw->weights + (size_t)i * fw->max_count;
+    float total = 0.0f;
+    int start, end;
+
+    if (filter == IMB_SCALE_FILTER_BOX) {
+      /* Every source pixel is weighted by the part of it that is covered by the output pixel, so
+       * partially covered pixels at the borders contribute their share. */
+      const float x_min = (float)i * scale;
+      const float x_max = (float)(i + 1) * scale;
+      start = max_ii((int)floorf(x_min), 0);
+      end = min_iii((int)ceilf(x_max), src_size, start + fw->max_count);
+      for (int j = start; j < end; j++) {
+        const float weight = max_ff(min_ff(x_max, (float)(j + 1)) - max_ff(x_min, (float)j), 0.0f);
+        weights[j - start] = weight;
+        total += weight;
       }
-
-      sample += add;
-
-      while (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          nval[0] += rect[0];
-          nval[1] += rect[1];
-          nval[2] += rect[2];
-          nval[3] += rect[3];
-          rect += skipx;
-        }
-        if (do_float) {
-          nvalf[0] += rectf[0];
-          nvalf[1] += rectf[1];
-          nvalf[2] += rectf[2];
-          nvalf[3] += rectf[3];
-          rectf += skipx;
-        }
+    }
+    else {
+      start = max_ii((int)floorf(center - support + 0.5f), 0);
+      end = min_iii((int)floorf(center + support + 0.5f), src_size, start + fw->max_count);
+      for (int j = start; j < end; j++) {
+        const float weight = scale_filter_eval(filter, ((float)j + 0.5f - center) / filter_scale);
+        weights[j - start] = weight;
+        total += weight;
       }
+    }
 
-      if (do_rect) {
-        val[0] = rect[0];
-        val[1] = rect[1];
-        val[2] = rect[2];
-        val[3] = rect[3];
-        rect += skipx;
-
-        newrect[0] = roundf((nval[0] + sample * val[0]) / add);
-        newrect[1] = roundf((nval[1] + sample * val[1]) / add);
-        newrect[2] = roundf((nval[2] + sample * val[2]) / add);
-        newrect[3] = roundf((nval[3] + sample * val[3]) / add);
-
-        newrect += skipx;
+    if (total > 0.0f) {
+      for (int j = start; j < end; j++) {
+        weights[j - start] /= total;
       }
-      if (do_float) {
-
-        valf[0] = rectf[0];
-        valf[1] = rectf[1];
-        valf[2] = rectf[2];
-        valf[3] = rectf[3];
-        rectf += skipx;
-
-        newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-        newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-        newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-        newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
+      fw->start[i] = start;
+      fw->count[i] = end - start;
+    }
+    else {
+      /* Only happens due to precision issues, use the nearest pixel. */
+      fw->start[i] = min_ii((int)center, src_size - 1);
+      fw->count[i] = 1;
+      weights[0] = 1.0f;
+    }
+  }
+}
 
-        newrectf += skipx;
-      }
+static void scale_filter_weights_free(ScaleFilterWeights *fw)
+{
+  MEM_freeN(fw->start);
+  MEM_freeN(fw->count);
+  MEM_freeN(fw->weights);
+}
 
-      sample -= 1.0f;
+/** Weighted sum of \a count neighboring pixels of a float buffer. */
+BLI_INLINE void scale_filter_pixel_float(float *out,
+                                         const float *in,
+                                         const float *weights,
+                                         const int count,
+                                         const int channels)
+{
+#ifdef BLI_HAVE_SSE2
+  if (channels == 4) {
+    __m128 sum = _mm_setzero_ps();
+    for (int i = 0; i < count; i++, in += 4) {
+      sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[i]), _mm_loadu_ps(in)));
     }
+    _mm_storeu_ps(out, sum);
+    return;
   }
-
-  if (do_rect) {
-    // printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-    BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug T26502. */
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
+#endif
+  for (int c = 0; c < channels; c++) {
+    out[c] = 0.0f;
   }
-  if (do_float) {
-    // printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-    BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug T26502. */
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
+  for (int i = 0; i < count; i++, in += channels) {
+    for (int c = 0; c < channels; c++) {
+      out[c] += weights[i] * in[c];
+    }
   }
-  (void)rect_size; /* UNUSED in release builds */
-
-  ibuf->y = newy;
-  return ibuf;
 }
 
-static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
+/** Weighted sum of \a count neighboring pixels of a byte buffer, in the [0, 255] range. */
+BLI_INLINE void scale_filter_pixel_byte(float out[4],
+                                        const uchar *in,
+                                        const float *weights,
+                                        const int count)
 {
-  uchar *rect, *_newrect = NULL, *newrect;
-  float *rectf, *_newrectf = NULL, *newrectf;
-  float sample, add;
-  float val_a, nval_a, diff_a;
-  float val_b, nval_b, diff_b;
-  float val_g, nval_g, diff_g;
-  float val_r, nval_r, diff_r;
-  float val_af, nval_af, diff_af;
-  float val_bf, nval_bf, diff_bf;
-  float val_gf, nval_gf, diff_gf;
-  float val_rf, nval_rf, diff_rf;
-  int x, y;
-  bool do_rect = false, do_float = false;
-
-  val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-  val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-  val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-  val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
-  if (ibuf == NULL) {
-    return NULL;
-  }
-  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
-    return ibuf;
-  }
+#ifdef BLI_HAVE_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  __m128 sum = _mm_setzero_ps();
+  for (int i = 0; i < count; i++, in += 4) {
+    int packed;
+    memcpy(&packed, in, sizeof(packed));
+    const __m128i bytes = _mm_cvtsi32_si128(packed);
+    const __m128i ints = _mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, zero), zero);
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[i]), _mm_cvtepi32_ps(ints)));
+  }
+  _mm_storeu_ps(out, sum);
+#else
+  zero_v4(out);
+  for (int i = 0; i < count; i++, in += 4) {
+    out[0] += weights[i] * in[0];
+    out[1] += weights[i] * in[1];
+    out[2] += weights[i] * in[2];
+    out[3] += weights[i] * in[3];
+  }
+#endif
+}
 
-  if (ibuf->rect) {
-    do_rect = true;
-    _newrect = MEM_mallocN(newx * ibuf->y * sizeof(int), "scaleupx");
-    if (_newrect == NULL) {
-      return ibuf;
+/** Weighted sum of \a count rows of \a row_len floats, stored one after the other. */
+static void scale_filter_row(float *out,
+                             const float *in,
+                             const size_t row_len,
+                             const float *weights,
+                             const int count)
+{
+  size_t i = 0;
+#ifdef BLI_HAVE_SSE2
+  for (; i + 4 <= row_len; i += 4) {
+    __m128 sum = _mm_setzero_ps();
+    for (int j = 0; j < count; j++) {
+      const __m128 value = _mm_loadu_ps(in + j * row_len + i);
+      sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[j]), value));
     }
+    _mm_storeu_ps(out + i, sum);
   }
-  if (ibuf->rect_float) {
-    do_float = true;
-    _newrectf = MEM_mallocN(sizeof(float[4]) * newx * ibuf->y, "scaleupxf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return ibuf;
+#endif
+  for (; i < row_len; i++) {
+    float sum = 0.0f;
+    for (int j = 0; j < count; j++) {
+      sum += weights[j] * in[j * row_len + i];
     }
+    out[i] = sum;
   }
+}
 
-  add = (ibuf->x - 1.001) / (newx - 1.0);
-
-  rect = (uchar *)ibuf->rect;
-  rectf = (float *)ibuf->rect_float;
-  newrect = _newrect;
-  newrectf = _newrectf;
-
-  for (y = ibuf->y; y > 0; y--) {
-
-    sample = 0;
-
-    if (do_rect) {
-      val_a = rect[0];
-      nval_a = rect[4];
-      diff_a = nval_a - val_a;
-      val_a += 0.5f;
-
-      val_b = rect[1];
-      nval_b = rect[5];
-      diff_b = nval_b - val_b;
-      val_b += 0.5f;
-
-      val_g = rect[2];
-      nval_g = rect[6];
-      diff_g = nval_g - val_g;
-      val_g += 0.5f;
-
-      val_r = rect[3];
-      nval_r = rect[7];
-      diff_r = nval_r - val_r;
-      val_r += 0.5f;
-
-      rect += 8;
-    }
-    if (do_float) {
-      val_af = rectf[0];
-      nval_af = rectf[4];
-      diff_af = nval_af - val_af;
-
-      val_bf = rectf[1];
-      nval_bf = rectf[5];
-      diff_bf = nval_bf - val_bf;
-
-      val_gf = rectf[2];
-      nval_gf = rectf[6];
-      diff_gf = nval_gf - val_gf;
-
-      val_rf = rectf[3];
-      nval_rf = rectf[7];
-      diff_rf = nval_rf - val_rf;
-
-      rectf += 8;
-    }
-    for (x = newx; x > 0; x--) {
-      if (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          val_a = nval_a;
-          nval_a = rect[0];
-          diff_a = nval_a - val_a;
-          val_a += 0.5f;
-
-          val_b = nval_b;
-          nval_b = rect[1];
-          diff_b = nval_b - val_b;
-          val_b += 0.5f;
-
-          val_g = nval_g;
-          nval_g = rect[2];
-          diff_g = nval_g - val_g;
-          val_g += 0.5f;
-
-          val_r = nval_r;
-          nval_r = rect[3];
-          diff_r = nval_r - val_r;
-          val_r += 0.5f;
-          rect += 4;
-        }
-        if (do_float) {
-          val_af = nval_af;
-          nval_af = rectf[0];
-          diff_af = nval_af - val_af;
-
-          val_bf = nval_bf;
-          nval_bf = rectf[1];
-          diff_bf = nval_bf - val_bf;
-
-          val_gf = nval_gf;
-          nval_gf = rectf[2];
-          diff_gf = nval_gf - val_gf;
-
-          val_rf = nval_rf;
-          nval_rf = rectf[3];
-          diff_rf = nval_rf - val_rf;
-          rectf += 4;
-        }
-      }
-      if (do_rect) {
-        newrect[0] = val_a + sample * diff_a;
-        newrect[1] = val_b + sample * diff_b;
-        newrect[2] = val_g + sample * diff_g;
-        newrect[3] = val_r + sample * diff_r;
-        newrect += 4;
+typedef struct ScaleFilterData {
+  const ScaleFilterWeights *weights_x;
+  const ScaleFilterWeights *weights_y;
+  int oldx;
+  int newx;
+  int channels;
+
+  /** Source buffer, either byte or float. */
+  const uchar *src_byte;
+  const float *src_float;
+  /** Horizontally scaled image of `newx * oldy` pixels. */
+  float *tmp;
+  /** Destination buffer, either byte or float. */
+  uchar *dst_byte;
+  float *dst_float;
+} ScaleFilterData;
+
+static void scale_filter_x_thread_do(void *data_v, int start_line, int tot_line)
+{
+  ScaleFilterData *data = (ScaleFilterData *)data_v;
+  const ScaleFilterWeights *fw = data->weights_x;
+  const int channels = data->channels;
+
+  for (int y = start_line; y < start_line + tot_line; y++) {
+    float *out = data->tmp + (size_t)y * data->newx * channels;
+    const size_t src_offset = (size_t)y * data->oldx * channels;
+
+    for (int x = 0; x < data->newx; x++, out += channels) {
+      const size_t offset = src_offset + (size_t)fw->start[x] * channels;
+      const float *weights = fw->weights + (size_t)x * fw->max_count;
+      if (data->src_float) {
+        scale_filter_pixel_float(out, data->src_float + offset, weights, fw->count[x], channels);
       }
-      if (do_float) {
-        newrectf[0] = val_af + sample * diff_af;
-        newrectf[1] = val_bf + sample * diff_bf;
-        newrectf[2] = val_gf + sample * diff_gf;
-        newrectf[3] = val_rf + sample * diff_rf;
-        newrectf += 4;
+      else {
+        scale_filter_pixel_byte(out, data->src_byte + offset, weights, fw->count[x]);
       }
-      sample += add;
     }
   }
+}
 
-  if (do_rect) {
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
-  }
-  if (do_float) {
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
+static void scale_filter_y_thread_do(void *data_v, int start_line, int tot_line)
+{
+  ScaleFilterData *data = (ScaleFilterData *)data_v;
+  const ScaleFilterWeights *fw = data->weights_y;
+  const size_t row_len = (size_t)data->newx * data->channels;
+  float *row = data->dst_byte ? MEM_mallocN(sizeof(float) * row_len, __func__) : NULL;
+
+  for (int y = start_line; y < start_line + tot_line; y++) {
+    float *out = row ? row : data->dst_float + (size_t)y * row_len;
+    const float *weights = fw->weights + (size_t)y * fw->max_count;
+    scale_filter_row(out, data->tmp + fw->start[y] * row_len, row_len, weights, fw->count[y]);
+
+    if (data->dst_byte) {
+      uchar *out_byte = data->dst_byte + (size_t)y * row_len;
+      for (size_t i = 0; i < row_len; i++) {
+        out_byte[i] = (uchar)clamp_i((int)(row[i] + 0.5f), 0, 255);
+      }
+    }
   }
 
-  ibuf->x = newx;
-  return ibuf;
+  MEM_SAFE_FREE(row);
+}
+
+static void scale_filter_buffer(ScaleFilterData *data, const int oldy, const int newy)
+{
+  data->tmp = MEM_mallocN(sizeof(float) * data->channels * data->newx * oldy, __func__);
+  IMB_processor_apply_threaded_scanlines(oldy, scale_filter_x_thread_do, data);
+  IMB_processor_apply_threaded_scanlines(newy, scale_filter_y_thread_do, data);
+  MEM_freeN(data->tmp);
 }
 
-static ImBuf *scaleupy(struct ImBuf *ibuf, int newy)
+static bool imb_scale_filtered(struct ImBuf *ibuf,
+                               unsigned int newx,
+                               unsigned int newy,
+                               const eIMBScaleFilter filter_x,
+                               const eIMBScaleFilter filter_y)
 {
-  uchar *rect, *_newrect = NULL, *newrect;
-  float *rectf, *_newrectf = NULL, *newrectf;
-  float sample, add;
-  float val_a, nval_a, diff_a;
-  float val_b, nval_b, diff_b;
-  float val_g, nval_g, diff_g;
-  float val_r, nval_r, diff_r;
-  float val_af, nval_af, diff_af;
-  float val_bf, nval_bf, diff_bf;
-  float val_gf, nval_gf, diff_gf;
-  float val_rf, nval_rf, diff_rf;
-  int x, y, skipx;
-  bool do_rect = false, do_float = false;
-
-  val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-  val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-  val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-  val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
   if (ibuf == NULL) {
-    return NULL;
+    return false;
   }
   if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
-    return ibuf;
+    return false;
   }
 
-  if (ibuf->rect) {
-    do_rect = true;
-    _newrect = MEM_mallocN(ibuf->x * newy * sizeof(int), "scaleupy");
-    if (_newrect == NULL) {
-      return ibuf;
-    }
+  /* Zero keeps the size of an axis. */
+  if (newx == 0) {
+    newx = ibuf->x;
   }
-  if (ibuf->rect_float) {
-    do_float = true;
-    _newrectf = MEM_mallocN(sizeof(float[4]) * ibuf->x * newy, "scaleupyf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return ibuf;
-    }
+  if (newy == 0) {
+    newy = ibuf->y;
+  }
+  if (newx == ibuf->x && newy == ibuf->y) {
+    return false;
   }
 
-  add = (ibuf->y - 1.001) / (newy - 1.0);
-  skipx = 4 * ibuf->x;
-
-  rect = (uchar *)ibuf->rect;
-  rectf = (float *)ibuf->rect_float;
-  newrect = _newrect;
-  newrectf = _newrectf;
-
-  for (x = ibuf->x; x > 0; x--) {
-
-    sample = 0;
-    if (do_rect) {
-      rect = ((uchar *)ibuf->rect) + 4 * (x - 1);
-      newrect = _newrect + 4 * (x - 1);
-
-      val_a = rect[0];
-      nval_a = rect[skipx];
-      diff_a = nval_a - val_a;
-      val_a += 0.5f;
-
-      val_b = rect[1];
-      nval_b = rect[skipx + 1];
-      diff_b = nval_b - val_b;
-      val_b += 0.5f;
-
-      val_g = rect[2];
-      nval_g = rect[skipx + 2];
-      diff_g = nval_g - val_g;
-      val_g += 0.5f;
-
-      val_r = rect[3];
-      nval_r = rect[skipx + 3];
-      diff_r = nval_r - val_r;
-      val_r += 0.5f;
-
-      rect += 2 * skipx;
-    }
-    if (do_float) {
-      rectf = ibuf->rect_float + 4 * (x - 1);
-      newrectf = _newrectf + 4 * (x - 1);
-
-      val_af = rectf[0];
-      nval_af = rectf[skipx];
-      diff_af = nval_af - val_af;
-
-      val_bf = rectf[1];
-      nval_bf = rectf[skipx + 1];
-      diff_bf = nval_bf - val_bf;
-
-      val_gf = rectf[2];
-      nval_gf = rectf[skipx + 2];
-      diff_gf = nval_gf - val_gf;
+  /* Scale the Z-buffer (if any) first, it uses the current size. */
+  scalefast_Z_ImBuf(ibuf, newx, newy);
 
-      val_rf = rectf[3];
-      nval_rf = rectf[skipx + 3];
-      diff_rf = nval_rf - val_rf;
+  ScaleFilterWeights weights_x, weights_y;
+  scale_filter_weights_init(&weights_x, filter_x, ibuf->x, newx);
+  scale_filter_weights_init(&weights_y, filter_y, ibuf->y, newy);
 
-      rectf += 2 * skipx;
-    }
+  ScaleFilterData data = {NULL};
+  data.weights_x = &weights_x;
+  data.weights_y = &weights_y;
+  data.oldx = ibuf->x;
+  data.newx = newx;
 
-    for (y = newy; y > 0; y--) {
-      if (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          val_a = nval_a;
-          nval_a = rect[0];
-          diff_a = nval_a - val_a;
-          val_a += 0.5f;
-
-          val_b = nval_b;
-          nval_b = rect[1];
-          diff_b = nval_b - val_b;
-          val_b += 0.5f;
-
-          val_g = nval_g;
-          nval_g = rect[2];
-          diff_g = nval_g - val_g;
-          val_g += 0.5f;
-
-          val_r = nval_r;
-          nval_r = rect[3];
-          diff_r = nval_r - val_r;
-          val_r += 0.5f;
-          rect += skipx;
-        }
-        if (do_float) {
-          val_af = nval_af;
-          nval_af = rectf[0];
-          diff_af = nval_af - val_af;
-
-          val_bf = nval_bf;
-          nval_bf = rectf[1];
-          diff_bf = nval_bf - val_bf;
-
-          val_gf = nval_gf;
-          nval_gf = rectf[2];
-          diff_gf = nval_gf - val_gf;
-
-          val_rf = nval_rf;
-          nval_rf = rectf[3];
-          diff_rf = nval_rf - val_rf;
-          rectf += skipx;
-        }
-      }
-      if (do_rect) {
-        newrect[0] = val_a + sample * diff_a;
-        newrect[1] = val_b + sample * diff_b;
-        newrect[2] = val_g + sample * diff_g;
-        newrect[3] = val_r + sample * diff_r;
-        newrect += skipx;
-      }
-      if (do_float) {
-        newrectf[0] = val_af + sample * diff_af;
-        newrectf[1] = val_bf + sample * diff_bf;
-        newrectf[2] = val_gf + sample * diff_gf;
-        newrectf[3] = val_rf + sample * diff_rf;
-        newrectf += skipx;
-      }
-      sample += add;
-    }
-  }
+  if (ibuf->rect) {
+    data.channels = 4;
+    data.src_byte = (const uchar *)ibuf->rect;
+    data.dst_byte = MEM_mallocN(sizeof(uchar[4]) * newx * newy, "scale filtered byte buffer");
+    scale_filter_buffer(&data, ibuf->y, newy);
 
-  if (do_rect) {
     imb_freerectImBuf(ibuf);
     ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
+    ibuf->rect = (unsigned int *)data.dst_byte;
+    data.src_byte = NULL;
+    data.dst_byte = NULL;
   }
-  if (do_float) {
+
+  if (ibuf->rect_float) {
+    data.channels = ibuf->channels;
+    data.src_float = ibuf->rect_float;
+    data.dst_float = MEM_mallocN(sizeof(float) * ibuf->channels * newx * newy,
+                                 "scale filtered float buffer");
+    scale_filter_buffer(&data, ibuf->y, newy);
+
     imb_freerectfloatImBuf(ibuf);
     ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
+    ibuf->rect_float = data.dst_float;
   }
 
+  scale_filter_weights_free(&weights_x);
+  scale_filter_weights_free(&weights_y);
+
+  ibuf->x = newx;
   ibuf->y = newy;
-  return ibuf;
+  return true;
 }
 
-static void scalefast_Z_ImBuf(ImBuf *ibuf, int newx, int newy)
-{
-  int *zbuf, *newzbuf, *_newzbuf = NULL;
-  float *zbuf_float, *newzbuf_float, *_newzbuf_float = NULL;
-  int x, y;
-  int ofsx, ofsy, stepx, stepy;
-
-  if (ibuf->zbuf) {
-    _newzbuf = MEM_mallocN(newx * newy * sizeof(int), __func__);
-    if (_newzbuf == NULL) {
-      IMB_freezbufImBuf(ibuf);
-    }
-  }
-
-  if (ibuf->zbuf_float) {
-    _newzbuf_float = MEM_mallocN((size_t)newx * newy * sizeof(float), __func__);
-    if (_newzbuf_float == NULL) {
-      IMB_freezbuffloatImBuf(ibuf);
-    }
-  }
-
-  if (!_newzbuf && !_newzbuf_float) {
-    return;
-  }
-
-  stepx = round(65536.0 * (ibuf->x - 1.0) / (newx - 1.0));
-  stepy = round(65536.0 * (ibuf->y - 1.0) / (newy - 1.0));
-  ofsy = 32768;
-
-  newzbuf = _newzbuf;
-  newzbuf_float = _newzbuf_float;
-
-  for (y = newy; y > 0; y--, ofsy += stepy) {
-    if (newzbuf) {
-      zbuf = ibuf->zbuf;
-      zbuf += (ofsy >> 16) * ibuf->x;
-      ofsx = 32768;
-      for (x = newx; x > 0; x--, ofsx += stepx) {
-        *newzbuf++ = zbuf[ofsx >> 16];
-      }
-    }
-
-    if (newzbuf_float) {
-      zbuf_float = ibuf->zbuf_float;
-      zbuf_float += (ofsy >> 16) * ibuf->x;
-      ofsx = 32768;
-      for (x = newx; x > 0; x--, ofsx += stepx) {
-        *newzbuf_float++ = zbuf_float[ofsx >> 16];
-      }
-    }
-  }
-
-  if (_newzbuf) {
-    IMB_freezbufImBuf(ibuf);
-    ibuf->mall |= IB_zbuf;
-    ibuf->zbuf = _newzbuf;
-  }
-
-  if (_newzbuf_float) {
-    IMB_freezbuffloatImBuf(ibuf);
-    ibuf->mall |= IB_zbuffloat;
-    ibuf->zbuf_float = _newzbuf_float;
-  }
-}
+/** \} */
 
 /**
  * Return true if \a ibuf is modified.
@@ -1623,17 +1334,6 @@ bool IMB_scaleImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy)
   if (ibuf == NULL) {
     return false;
   }
-  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
-    return false;
-  }
-
-  if (newx == ibuf->x && newy == ibuf->y) {
-    return false;
-  }
-
-  /* Scale-up / scale-down functions below change ibuf->x and ibuf->y
-   * so we first scale the Z-buffer (if any). */
-  scalefast_Z_ImBuf(ibuf, newx, newy);
 
   /* try to scale common cases in a fast way */
   /* disabled, quality loss is unacceptable, see report T18609  (ton) */
@@ -1641,20 +1341,23 @@ bool IMB_scaleImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy)
     return true;
   }
 
-  if (newx && (newx < ibuf->x)) {
-    scaledownx(ibuf, newx);
-  }
-  if (newy && (newy < ibuf->y)) {
-    scaledowny(ibuf, newy);
-  }
-  if (newx && (newx > ibuf->x)) {
-    scaleupx(ibuf, newx);
-  }
-  if (newy && (newy > ibuf->y)) {
-    scaleupy(ibuf, newy);
-  }
+  /* Average the covered pixels when shrinking and interpolate linearly when enlarging. */
+  const eIMBScaleFilter filter_x = (newx < ibuf->x) ? IMB_SCALE_FILTER_BOX :
+                                                      IMB_SCALE_FILTER_BILINEAR;
+  const eIMBScaleFilter filter_y = (newy < ibuf->y) ? IMB_SCALE_FILTER_BOX :
+                                                      IMB_SCALE_FILTER_BILINEAR;
+  return imb_scale_filtered(ibuf, newx, newy, filter_x, filter_y);
+}
 
-  return true;
+/**
+ * Return true if \a ibuf is modified.
+ */
+bool IMB_scaleImBuf_filtered(struct ImBuf *ibuf,
+                             unsigned int newx,
+                             unsigned int newy,
+                             const eIMBScaleFilter filter)
+{
+  return imb_scale_filtered(ibuf, newx, newy, filter, filter);
 }
 
 struct imbufRGBA {
@@ -1760,119 +1463,7 @@ bool IMB_scalefastImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy
   return true;
 }
 
-/* ******** threaded scaling ******** */
-
-typedef struct ScaleTreadInitData {
-  ImBuf *ibuf;
-
-  unsigned int newx;
-  unsigned int newy;
-
-  unsigned char *byte_buffer;
-  float *float_buffer;
-} ScaleTreadInitData;
-
-typedef struct ScaleThreadData {
-  ImBuf *ibuf;
-
-  unsigned int newx;
-  unsigned int newy;
-
-  int start_line;
-  int tot_line;
-
-  unsigned char *byte_buffer;
-  float *float_buffer;
-} ScaleThreadData;
-
-static void scale_thread_init(void *data_v, int start_line, int tot_line, void *init_data_v)
-{
-  ScaleThreadData *data = (ScaleThreadData *)data_v;
-  ScaleTreadInitData *init_data = (ScaleTreadInitData *)init_data_v;
-
-  data->ibuf = init_data->ibuf;
-
-  data->newx = init_data->newx;
-  data->newy = init_data->newy;
-
-  data->start_line = start_line;
-  data->tot_line = tot_line;
-
-  data->byte_buffer = init_data->byte_buffer;
-  data->float_buffer = init_data->float_buffer;
-}
-
-static void *do_scale_thread(void *data_v)
-{
-  ScaleThreadData *data = (ScaleThreadData *)data_v;
-  ImBuf *ibuf = data->ibuf;
-  int i;
-  float factor_x = (float)ibuf->x / data->newx;
-  float factor_y = (float)ibuf->y / data->newy;
-
-  for (i = 0; i < data->tot_line; i++) {
-    int y = data->start_line + i;
-    int x;
-
-    for (x = 0; x < data->newx; x++) {
-      float u = (float)x * factor_x;
-      float v = (float)y * factor_y;
-      int offset = y * data->newx + x;
-
-      if (data->byte_buffer) {
-        unsigned char *pixel = data->byte_buffer + 4 * offset;
-        BLI_bilinear_interpolation_char(
-            (unsigned char *)ibuf->rect, pixel, ibuf->x, ibuf->y, 4, u, v);
-      }
-
-      if (data->float_buffer) {
-        float *pixel = data->float_buffer + ibuf->channels * offset;
-        BLI_bilinear_interpolation_fl(
-            ibuf->rect_float, pixel, ibuf->x, ibuf->y, ibuf->channels, u, v);
-      }
-    }
-  }
-
-  return NULL;
-}
-
 void IMB_scaleImBuf_threaded(ImBuf *ibuf, unsigned int newx, unsigned int newy)
 {
-  ScaleTreadInitData init_data = {NULL};
-
-  /* prepare initialization data */
-  init_data.ibuf = ibuf;
-
-  init_data.newx = newx;
-  init_data.newy = newy;
-
-  if (ibuf->rect) {
-    init_data.byte_buffer = MEM_mallocN(4 * newx * newy * sizeof(char),
-                                        "threaded scale byte buffer");
-  }
-
-  if (ibuf->rect_float) {
-    init_data.float_buffer = MEM_mallocN(ibuf->channels * newx * newy * sizeof(float),
-                                         "threaded scale float buffer");
-  }
-
-  /* actual scaling threads */
-  IMB_processor_apply_threaded(
-      newy, sizeof(ScaleThreadData), &init_data, scale_thread_init, do_scale_thread);
-
-  /* alter image buffer */
-  ibuf->x = newx;
-  ibuf->y = newy;
-
-  if (ibuf->rect) {
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)init_data.byte_buffer;
-  }
-
-  if (ibuf->rect_float) {
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = init_data.float_buffer;
-  }
+  IMB_scaleImBuf_filtered(ibuf, newx, newy, IMB_SCALE_FILTER_BILINEAR);
 }
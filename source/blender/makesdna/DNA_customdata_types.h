@@ -53,6 +53,11 @@ typedef struct CustomDataLayer {
   char name[64];
   /** Layer data. */
   void *data;
+  /**
+   * Run-time shared ownership of `data` with layers of other #CustomData,
+   * NULL when the data is owned exclusively. See #CD_SHARE.
+   */
+  struct CustomDataLayerSharing *sharing;
 } CustomDataLayer;
 
 #define MAX_CUSTOMDATA_LAYER_NAME 64
@@ -110,6 +110,14 @@ void *DNA_struct_reconstruct(const struct DNA_ReconstructInfo *reconstruct_info,
                              int old_struct_nr,
                              int blocks,
                              const void *old_blocks);
+int DNA_struct_reconstruct_block_size(const struct DNA_ReconstructInfo *reconstruct_info,
+                                      int old_struct_nr);
+void DNA_struct_reconstruct_range(const struct DNA_ReconstructInfo *reconstruct_info,
+                                  int old_struct_nr,
+                                  int first_block,
+                                  int blocks,
+                                  const void *old_blocks,
+                                  void *new_blocks);
 
 int DNA_elem_offset(struct SDNA *sdna, const char *stype, const char *vartype, const char *name);
 
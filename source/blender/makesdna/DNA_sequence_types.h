@@ -281,6 +281,9 @@ typedef struct Editing {
   /* Cache control */
   float recycle_max_cost; /* UNUSED only for versioning. */
   int cache_flag;
+  /** Number of frames rendered in parallel when prefetching, 0 for automatic. */
+  int prefetch_workers;
+  char _pad[4];
 
   struct PrefetchJob *prefetch_job;
 
@@ -646,7 +646,9 @@ typedef struct UserDef_Experimental {
   char use_sculpt_tools_tilt;
   char use_asset_browser;
   char use_override_templates;
-  char _pad[6];
+  char use_geometry_nodes_multithreading;
+  char use_geometry_nodes_cache;
+  char _pad[4];
   /** `makesdna` does not allow empty structs. */
 } UserDef_Experimental;
 
@@ -794,7 +796,8 @@ typedef struct UserDef {
   int prefetchframes;
   /** Control the rotation step of the view when PAD2, PAD4, PAD6&PAD8 is use. */
   float pad_rot_angle;
-  char _pad12[4];
+  /** Size limit of the geometry nodes output cache in megabytes. */
+  int geometry_nodes_cache_limit;
   /** Rotating view icon size. */
   short rvisize;
   /** Rotating view icon brightness. */
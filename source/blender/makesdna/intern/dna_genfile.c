@@ -1241,6 +1241,23 @@ void *DNA_struct_reconstruct(const DNA_ReconstructInfo *reconstruct_info,
                              int old_struct_nr,
                              int blocks,
                              const void *old_blocks)
+{
+  const int new_block_size = DNA_struct_reconstruct_block_size(reconstruct_info, old_struct_nr);
+  if (new_block_size == 0) {
+    return NULL;
+  }
+
+  char *new_blocks = MEM_callocN(blocks * new_block_size, "reconstruct");
+  DNA_struct_reconstruct_range(reconstruct_info, old_struct_nr, 0, blocks, old_blocks, new_blocks);
+  return new_blocks;
+}
+
+/**
+ * \return The size of a single reconstructed struct in the new SDNA,
+ * or zero when the struct does not exist there.
+ */
+int DNA_struct_reconstruct_block_size(const DNA_ReconstructInfo *reconstruct_info,
+                                      int old_struct_nr)
 {
   const SDNA *oldsdna = reconstruct_info->oldsdna;
   const SDNA *newsdna = reconstruct_info->newsdna;
@@ -1250,16 +1267,45 @@ void *DNA_struct_reconstruct(const DNA_ReconstructInfo *reconstruct_info,
   const int new_struct_nr = DNA_struct_find_nr(newsdna, type_name);
 
   if (new_struct_nr == -1) {
-    return NULL;
+    return 0;
   }
+  return newsdna->types_size[newsdna->structs[new_struct_nr]->type];
+}
 
-  const SDNA_Struct *new_struct = newsdna->structs[new_struct_nr];
-  const int new_block_size = newsdna->types_size[new_struct->type];
+/**
+ * Reconstructs the array elements in `[first_block, first_block + blocks)` only. This allows
+ * converting large arrays from multiple threads, since different ranges can be reconstructed
+ * independently.
+ *
+ * \param old_blocks: The entire array of struct data.
+ * \param new_blocks: Zero initialized memory for the entire reconstructed array,
+ * see #DNA_struct_reconstruct_block_size.
+ */
+void DNA_struct_reconstruct_range(const DNA_ReconstructInfo *reconstruct_info,
+                                  int old_struct_nr,
+                                  int first_block,
+                                  int blocks,
+                                  const void *old_blocks,
+                                  void *new_blocks)
+{
+  const SDNA *oldsdna = reconstruct_info->oldsdna;
+  const SDNA *newsdna = reconstruct_info->newsdna;
 
-  char *new_blocks = MEM_callocN(blocks * new_block_size, "reconstruct");
-  reconstruct_structs(
-      reconstruct_info, blocks, old_struct_nr, new_struct_nr, old_blocks, new_blocks);
-  return new_blocks;
+  const SDNA_Struct *old_struct = oldsdna->structs[old_struct_nr];
+  const char *type_name = oldsdna->types[old_struct->type];
+  const int new_struct_nr = DNA_struct_find_nr(newsdna, type_name);
+  BLI_assert(new_struct_nr != -1);
+
+  const SDNA_Struct *new_struct = newsdna->structs[new_struct_nr];
+  const size_t old_block_size = (size_t)oldsdna->types_size[old_struct->type];
+  const size_t new_block_size = (size_t)newsdna->types_size[new_struct->type];
+
+  reconstruct_structs(reconstruct_info,
+                      blocks,
+                      old_struct_nr,
+                      new_struct_nr,
+                      (const char *)old_blocks + (size_t)first_block * old_block_size,
+                      (char *)new_blocks + (size_t)first_block * new_block_size);
 }
 
 /** Finds a member in the given struct with the given name. */
@@ -269,6 +269,18 @@ static void rna_Depsgraph_debug_stats(Depsgraph *depsgraph, char *result)
                outer);
 }
 
+static void rna_Depsgraph_debug_scheduling(Depsgraph *depsgraph, int threads, char *result)
+{
+  double time_in_order, time_critical_path;
+  DEG_debug_scheduling_simulate(depsgraph, threads, &time_in_order, &time_critical_path);
+  BLI_snprintf(result,
+               STATS_MAX_SIZE,
+               "%d Threads: %.3f ms in order, %.3f ms by critical path",
+               threads,
+               time_in_order * 1000.0,
+               time_critical_path * 1000.0);
+}
+
 static void rna_Depsgraph_update(Depsgraph *depsgraph, Main *bmain, ReportList *reports)
 {
   if (DEG_is_evaluating(depsgraph)) {
@@ -674,6 +686,17 @@ static void rna_def_depsgraph(BlenderRNA *brna)
   RNA_def_parameter_flags(parm, PROP_THICK_WRAP, 0); /* needed for string return value */
   RNA_def_function_output(func, parm);
 
+  func = RNA_def_function(srna, "debug_scheduling", "rna_Depsgraph_debug_scheduling");
+  RNA_def_function_ui_description(
+      func,
+      "Compare scheduling policies by simulating evaluation of the Dependency Graph with the "
+      "timing recorded in previous evaluations");
+  parm = RNA_def_int(func, "threads", 8, 1, 1024, "Threads", "Number of simulated threads", 1, 64);
+  RNA_def_parameter_flags(parm, 0, PARM_REQUIRED);
+  parm = RNA_def_string(func, "result", NULL, STATS_MAX_SIZE, "result", "");
+  RNA_def_parameter_flags(parm, PROP_THICK_WRAP, 0); /* needed for string return value */
+  RNA_def_function_output(func, parm);
+
   /* Updates. */
 
   func = RNA_def_function(srna, "update", "rna_Depsgraph_update");
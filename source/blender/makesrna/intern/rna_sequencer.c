@@ -53,6 +53,7 @@
 #include "SEQ_prefetch.h"
 #include "SEQ_proxy.h"
 #include "SEQ_relations.h"
+#include "SEQ_render.h"
 #include "SEQ_sequencer.h"
 #include "SEQ_sound.h"
 #include "SEQ_time.h"
@@ -2102,6 +2103,14 @@ static void rna_def_editor(BlenderRNA *brna)
       "Prefetch Frames",
       "Render frames ahead of current frame in the background for faster playback");
   RNA_def_property_update(prop, NC_SCENE | ND_SEQUENCER, NULL);
+
+  prop = RNA_def_property(srna, "prefetch_workers", PROP_INT, PROP_NONE);
+  RNA_def_property_range(prop, 0, SEQ_PREFETCH_WORKERS_MAX);
+  RNA_def_property_ui_text(prop,
+                           "Prefetch Workers",
+                           "Number of frames rendered in parallel when prefetching, 0 to use half "
+                           "of the available CPU threads");
+  RNA_def_property_update(prop, NC_SCENE | ND_SEQUENCER, NULL);
 }
 
 static void rna_def_filter_video(StructRNA *srna)
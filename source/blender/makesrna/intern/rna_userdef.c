@@ -198,6 +198,8 @@ static const EnumPropertyItem rna_enum_userdef_viewport_aa_items[] = {
 #  include "BLI_path_util.h"
 
 #  include "MEM_CacheLimiterC-Api.h"
+
+#  include "MOD_nodes.h"
 #  include "MEM_guardedalloc.h"
 
 #  include "UI_interface.h"
@@ -573,6 +575,15 @@ static void rna_Userdef_memcache_update(Main *UNUSED(bmain),
   USERDEF_TAG_DIRTY;
 }
 
+static void rna_Userdef_geometry_nodes_cache_update(Main *UNUSED(bmain),
+                                                    Scene *UNUSED(scene),
+                                                    PointerRNA *UNUSED(ptr))
+{
+  /* Stored node outputs are not used anymore or might not fit into the new limit. */
+  MOD_nodes_cache_free();
+  USERDEF_TAG_DIRTY;
+}
+
 static void rna_Userdef_disk_cache_dir_update(Main *UNUSED(bmain),
                                               Scene *UNUSED(scene),
                                               PointerRNA *UNUSED(ptr))
@@ -5430,6 +5441,15 @@ static void rna_def_userdef_system(BlenderRNA *brna)
   RNA_def_property_ui_text(prop, "Memory Cache Limit", "Memory cache limit (in megabytes)");
   RNA_def_property_update(prop, 0, "rna_Userdef_memcache_update");
 
+  prop = RNA_def_property(srna, "geometry_nodes_cache_limit", PROP_INT, PROP_NONE);
+  RNA_def_property_int_sdna(prop, NULL, "geometry_nodes_cache_limit");
+  RNA_def_property_range(prop, 1, max_memory_in_megabytes_int());
+  RNA_def_property_ui_text(prop,
+                           "Geometry Nodes Cache Limit",
+                           "Memory limit for node outputs kept between geometry nodes evaluations "
+                           "(in megabytes)");
+  RNA_def_property_update(prop, 0, "rna_Userdef_geometry_nodes_cache_update");
+
   /* Sequencer disk cache */
 
   prop = RNA_def_property(srna, "use_sequencer_disk_cache", PROP_BOOLEAN, PROP_NONE);
@@ -6305,6 +6325,20 @@ static void rna_def_userdef_experimental(BlenderRNA *brna)
   RNA_def_property_boolean_sdna(prop, NULL, "use_override_templates", 1);
   RNA_def_property_ui_text(
       prop, "Override Templates", "Enable library override template in the python API");
+
+  prop = RNA_def_property(srna, "use_geometry_nodes_multithreading", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "use_geometry_nodes_multithreading", 1);
+  RNA_def_property_ui_text(prop,
+                           "Geometry Nodes Multi-threading",
+                           "Evaluate independent branches of geometry node trees in parallel");
+
+  prop = RNA_def_property(srna, "use_geometry_nodes_cache", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "use_geometry_nodes_cache", 1);
+  RNA_def_property_ui_text(prop,
+                           "Geometry Nodes Cache",
+                           "Keep node outputs between geometry nodes evaluations, so that only "
+                           "nodes that changed have to be evaluated again");
+  RNA_def_property_update(prop, 0, "rna_Userdef_geometry_nodes_cache_update");
 }
 
 static void rna_def_userdef_addon_collection(BlenderRNA *brna, PropertyRNA *cprop)
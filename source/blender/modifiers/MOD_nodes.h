@@ -28,6 +28,9 @@ void MOD_nodes_update_interface(struct Object *object, struct NodesModifierData
 
 void MOD_nodes_init(struct Main *bmain, struct NodesModifierData *nmd);
 
+/** Free all node outputs stored in the geometry nodes cache. */
+void MOD_nodes_cache_free(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -21,8 +21,11 @@
  * \ingroup modifiers
  */
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <mutex>
 #include <string>
 
 #include "MEM_guardedalloc.h"
@@ -31,7 +34,10 @@
 #include "BLI_listbase.h"
 #include "BLI_multi_value_map.hh"
 #include "BLI_set.hh"
+#include "BLI_stack.hh"
 #include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_timeit.hh"
 #include "BLI_utildefines.h"
 
 #include "DNA_collection_types.h"
@@ -45,6 +51,7 @@
 #include "DNA_scene_types.h"
 #include "DNA_screen_types.h"
 #include "DNA_space_types.h"
+#include "DNA_userdef_types.h"
 #include "DNA_windowmanager_types.h"
 
 #include "BKE_customdata.h"
@@ -75,6 +82,7 @@
 
 #include "MOD_modifiertypes.h"
 #include "MOD_nodes.h"
+#include "MOD_nodes_cache.hh"
 #include "MOD_ui_common.h"
 
 #include "ED_spreadsheet.h"
@@ -92,6 +100,7 @@ using blender::IndexRange;
 using blender::Map;
 using blender::Set;
 using blender::Span;
+using blender::Stack;
 using blender::StringRef;
 using blender::StringRefNull;
 using blender::Vector;
@@ -101,6 +110,7 @@ using blender::bke::PersistentObjectHandle;
 using blender::fn::GMutablePointer;
 using blender::fn::GPointer;
 using blender::fn::GValueMap;
+using blender::modifiers::geometry_nodes::cache_key_combine;
 using blender::nodes::GeoNodeExecParams;
 using namespace blender::fn::multi_function_types;
 using namespace blender::nodes::derived_node_tree_types;
@@ -271,9 +281,33 @@ static bool isDisabled(const struct Scene *UNUSED(scene),
   return false;
 }
 
+class GeometryNodesEvaluator;
+
+/**
+ * State of a single node when the node tree is evaluated as a task graph. A node is scheduled
+ * once all nodes it depends on have been executed.
+ */
+struct NodeTask {
+  DNode node;
+  GeometryNodesEvaluator *evaluator;
+  /* Number of nodes that still have to be executed before this node can run. */
+  std::atomic<int> num_dependencies_pending = 0;
+  /* Nodes that use at least one output of this node. */
+  Vector<NodeTask *> dependent_tasks;
+  /* True when the outputs have been found in the cache, in which case the node is not executed
+   * and #cached_outputs is forwarded instead. */
+  bool use_cached_outputs = false;
+  Vector<GMutablePointer> cached_outputs;
+  /* Every task has its own allocator, so that nodes can be executed on different threads. Values
+   * allocated here have to stay alive until the evaluation finished, because they are forwarded
+   * to other nodes. */
+  blender::LinearAllocator<> allocator;
+};
+
 class GeometryNodesEvaluator {
  public:
   using LogSocketValueFn = std::function<void(DSocket, Span<GPointer>)>;
+  using NodeTiming = std::pair<DNode, blender::timeit::Nanoseconds>;
 
  private:
   blender::LinearAllocator<> allocator_;
@@ -287,6 +321,29 @@ class GeometryNodesEvaluator {
   Depsgraph *depsgraph_;
   LogSocketValueFn log_socket_value_fn_;
 
+  /* When true, independent nodes are executed in parallel. Otherwise the inputs of the group
+   * outputs are computed recursively on the calling thread. */
+  bool use_task_graph_;
+  Vector<std::unique_ptr<NodeTask>> node_tasks_;
+  /* Protects #value_by_input_ when nodes are executed in parallel. */
+  std::mutex value_by_input_mutex_;
+  /* The logging callback is not thread-safe. */
+  std::mutex log_mutex_;
+
+  bool use_timing_;
+  Vector<NodeTiming> node_timings_;
+  std::mutex node_timings_mutex_;
+
+  /* When true, node outputs are stored in and retrieved from the persistent output cache. */
+  bool use_cache_;
+  /* Cache keys of the values passed into the node group and of the nodes that have been checked
+   * so far. None when the value depends on data that is not included in the key, like other
+   * objects. */
+  Map<DOutputSocket, std::optional<uint64_t>> group_input_keys_;
+  Map<DNode, std::optional<uint64_t>> node_keys_;
+  uint64_t key_seed_;
+  std::atomic<int> cached_nodes_num_ = 0;
+
  public:
   GeometryNodesEvaluator(const Map<DOutputSocket, GMutablePointer> &group_input_data,
                          Vector<DInputSocket> group_outputs,
@@ -295,7 +352,10 @@ class GeometryNodesEvaluator {
                          const Object *self_object,
                          const ModifierData *modifier,
                          Depsgraph *depsgraph,
-                         LogSocketValueFn log_socket_value_fn)
+                         LogSocketValueFn log_socket_value_fn,
+                         const bool use_task_graph,
+                         const bool use_timing,
+                         const bool use_cache)
       : group_outputs_(std::move(group_outputs)),
         mf_by_node_(mf_by_node),
         conversions_(blender::nodes::get_implicit_type_conversions()),
@@ -303,19 +363,34 @@ class GeometryNodesEvaluator {
         self_object_(self_object),
         modifier_(modifier),
         depsgraph_(depsgraph),
-        log_socket_value_fn_(std::move(log_socket_value_fn))
+        log_socket_value_fn_(std::move(log_socket_value_fn)),
+        use_task_graph_(use_task_graph),
+        use_timing_(use_timing),
+        use_cache_(use_cache)
   {
+    if (use_cache_) {
+      /* Some nodes behave differently for viewport and render evaluation. */
+      key_seed_ = blender::get_default_hash(DEG_get_mode(depsgraph));
+      for (auto item : group_input_data.items()) {
+        group_input_keys_.add_new(item.key, group_input_cache_key(item.value));
+      }
+    }
     for (auto item : group_input_data.items()) {
       this->log_socket_value(item.key, item.value);
-      this->forward_to_inputs(item.key, item.value);
+      this->forward_to_inputs(item.key, item.value, allocator_);
     }
   }
 
   Vector<GMutablePointer> execute()
   {
+    if (use_task_graph_) {
+      this->execute_task_graph();
+    }
+
+    /* When the task graph has been executed, all values are available already. */
     Vector<GMutablePointer> results;
     for (const DInputSocket &group_output : group_outputs_) {
-      Vector<GMutablePointer> result = this->get_input_values(group_output);
+      Vector<GMutablePointer> result = this->get_input_values(group_output, allocator_);
       this->log_socket_value(group_output, result);
       results.append(result[0]);
     }
@@ -325,8 +400,134 @@ class GeometryNodesEvaluator {
     return results;
   }
 
+  /**
+   * Print how long every executed node took, sorted by duration. Only available when the
+   * evaluator was created with timing enabled.
+   */
+  void print_timings(StringRef label, const blender::timeit::Nanoseconds total_duration) const
+  {
+    BLI_assert(use_timing_);
+    Vector<NodeTiming> timings = node_timings_;
+    std::sort(timings.begin(), timings.end(), [](const NodeTiming &a, const NodeTiming &b) {
+      return a.second > b.second;
+    });
+    blender::timeit::Nanoseconds nodes_duration{0};
+    for (const NodeTiming &timing : timings) {
+      nodes_duration += timing.second;
+    }
+
+    std::cout << "Geometry Nodes '" << label << "' ("
+              << (use_task_graph_ ? "task graph" : "serial") << "): " << timings.size()
+              << " nodes, ";
+    blender::timeit::print_duration(total_duration);
+    std::cout << " total, ";
+    blender::timeit::print_duration(nodes_duration);
+    std::cout << " in nodes";
+    if (use_cache_) {
+      std::cout << ", " << cached_nodes_num_ << " nodes from cache";
+    }
+    std::cout << "\n";
+    for (const NodeTiming &timing : timings) {
+      const DNode node = timing.first;
+      std::cout << "  ";
+      blender::timeit::print_duration(timing.second);
+      std::cout << "  " << node->tree().name() << " / " << node->name() << "\n";
+    }
+  }
+
  private:
-  Vector<GMutablePointer> get_input_values(const DInputSocket socket_to_compute)
+  /**
+   * Find all nodes that have to be executed to compute the group outputs and run them in a task
+   * pool. A node is pushed to the pool as soon as the last node it depends on is done, so
+   * independent branches of the tree are evaluated in parallel.
+   */
+  void execute_task_graph()
+  {
+    Map<DNode, NodeTask *> task_by_node;
+    Set<DOutputSocket> handled_unavailable_outputs;
+    Stack<NodeTask *> tasks_to_check;
+
+    auto add_dependencies = [&](const DInputSocket socket, NodeTask *user_task) {
+      socket.foreach_origin_socket([&](const DSocket origin_socket) {
+        if (origin_socket->is_input()) {
+          /* Unlinked input, its value is computed when the node is executed. */
+          return;
+        }
+        const DOutputSocket origin_output{origin_socket};
+        if (value_by_input_.contains(std::make_pair(socket, origin_output))) {
+          /* Group inputs have been forwarded already. */
+          return;
+        }
+        if (!origin_output->is_available()) {
+          if (handled_unavailable_outputs.add(origin_output)) {
+            this->forward_default_value(origin_output, allocator_);
+          }
+          return;
+        }
+        const DNode origin_node = origin_output.node();
+        NodeTask *origin_task = task_by_node.lookup_or_add_cb(origin_node, [&]() {
+          node_tasks_.append(std::make_unique<NodeTask>());
+          NodeTask *task = node_tasks_.last().get();
+          task->node = origin_node;
+          task->evaluator = this;
+          if (this->lookup_cached_outputs(origin_node, task->allocator, task->cached_outputs)) {
+            /* The inputs of the node are not needed. */
+            task->use_cached_outputs = true;
+          }
+          else {
+            tasks_to_check.push(task);
+          }
+          return task;
+        });
+        if (user_task != nullptr && !origin_task->dependent_tasks.contains(user_task)) {
+          origin_task->dependent_tasks.append(user_task);
+          user_task->num_dependencies_pending++;
+        }
+      });
+    };
+
+    for (const DInputSocket &group_output : group_outputs_) {
+      add_dependencies(group_output, nullptr);
+    }
+    while (!tasks_to_check.is_empty()) {
+      NodeTask *task = tasks_to_check.pop();
+      for (const InputSocketRef *input_socket : task->node->inputs()) {
+        if (input_socket->is_available()) {
+          add_dependencies({task->node.context(), input_socket}, task);
+        }
+      }
+    }
+
+    TaskPool *task_pool = BLI_task_pool_create_suspended(this, TASK_PRIORITY_HIGH);
+    for (std::unique_ptr<NodeTask> &task : node_tasks_) {
+      if (task->num_dependencies_pending == 0) {
+        BLI_task_pool_push(task_pool, node_task_run, task.get(), false, nullptr);
+      }
+    }
+    BLI_task_pool_work_and_wait(task_pool);
+    BLI_task_pool_free(task_pool);
+  }
+
+  static void node_task_run(TaskPool *__restrict pool, void *taskdata)
+  {
+    NodeTask &task = *(NodeTask *)taskdata;
+    if (task.use_cached_outputs) {
+      task.evaluator->forward_node_outputs(task.node, task.cached_outputs, task.allocator);
+    }
+    else {
+      task.evaluator->compute_node_and_forward(task.node, task.allocator);
+    }
+
+    for (NodeTask *dependent_task : task.dependent_tasks) {
+      BLI_assert(dependent_task->num_dependencies_pending > 0);
+      if (dependent_task->num_dependencies_pending.fetch_sub(1) == 1) {
+        BLI_task_pool_push(pool, node_task_run, dependent_task, false, nullptr);
+      }
+    }
+  }
+
+  Vector<GMutablePointer> get_input_values(const DInputSocket socket_to_compute,
+                                           blender::LinearAllocator<> &allocator)
   {
     Vector<DSocket> from_sockets;
     socket_to_compute.foreach_origin_socket([&](DSocket socket) { from_sockets.append(socket); });
@@ -334,35 +535,38 @@ class GeometryNodesEvaluator {
     if (from_sockets.is_empty()) {
       /* The input is not connected, use the value from the socket itself. */
       const CPPType &type = *blender::nodes::socket_cpp_type_get(*socket_to_compute->typeinfo());
-      return {get_unlinked_input_value(socket_to_compute, type)};
+      return {get_unlinked_input_value(socket_to_compute, type, allocator)};
     }
 
     /* Multi-input sockets contain a vector of inputs. */
     if (socket_to_compute->is_multi_input_socket()) {
-      return this->get_inputs_from_incoming_links(socket_to_compute, from_sockets);
+      return this->get_inputs_from_incoming_links(socket_to_compute, from_sockets, allocator);
     }
 
     const DSocket from_socket = from_sockets[0];
-    GMutablePointer value = this->get_input_from_incoming_link(socket_to_compute, from_socket);
+    GMutablePointer value = this->get_input_from_incoming_link(
+        socket_to_compute, from_socket, allocator);
     return {value};
   }
 
   Vector<GMutablePointer> get_inputs_from_incoming_links(const DInputSocket socket_to_compute,
-                                                         const Span<DSocket> from_sockets)
+                                                         const Span<DSocket> from_sockets,
+                                                         blender::LinearAllocator<> &allocator)
   {
     Vector<GMutablePointer> values;
     for (const int i : from_sockets.index_range()) {
       const DSocket from_socket = from_sockets[i];
       const int first_occurence = from_sockets.take_front(i).first_index_try(from_socket);
       if (first_occurence == -1) {
-        values.append(this->get_input_from_incoming_link(socket_to_compute, from_socket));
+        values.append(
+            this->get_input_from_incoming_link(socket_to_compute, from_socket, allocator));
       }
       else {
         /* If the same from-socket occurs more than once, we make a copy of the first value. This
          * can happen when a node linked to a multi-input-socket is muted. */
         GMutablePointer value = values[first_occurence];
         const CPPType *type = value.type();
-        void *copy_buffer = allocator_.allocate(type->size(), type->alignment());
+        void *copy_buffer = allocator.allocate(type->size(), type->alignment());
         type->copy_to_uninitialized(value.get(), copy_buffer);
         values.append({type, copy_buffer});
       }
@@ -371,12 +575,19 @@ class GeometryNodesEvaluator {
   }
 
   GMutablePointer get_input_from_incoming_link(const DInputSocket socket_to_compute,
-                                               const DSocket from_socket)
+                                               const DSocket from_socket,
+                                               blender::LinearAllocator<> &allocator)
   {
     if (from_socket->is_output()) {
       const DOutputSocket from_output_socket{from_socket};
       const std::pair<DInputSocket, DOutputSocket> key = std::make_pair(socket_to_compute,
                                                                         from_output_socket);
+      if (use_task_graph_) {
+        /* All nodes this node depends on have been executed before. */
+        std::lock_guard lock{value_by_input_mutex_};
+        return {value_by_input_.pop(key)};
+      }
+
       std::optional<GMutablePointer> value = value_by_input_.pop_try(key);
       if (value.has_value()) {
         /* This input has been computed before, return it directly. */
@@ -391,33 +602,48 @@ class GeometryNodesEvaluator {
     /* Get value from an unlinked input socket. */
     const CPPType &type = *blender::nodes::socket_cpp_type_get(*socket_to_compute->typeinfo());
     const DInputSocket from_input_socket{from_socket};
-    return {get_unlinked_input_value(from_input_socket, type)};
+    return {get_unlinked_input_value(from_input_socket, type, allocator)};
   }
 
   void compute_output_and_forward(const DOutputSocket socket_to_compute)
   {
-    const DNode node{socket_to_compute.context(), &socket_to_compute->node()};
-
     if (!socket_to_compute->is_available()) {
       /* If the output is not available, use a default value. */
-      const CPPType &type = *blender::nodes::socket_cpp_type_get(*socket_to_compute->typeinfo());
-      void *buffer = allocator_.allocate(type.size(), type.alignment());
-      type.copy_to_uninitialized(type.default_value(), buffer);
-      this->forward_to_inputs(socket_to_compute, {type, buffer});
+      this->forward_default_value(socket_to_compute, allocator_);
+      return;
+    }
+
+    const DNode node{socket_to_compute.context(), &socket_to_compute->node()};
+    Vector<GMutablePointer> cached_outputs;
+    if (this->lookup_cached_outputs(node, allocator_, cached_outputs)) {
+      /* The node and everything it depends on does not have to be computed. */
+      this->forward_node_outputs(node, cached_outputs, allocator_);
       return;
     }
+    this->compute_node_and_forward(node, allocator_);
+  }
+
+  void forward_default_value(const DOutputSocket socket, blender::LinearAllocator<> &allocator)
+  {
+    const CPPType &type = *blender::nodes::socket_cpp_type_get(*socket->typeinfo());
+    void *buffer = allocator.allocate(type.size(), type.alignment());
+    type.copy_to_uninitialized(type.default_value(), buffer);
+    this->forward_to_inputs(socket, {type, buffer}, allocator);
+  }
 
+  void compute_node_and_forward(const DNode node, blender::LinearAllocator<> &allocator)
+  {
     /* Prepare inputs required to execute the node. */
-    GValueMap<StringRef> node_inputs_map{allocator_};
+    GValueMap<StringRef> node_inputs_map{allocator};
     for (const InputSocketRef *input_socket : node->inputs()) {
       if (input_socket->is_available()) {
         DInputSocket dsocket{node.context(), input_socket};
-        Vector<GMutablePointer> values = this->get_input_values(dsocket);
+        Vector<GMutablePointer> values = this->get_input_values(dsocket, allocator);
         this->log_socket_value(dsocket, values);
         for (int i = 0; i < values.size(); ++i) {
           /* Values from Multi Input Sockets are stored in input map with the format
            * <identifier>[<index>]. */
-          blender::StringRefNull key = allocator_.copy_string(
+          blender::StringRefNull key = allocator.copy_string(
               input_socket->identifier() + (i > 0 ? ("[" + std::to_string(i)) + "]" : ""));
           node_inputs_map.add_new_direct(key, std::move(values[i]));
         }
@@ -425,26 +651,203 @@ class GeometryNodesEvaluator {
     }
 
     /* Execute the node. */
-    GValueMap<StringRef> node_outputs_map{allocator_};
+    GValueMap<StringRef> node_outputs_map{allocator};
     GeoNodeExecParams params{
         node, node_inputs_map, node_outputs_map, handle_map_, self_object_, modifier_, depsgraph_};
-    this->execute_node(node, params);
+    if (use_timing_) {
+      const blender::timeit::TimePoint start = blender::timeit::Clock::now();
+      this->execute_node(node, params, allocator);
+      const blender::timeit::TimePoint end = blender::timeit::Clock::now();
+      std::lock_guard lock{node_timings_mutex_};
+      node_timings_.append({node, end - start});
+    }
+    else {
+      this->execute_node(node, params, allocator);
+    }
+
+    Vector<GMutablePointer> output_values;
+    for (const OutputSocketRef *output_socket : node->outputs()) {
+      if (output_socket->is_available()) {
+        output_values.append(node_outputs_map.extract(output_socket->identifier()));
+      }
+    }
+    if (use_cache_) {
+      if (const std::optional<uint64_t> key = this->node_cache_key(node)) {
+        blender::modifiers::geometry_nodes::node_output_cache_add(*key, output_values);
+      }
+    }
 
-    /* Forward computed outputs to linked input sockets. */
+    this->forward_node_outputs(node, output_values, allocator);
+  }
+
+  /**
+   * Forward computed outputs to linked input sockets. The values are expected to be in the order
+   * of the available output sockets.
+   */
+  void forward_node_outputs(const DNode node,
+                            Span<GMutablePointer> values,
+                            blender::LinearAllocator<> &allocator)
+  {
+    int value_index = 0;
     for (const OutputSocketRef *output_socket : node->outputs()) {
       if (output_socket->is_available()) {
         const DOutputSocket dsocket{node.context(), output_socket};
-        GMutablePointer value = node_outputs_map.extract(output_socket->identifier());
+        GMutablePointer value = values[value_index++];
         this->log_socket_value(dsocket, value);
-        this->forward_to_inputs(dsocket, value);
+        this->forward_to_inputs(dsocket, value, allocator);
       }
     }
   }
 
+  bool lookup_cached_outputs(const DNode node,
+                             blender::LinearAllocator<> &allocator,
+                             Vector<GMutablePointer> &r_values)
+  {
+    if (!use_cache_) {
+      return false;
+    }
+    const std::optional<uint64_t> key = this->node_cache_key(node);
+    if (!key) {
+      return false;
+    }
+    if (!blender::modifiers::geometry_nodes::node_output_cache_lookup(*key, allocator, r_values)) {
+      return false;
+    }
+    cached_nodes_num_++;
+    return true;
+  }
+
+  /**
+   * The key of a node is computed from its type, its settings and the keys of all its inputs. It
+   * does not depend on where the node is in the tree, so equal nodes with equal inputs share
+   * their cached outputs.
+   *
+   * \note In task graph mode, the keys of all nodes have to be computed before the tasks run.
+   */
+  std::optional<uint64_t> node_cache_key(const DNode node)
+  {
+    if (const std::optional<uint64_t> *key = node_keys_.lookup_ptr(node)) {
+      return *key;
+    }
+    const std::optional<uint64_t> key = this->compute_node_cache_key(node);
+    node_keys_.add_new(node, key);
+    return key;
+  }
+
+  std::optional<uint64_t> compute_node_cache_key(const DNode node)
+  {
+    const bNode &bnode = *node->bnode();
+    if (bnode.id != nullptr) {
+      /* The node uses another data-block, e.g. a texture. */
+      return std::nullopt;
+    }
+    uint64_t key = cache_key_combine(key_seed_, blender::get_default_hash(node->idname()));
+    key = cache_key_combine(key, blender::get_default_hash(bnode.type));
+    key = cache_key_combine(key, blender::get_default_hash(bnode.custom1));
+    key = cache_key_combine(key, blender::get_default_hash(bnode.custom2));
+    key = cache_key_combine(key, blender::get_default_hash(bnode.custom3));
+    key = cache_key_combine(key, blender::get_default_hash(bnode.custom4));
+    const std::optional<uint64_t> storage_hash =
+        blender::modifiers::geometry_nodes::node_storage_hash(bnode);
+    if (!storage_hash) {
+      return std::nullopt;
+    }
+    key = cache_key_combine(key, *storage_hash);
+    for (const InputSocketRef *input_socket : node->inputs()) {
+      if (input_socket->is_available()) {
+        const std::optional<uint64_t> input_key = this->input_cache_key(
+            {node.context(), input_socket});
+        if (!input_key) {
+          return std::nullopt;
+        }
+        /* The index makes sure that swapping the values of two inputs changes the key. */
+        key = cache_key_combine(key, blender::get_default_hash(input_socket->index()));
+        key = cache_key_combine(key, *input_key);
+      }
+    }
+    return key;
+  }
+
+  std::optional<uint64_t> input_cache_key(const DInputSocket socket)
+  {
+    Vector<DSocket> from_sockets;
+    socket.foreach_origin_socket([&](DSocket from_socket) { from_sockets.append(from_socket); });
+    if (from_sockets.is_empty()) {
+      return this->unlinked_input_cache_key(socket);
+    }
+
+    /* Values are converted to the type of the socket. */
+    uint64_t key = blender::get_default_hash(socket->typeinfo()->type);
+    for (const DSocket from_socket : from_sockets) {
+      std::optional<uint64_t> from_key;
+      if (from_socket->is_input()) {
+        from_key = this->unlinked_input_cache_key(DInputSocket(from_socket));
+      }
+      else {
+        const DOutputSocket from_output_socket{from_socket};
+        if (const std::optional<uint64_t> *group_input_key = group_input_keys_.lookup_ptr(
+                from_output_socket)) {
+          from_key = *group_input_key;
+        }
+        else if (!from_output_socket->is_available()) {
+          /* The default value is used. */
+          from_key = blender::get_default_hash(from_output_socket->typeinfo()->type);
+        }
+        else if (const std::optional<uint64_t> node_key = this->node_cache_key(
+                     from_output_socket.node())) {
+          from_key = cache_key_combine(*node_key,
+                                       blender::get_default_hash(from_output_socket->index()));
+        }
+      }
+      if (!from_key) {
+        return std::nullopt;
+      }
+      key = cache_key_combine(key, *from_key);
+    }
+    return key;
+  }
+
+  std::optional<uint64_t> unlinked_input_cache_key(const DInputSocket socket)
+  {
+    const bNodeSocket &bsocket = *socket->bsocket();
+    if (ELEM(bsocket.type, SOCK_OBJECT, SOCK_COLLECTION)) {
+      /* Other objects can change without the node tree changing. */
+      return std::nullopt;
+    }
+    const CPPType &type = *blender::nodes::socket_cpp_type_get(*socket->typeinfo());
+    BUFFER_FOR_CPP_TYPE_VALUE(type, buffer);
+    blender::nodes::socket_cpp_value_get(bsocket, buffer);
+    const uint64_t key = cache_key_combine(blender::get_default_hash(bsocket.type),
+                                           type.hash(buffer));
+    type.destruct(buffer);
+    return key;
+  }
+
+  static std::optional<uint64_t> group_input_cache_key(const GMutablePointer value)
+  {
+    const CPPType &type = *value.type();
+    if (type == CPPType::get<GeometrySet>()) {
+      return blender::modifiers::geometry_nodes::geometry_set_content_hash(
+          *(const GeometrySet *)value.get());
+    }
+    if (ELEM(&type,
+             &CPPType::get<PersistentObjectHandle>(),
+             &CPPType::get<PersistentCollectionHandle>())) {
+      return std::nullopt;
+    }
+    return type.hash(value.get());
+  }
+
   void log_socket_value(const DSocket socket, Span<GPointer> values)
   {
     if (log_socket_value_fn_) {
-      log_socket_value_fn_(socket, values);
+      if (use_task_graph_) {
+        std::lock_guard lock{log_mutex_};
+        log_socket_value_fn_(socket, values);
+      }
+      else {
+        log_socket_value_fn_(socket, values);
+      }
     }
   }
 
@@ -458,7 +861,9 @@ class GeometryNodesEvaluator {
     this->log_socket_value(socket, Span<GPointer>(&value, 1));
   }
 
-  void execute_node(const DNode node, GeoNodeExecParams params)
+  void execute_node(const DNode node,
+                    GeoNodeExecParams params,
+                    blender::LinearAllocator<> &allocator)
   {
     const bNode &bnode = params.node();
 
@@ -471,7 +876,7 @@ class GeometryNodesEvaluator {
     /* Use the multi-function implementation if it exists. */
     const MultiFunction *multi_function = mf_by_node_.lookup_default(node, nullptr);
     if (multi_function != nullptr) {
-      this->execute_multi_function_node(node, params, *multi_function);
+      this->execute_multi_function_node(node, params, *multi_function, allocator);
       return;
     }
 
@@ -481,7 +886,8 @@ class GeometryNodesEvaluator {
 
   void execute_multi_function_node(const DNode node,
                                    GeoNodeExecParams params,
-                                   const MultiFunction &fn)
+                                   const MultiFunction &fn,
+                                   blender::LinearAllocator<> &allocator)
   {
     MFContextBuilder fn_context;
     MFParamsBuilder fn_params{fn, 1};
@@ -497,7 +903,7 @@ class GeometryNodesEvaluator {
     for (const OutputSocketRef *socket_ref : node->outputs()) {
       if (socket_ref->is_available()) {
         const CPPType &type = *blender::nodes::socket_cpp_type_get(*socket_ref->typeinfo());
-        void *buffer = allocator_.allocate(type.size(), type.alignment());
+        void *buffer = allocator.allocate(type.size(), type.alignment());
         fn_params.add_uninitialized_single_output(GMutableSpan(type, buffer, 1));
         output_data.append(GMutablePointer(type, buffer));
       }
@@ -527,7 +933,9 @@ class GeometryNodesEvaluator {
     }
   }
 
-  void forward_to_inputs(const DOutputSocket from_socket, GMutablePointer value_to_forward)
+  void forward_to_inputs(const DOutputSocket from_socket,
+                         GMutablePointer value_to_forward,
+                         blender::LinearAllocator<> &allocator)
   {
     /* For all sockets that are linked with the from_socket push the value to their node. */
     Vector<DInputSocket> to_sockets_all;
@@ -550,7 +958,7 @@ class GeometryNodesEvaluator {
         to_sockets_same_type.append(to_socket);
       }
       else {
-        void *buffer = allocator_.allocate(to_type.size(), to_type.alignment());
+        void *buffer = allocator.allocate(to_type.size(), to_type.alignment());
         if (conversions_.is_convertible(from_type, to_type)) {
           conversions_.convert_to_uninitialized(
               from_type, to_type, value_to_forward.get(), buffer);
@@ -583,7 +991,7 @@ class GeometryNodesEvaluator {
       add_value_to_input_socket(first_key, value_to_forward);
       for (const DInputSocket &to_socket : other_to_sockets) {
         const std::pair<DInputSocket, DOutputSocket> key = std::make_pair(to_socket, from_socket);
-        void *buffer = allocator_.allocate(type.size(), type.alignment());
+        void *buffer = allocator.allocate(type.size(), type.alignment());
         type.copy_to_uninitialized(value_to_forward.get(), buffer);
         add_value_to_input_socket(key, GMutablePointer{type, buffer});
       }
@@ -593,15 +1001,22 @@ class GeometryNodesEvaluator {
   void add_value_to_input_socket(const std::pair<DInputSocket, DOutputSocket> key,
                                  GMutablePointer value)
   {
-    value_by_input_.add_new(key, value);
+    if (use_task_graph_) {
+      std::lock_guard lock{value_by_input_mutex_};
+      value_by_input_.add_new(key, value);
+    }
+    else {
+      value_by_input_.add_new(key, value);
+    }
   }
 
   GMutablePointer get_unlinked_input_value(const DInputSocket &socket,
-                                           const CPPType &required_type)
+                                           const CPPType &required_type,
+                                           blender::LinearAllocator<> &allocator)
   {
     bNodeSocket *bsocket = socket->bsocket();
     const CPPType &type = *blender::nodes::socket_cpp_type_get(*socket->typeinfo());
-    void *buffer = allocator_.allocate(type.size(), type.alignment());
+    void *buffer = allocator.allocate(type.size(), type.alignment());
 
     if (bsocket->type == SOCK_OBJECT) {
       Object *object = socket->default_value<bNodeSocketValueObject>()->value;
@@ -621,13 +1036,13 @@ class GeometryNodesEvaluator {
       return {type, buffer};
     }
     if (conversions_.is_convertible(type, required_type)) {
-      void *converted_buffer = allocator_.allocate(required_type.size(),
-                                                   required_type.alignment());
+      void *converted_buffer = allocator.allocate(required_type.size(),
+                                                  required_type.alignment());
       conversions_.convert_to_uninitialized(type, required_type, buffer, converted_buffer);
       type.destruct(buffer);
       return {required_type, converted_buffer};
     }
-    void *default_buffer = allocator_.allocate(required_type.size(), required_type.alignment());
+    void *default_buffer = allocator.allocate(required_type.size(), required_type.alignment());
     required_type.copy_to_uninitialized(required_type.default_value(), default_buffer);
     return {required_type, default_buffer};
   }
@@ -1235,6 +1650,13 @@ static void log_ui_hints(const DSocket socket,
  * Evaluate a node group to compute the output geometry.
  * Currently, this uses a fairly basic and inefficient algorithm that might compute things more
  * often than necessary. It's going to be replaced soon.
+ *
+ * With the experimental multi-threading option, all required nodes are found up front and
+ * independent nodes are executed in parallel. Pass `--debug-geometry-nodes-time` to print how
+ * long every node took.
+ *
+ * With the experimental cache option, node outputs are kept between evaluations, see
+ * `MOD_nodes_cache.hh`.
  */
 static GeometrySet compute_geometry(const DerivedNodeTree &tree,
                                     Span<const NodeRef *> group_input_nodes,
@@ -1300,6 +1722,10 @@ static GeometrySet compute_geometry(const DerivedNodeTree &tree,
     log_ui_hints(socket, values, ctx->object, nmd);
   };
 
+  const bool use_task_graph = USER_EXPERIMENTAL_TEST(&U, use_geometry_nodes_multithreading);
+  const bool use_timing = G.debug & G_DEBUG_GEOMETRY_NODES_TIME;
+  const bool use_cache = USER_EXPERIMENTAL_TEST(&U, use_geometry_nodes_cache);
+
   GeometryNodesEvaluator evaluator{group_inputs,
                                    group_outputs,
                                    mf_by_node,
@@ -1307,9 +1733,18 @@ static GeometrySet compute_geometry(const DerivedNodeTree &tree,
                                    ctx->object,
                                    (ModifierData *)nmd,
                                    ctx->depsgraph,
-                                   log_socket_value};
+                                   log_socket_value,
+                                   use_task_graph,
+                                   use_timing,
+                                   use_cache};
 
+  const blender::timeit::TimePoint start = blender::timeit::Clock::now();
   Vector<GMutablePointer> results = evaluator.execute();
+  if (use_timing) {
+    const blender::timeit::TimePoint end = blender::timeit::Clock::now();
+    const std::string label = std::string(ctx->object->id.name + 2) + " / " + nmd->modifier.name;
+    evaluator.print_timings(label, end - start);
+  }
   BLI_assert(results.size() == 1);
   GMutablePointer result = results[0];
 
@@ -0,0 +1,355 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup modifiers
+ */
+
+#include <algorithm>
+#include <mutex>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_hash.hh"
+#include "BLI_hash_mm2a.h"
+#include "BLI_hash_mm3.h"
+#include "BLI_map.hh"
+
+#include "DNA_customdata_types.h"
+#include "DNA_genfile.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_node_types.h"
+#include "DNA_pointcloud_types.h"
+#include "DNA_sdna_types.h"
+#include "DNA_userdef_types.h"
+
+#include "BKE_customdata.h"
+#include "BKE_geometry_set.hh"
+#include "BKE_node.h"
+
+#include "MOD_nodes.h"
+#include "MOD_nodes_cache.hh"
+
+namespace blender::modifiers::geometry_nodes {
+
+using fn::CPPType;
+using fn::GMutablePointer;
+
+/* -------------------------------------------------------------------- */
+/** \name Content Hash
+ * \{ */
+
+static uint64_t hash_bytes(const void *data, const size_t size)
+{
+  /* Combine two 32 bit hashes, a collision would mean that wrong data is used from the cache. */
+  const uint32_t hash_low = BLI_hash_mm2((const unsigned char *)data, size, 0);
+  const uint32_t hash_high = BLI_hash_mm3((const unsigned char *)data, size, 0);
+  return (uint64_t(hash_high) << 32) | hash_low;
+}
+
+static std::optional<uint64_t> custom_data_content_hash(const CustomData &data, const int size)
+{
+  uint64_t hash = get_default_hash(size);
+  for (const int i : IndexRange(data.totlayer)) {
+    const CustomDataLayer &layer = data.layers[i];
+    hash = cache_key_combine(hash, get_default_hash(layer.type));
+    hash = cache_key_combine(hash, get_default_hash(StringRef(layer.name)));
+    if (layer.data == nullptr) {
+      continue;
+    }
+    switch (layer.type) {
+      case CD_MDEFORMVERT: {
+        /* Hash the weights instead of the pointers to them. */
+        const MDeformVert *dverts = (const MDeformVert *)layer.data;
+        for (const int j : IndexRange(size)) {
+          const MDeformVert &dvert = dverts[j];
+          hash = cache_key_combine(
+              hash, hash_bytes(dvert.dw, sizeof(MDeformWeight) * (size_t)dvert.totweight));
+        }
+        break;
+      }
+      case CD_MDISPS:
+      case CD_GRID_PAINT_MASK:
+      case CD_BM_ELEM_PYPTR:
+        /* These layers reference data that is not hashed here. */
+        return std::nullopt;
+      default:
+        hash = cache_key_combine(
+            hash, hash_bytes(layer.data, (size_t)CustomData_sizeof(layer.type) * (size_t)size));
+        break;
+    }
+  }
+  return hash;
+}
+
+static std::optional<uint64_t> mesh_content_hash(const MeshComponent &component)
+{
+  const Mesh *mesh = component.get_for_read();
+  if (mesh == nullptr) {
+    return get_default_hash(0);
+  }
+  const std::optional<uint64_t> vdata_hash = custom_data_content_hash(mesh->vdata, mesh->totvert);
+  const std::optional<uint64_t> edata_hash = custom_data_content_hash(mesh->edata, mesh->totedge);
+  const std::optional<uint64_t> ldata_hash = custom_data_content_hash(mesh->ldata, mesh->totloop);
+  const std::optional<uint64_t> pdata_hash = custom_data_content_hash(mesh->pdata, mesh->totpoly);
+  if (!vdata_hash || !edata_hash || !ldata_hash || !pdata_hash) {
+    return std::nullopt;
+  }
+  uint64_t hash = cache_key_combine(*vdata_hash, *edata_hash);
+  hash = cache_key_combine(hash, *ldata_hash);
+  hash = cache_key_combine(hash, *pdata_hash);
+  /* The iteration order of the map is not part of its content, so the groups are summed. */
+  uint64_t vertex_groups_hash = 0;
+  for (const auto item : component.vertex_group_names().items()) {
+    vertex_groups_hash += cache_key_combine(get_default_hash(StringRef(item.key)), item.value);
+  }
+  return cache_key_combine(hash, vertex_groups_hash);
+}
+
+static std::optional<uint64_t> pointcloud_content_hash(const PointCloudComponent &component)
+{
+  const PointCloud *pointcloud = component.get_for_read();
+  if (pointcloud == nullptr) {
+    return get_default_hash(0);
+  }
+  return custom_data_content_hash(pointcloud->pdata, pointcloud->totpoint);
+}
+
+std::optional<uint64_t> geometry_set_content_hash(const GeometrySet &geometry_set)
+{
+  uint64_t hash = 0;
+  for (const GeometryComponent *component : geometry_set.get_components_for_read()) {
+    std::optional<uint64_t> component_hash;
+    switch (component->type()) {
+      case GEO_COMPONENT_TYPE_MESH:
+        component_hash = mesh_content_hash(*(const MeshComponent *)component);
+        break;
+      case GEO_COMPONENT_TYPE_POINT_CLOUD:
+        component_hash = pointcloud_content_hash(*(const PointCloudComponent *)component);
+        break;
+      case GEO_COMPONENT_TYPE_INSTANCES:
+      case GEO_COMPONENT_TYPE_VOLUME:
+        break;
+    }
+    if (!component_hash) {
+      return std::nullopt;
+    }
+    hash = cache_key_combine(hash, get_default_hash(component->type()));
+    hash = cache_key_combine(hash, *component_hash);
+  }
+  return hash;
+}
+
+/**
+ * Pointers differ between evaluations and the data they reference is not part of the struct,
+ * so only structs without pointers (also in nested structs) can be hashed by their bytes.
+ */
+static bool dna_struct_is_plain_data(const SDNA &sdna, const int struct_nr)
+{
+  const SDNA_Struct &struct_info = *sdna.structs[struct_nr];
+  for (const int i : IndexRange(struct_info.members_len)) {
+    const SDNA_StructMember &member = struct_info.members[i];
+    const char *member_name = sdna.names[member.name];
+    if (ELEM(member_name[0], '*', '(')) {
+      return false;
+    }
+    const int member_struct_nr = DNA_struct_find_nr(&sdna, sdna.types[member.type]);
+    if (member_struct_nr != -1 && !dna_struct_is_plain_data(sdna, member_struct_nr)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::optional<uint64_t> node_storage_hash(const bNode &node)
+{
+  if (node.storage == nullptr) {
+    return get_default_hash(0);
+  }
+  const SDNA *sdna = DNA_sdna_current_get();
+  const int struct_nr = DNA_struct_find_nr(sdna, node.typeinfo->storagename);
+  if (struct_nr == -1 || !dna_struct_is_plain_data(*sdna, struct_nr)) {
+    return std::nullopt;
+  }
+  /* DNA structs have explicit padding, so all bytes of the struct are part of its value. */
+  const short size = sdna->types_size[sdna->structs[struct_nr]->type];
+  return hash_bytes(node.storage, (size_t)size);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Cache Storage
+ * \{ */
+
+struct NodeOutputCacheEntry {
+  /* Values are owned by the entry and allocated with the guarded allocator. */
+  Vector<GMutablePointer> values;
+  int64_t size_in_bytes;
+  /* Value of #NodeOutputCache::usage_counter when the entry was used last. */
+  uint64_t last_used;
+};
+
+struct NodeOutputCache {
+  std::mutex mutex;
+  Map<uint64_t, NodeOutputCacheEntry *> entries;
+  int64_t size_in_bytes = 0;
+  uint64_t usage_counter = 0;
+};
+
+static NodeOutputCache &get_node_output_cache()
+{
+  static NodeOutputCache cache;
+  return cache;
+}
+
+static int64_t custom_data_size_in_bytes(const CustomData &data, const int size)
+{
+  int64_t size_in_bytes = 0;
+  for (const int i : IndexRange(data.totlayer)) {
+    size_in_bytes += (int64_t)CustomData_sizeof(data.layers[i].type) * size;
+  }
+  return size_in_bytes;
+}
+
+/**
+ * Approximate memory used by a cached value. Components that are shared between multiple entries
+ * are counted more than once, so this is an upper bound.
+ */
+static int64_t value_size_in_bytes(const GMutablePointer value)
+{
+  const CPPType &type = *value.type();
+  int64_t size_in_bytes = type.size();
+  if (type != CPPType::get<GeometrySet>()) {
+    return size_in_bytes;
+  }
+  const GeometrySet &geometry_set = *(const GeometrySet *)value.get();
+  if (const Mesh *mesh = geometry_set.get_mesh_for_read()) {
+    size_in_bytes += custom_data_size_in_bytes(mesh->vdata, mesh->totvert);
+    size_in_bytes += custom_data_size_in_bytes(mesh->edata, mesh->totedge);
+    size_in_bytes += custom_data_size_in_bytes(mesh->ldata, mesh->totloop);
+    size_in_bytes += custom_data_size_in_bytes(mesh->pdata, mesh->totpoly);
+  }
+  if (const PointCloud *pointcloud = geometry_set.get_pointcloud_for_read()) {
+    size_in_bytes += custom_data_size_in_bytes(pointcloud->pdata, pointcloud->totpoint);
+  }
+  return size_in_bytes;
+}
+
+static void free_entry(NodeOutputCacheEntry *entry)
+{
+  for (GMutablePointer value : entry->values) {
+    value.destruct();
+    MEM_freeN(value.get());
+  }
+  OBJECT_GUARDED_DELETE(entry, NodeOutputCacheEntry);
+}
+
+static int64_t cache_size_limit_in_bytes()
+{
+  return (int64_t)U.geometry_nodes_cache_limit * 1024 * 1024;
+}
+
+/** Remove least recently used entries until the cache is within its size limit. */
+static void cache_enforce_limit(NodeOutputCache &cache, const int64_t size_limit)
+{
+  if (cache.size_in_bytes <= size_limit) {
+    return;
+  }
+  Vector<std::pair<uint64_t, NodeOutputCacheEntry *>> entries;
+  for (auto item : cache.entries.items()) {
+    entries.append({item.key, item.value});
+  }
+  std::sort(entries.begin(), entries.end(), [](const auto &a, const auto &b) {
+    return a.second->last_used < b.second->last_used;
+  });
+  for (const auto &item : entries) {
+    if (cache.size_in_bytes <= size_limit) {
+      break;
+    }
+    cache.size_in_bytes -= item.second->size_in_bytes;
+    cache.entries.remove(item.first);
+    free_entry(item.second);
+  }
+}
+
+bool node_output_cache_lookup(const uint64_t key,
+                              LinearAllocator<> &allocator,
+                              Vector<GMutablePointer> &r_values)
+{
+  NodeOutputCache &cache = get_node_output_cache();
+  std::lock_guard lock{cache.mutex};
+  NodeOutputCacheEntry *entry = cache.entries.lookup_default(key, nullptr);
+  if (entry == nullptr) {
+    return false;
+  }
+  entry->last_used = ++cache.usage_counter;
+  for (const GMutablePointer value : entry->values) {
+    const CPPType &type = *value.type();
+    void *buffer = allocator.allocate(type.size(), type.alignment());
+    /* Geometry sets share their components with the cached value. */
+    type.copy_to_uninitialized(value.get(), buffer);
+    r_values.append({type, buffer});
+  }
+  return true;
+}
+
+void node_output_cache_add(const uint64_t key, Span<GMutablePointer> values)
+{
+  NodeOutputCacheEntry *entry = OBJECT_GUARDED_NEW(NodeOutputCacheEntry);
+  entry->size_in_bytes = 0;
+  for (const GMutablePointer value : values) {
+    const CPPType &type = *value.type();
+    void *buffer = MEM_mallocN_aligned(type.size(), type.alignment(), __func__);
+    type.copy_to_uninitialized(value.get(), buffer);
+    if (type == CPPType::get<GeometrySet>()) {
+      /* The geometry might reference data that is freed after the evaluation. */
+      ((GeometrySet *)buffer)->ensure_owns_direct_data();
+    }
+    entry->values.append({type, buffer});
+    entry->size_in_bytes += value_size_in_bytes({type, buffer});
+  }
+
+  const int64_t size_limit = cache_size_limit_in_bytes();
+  NodeOutputCache &cache = get_node_output_cache();
+  std::lock_guard lock{cache.mutex};
+  if (entry->size_in_bytes > size_limit || cache.entries.contains(key)) {
+    /* Another thread might have added the same entry already. */
+    free_entry(entry);
+    return;
+  }
+  entry->last_used = ++cache.usage_counter;
+  cache.entries.add_new(key, entry);
+  cache.size_in_bytes += entry->size_in_bytes;
+  cache_enforce_limit(cache, size_limit);
+}
+
+/** \} */
+
+}  // namespace blender::modifiers::geometry_nodes
+
+void MOD_nodes_cache_free(void)
+{
+  using namespace blender::modifiers::geometry_nodes;
+  NodeOutputCache &cache = get_node_output_cache();
+  std::lock_guard lock{cache.mutex};
+  for (NodeOutputCacheEntry *entry : cache.entries.values()) {
+    free_entry(entry);
+  }
+  cache.entries.clear();
+  cache.size_in_bytes = 0;
+}
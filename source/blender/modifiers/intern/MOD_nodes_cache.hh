@@ -0,0 +1,87 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#pragma once
+
+/** \file
+ * \ingroup modifiers
+ *
+ * Cache for the outputs of geometry nodes that persists across evaluations of the modifier.
+ *
+ * Entries are identified by a key that is computed from the node and the keys of everything the
+ * node depends on (the values of unlinked sockets, the keys of linked outputs and a content hash
+ * of the modifier inputs). When only a node at the end of the tree changes, all nodes before it
+ * are found in the cache and don't have to be evaluated again.
+ *
+ * Cached geometry shares its components with the geometry that is passed through the node tree,
+ * so storing and retrieving values is cheap. The total size of the cache is limited by a user
+ * preference, least recently used entries are removed first.
+ */
+
+#include <optional>
+
+#include "BLI_hash.hh"
+#include "BLI_linear_allocator.hh"
+#include "BLI_span.hh"
+#include "BLI_vector.hh"
+
+#include "FN_generic_pointer.hh"
+
+struct GeometrySet;
+struct bNode;
+
+namespace blender::modifiers::geometry_nodes {
+
+/**
+ * Mix a value into a cache key. Unlike combining hashes with XOR, the result depends on the order
+ * in which values are added and equal values don't cancel each other out.
+ */
+inline uint64_t cache_key_combine(const uint64_t key, const uint64_t value)
+{
+  /* Finalizer of MurmurHash3, so that values which differ in few bits change the entire key. */
+  uint64_t mixed = value;
+  mixed ^= mixed >> 33;
+  mixed *= 0xff51afd7ed558ccdLLU;
+  mixed ^= mixed >> 33;
+  mixed *= 0xc4ceb9fe1a85ec53LLU;
+  mixed ^= mixed >> 33;
+  return key ^ (mixed + 0x9e3779b97f4a7c15LLU + (key << 6) + (key >> 2));
+}
+
+/**
+ * Hash of all the data in the geometry. Returns none when the geometry contains data that cannot
+ * be hashed, e.g. volumes or instances.
+ */
+std::optional<uint64_t> geometry_set_content_hash(const GeometrySet &geometry_set);
+
+/**
+ * Hash of the values in the storage of a node. Returns none when the storage is not a DNA struct
+ * or references other data, nodes with such storage cannot be cached.
+ */
+std::optional<uint64_t> node_storage_hash(const bNode &node);
+
+/**
+ * Copy the values stored for the given key into buffers allocated with the allocator.
+ * Returns false when there is no entry for the key.
+ */
+bool node_output_cache_lookup(uint64_t key,
+                              LinearAllocator<> &allocator,
+                              Vector<fn::GMutablePointer> &r_values);
+
+/** Store a copy of the output values of a node. */
+void node_output_cache_add(uint64_t key, Span<fn::GMutablePointer> values);
+
+}  // namespace blender::modifiers::geometry_nodes
@@ -0,0 +1,222 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_listbase.h"
+
+#include "BKE_geometry_set.hh"
+#include "BKE_idtype.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+#include "BKE_node.h"
+#include "BKE_object.h"
+
+#include "DEG_depsgraph.h"
+
+#include "DNA_genfile.h"
+#include "DNA_modifier_types.h"
+#include "DNA_node_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+#include "DNA_userdef_types.h"
+#include "DNA_windowmanager_types.h"
+
+#include "RNA_define.h"
+
+#include "MOD_nodes.h"
+#include "MOD_nodes_cache.hh"
+
+namespace blender::modifiers::geometry_nodes::tests {
+
+/**
+ * Evaluates a nodes modifier with the tree
+ * `Group Input -> Transform (Scale <- Math) -> Group Output` and checks whether the output of the
+ * transform node comes from the cache. A cached geometry shares its components, so on a cache hit
+ * the output mesh is the same one as in an earlier evaluation.
+ */
+class NodesCacheTest : public testing::Test {
+ protected:
+  Main *bmain = nullptr;
+  Scene scene = {};
+  Depsgraph *depsgraph = nullptr;
+  Object *object = nullptr;
+  NodesModifierData *nmd = nullptr;
+  bNodeTree *ntree = nullptr;
+  bNode *transform_node = nullptr;
+  bNode *math_node = nullptr;
+  GeometrySet input_geometry;
+  UserDef userdef_backup;
+
+ public:
+  static void SetUpTestCase()
+  {
+    testing::Test::SetUpTestCase();
+
+    DNA_sdna_current_init();
+    BKE_idtype_init();
+    BKE_modifier_init();
+    DEG_register_node_types();
+    RNA_init();
+    BKE_node_system_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    BKE_node_system_exit();
+    RNA_exit();
+    DEG_free_node_types();
+    DNA_sdna_current_free();
+
+    testing::Test::TearDownTestCase();
+  }
+
+ protected:
+  void SetUp() override
+  {
+    userdef_backup = U;
+    U.flag |= USER_DEVELOPER_UI;
+    U.experimental.use_geometry_nodes_cache = 1;
+    U.geometry_nodes_cache_limit = 64;
+    MOD_nodes_cache_free();
+
+    bmain = BKE_main_new();
+    /* The modifier looks for spreadsheet editors in the window manager. */
+    bmain->wm.first = MEM_callocN(sizeof(wmWindowManager), __func__);
+    depsgraph = DEG_graph_new(bmain, &scene, nullptr, DAG_EVAL_VIEWPORT);
+
+    ntree = ntreeAddTree(bmain, "Geometry Nodes", "GeometryNodeTree");
+    ntreeAddSocketInterface(ntree, SOCK_IN, "NodeSocketGeometry", "Geometry");
+    ntreeAddSocketInterface(ntree, SOCK_OUT, "NodeSocketGeometry", "Geometry");
+    bNode *group_input = nodeAddNode(nullptr, ntree, "NodeGroupInput");
+    bNode *group_output = nodeAddNode(nullptr, ntree, "NodeGroupOutput");
+    transform_node = nodeAddNode(nullptr, ntree, "GeometryNodeTransform");
+    math_node = nodeAddNode(nullptr, ntree, "ShaderNodeMath");
+    math_node->custom1 = NODE_MATH_ADD;
+    nodeAddLink(ntree,
+                group_input,
+                (bNodeSocket *)group_input->outputs.first,
+                transform_node,
+                nodeFindSocket(transform_node, SOCK_IN, "Geometry"));
+    nodeAddLink(ntree,
+                math_node,
+                nodeFindSocket(math_node, SOCK_OUT, "Value"),
+                transform_node,
+                nodeFindSocket(transform_node, SOCK_IN, "Scale"));
+    nodeAddLink(ntree,
+                transform_node,
+                nodeFindSocket(transform_node, SOCK_OUT, "Geometry"),
+                group_output,
+                (bNodeSocket *)group_output->inputs.first);
+    ntreeUpdateTree(bmain, ntree);
+
+    object = BKE_object_add_only_object(bmain, OB_MESH, "Object");
+    nmd = (NodesModifierData *)BKE_modifier_new(eModifierType_Nodes);
+    nmd->node_group = ntree;
+    BLI_addtail(&object->modifiers, nmd);
+
+    input_geometry = GeometrySet::create_with_mesh(BKE_mesh_new_nomain(8, 0, 0, 0, 0));
+  }
+
+  void TearDown() override
+  {
+    input_geometry.clear();
+    MOD_nodes_cache_free();
+    DEG_graph_free(depsgraph);
+    MEM_freeN(bmain->wm.first);
+    bmain->wm.first = nullptr;
+    BKE_main_free(bmain);
+    U = userdef_backup;
+  }
+
+  GeometrySet evaluate()
+  {
+    const ModifierEvalContext ctx = {depsgraph, object, (ModifierApplyFlag)0};
+    GeometrySet geometry_set = input_geometry;
+    const ModifierTypeInfo *mti = BKE_modifier_get_info(eModifierType_Nodes);
+    mti->modifyGeometrySet(&nmd->modifier, &ctx, &geometry_set);
+    return geometry_set;
+  }
+
+  void set_translation_x(const float value)
+  {
+    bNodeSocket *socket = nodeFindSocket(transform_node, SOCK_IN, "Translation");
+    ((bNodeSocketValueVector *)socket->default_value)->value[0] = value;
+  }
+
+  void set_math_operation(const int operation)
+  {
+    math_node->custom1 = operation;
+    ntreeUpdateTree(bmain, ntree);
+  }
+};
+
+TEST_F(NodesCacheTest, SameInputs)
+{
+  const GeometrySet result_a = this->evaluate();
+  const GeometrySet result_b = this->evaluate();
+  ASSERT_NE(result_a.get_mesh_for_read(), nullptr);
+  EXPECT_NE(result_a.get_mesh_for_read(), input_geometry.get_mesh_for_read());
+  EXPECT_EQ(result_a.get_mesh_for_read(), result_b.get_mesh_for_read());
+}
+
+TEST_F(NodesCacheTest, ChangedInput)
+{
+  const GeometrySet result_a = this->evaluate();
+  this->set_translation_x(2.0f);
+  const GeometrySet result_b = this->evaluate();
+  this->set_translation_x(0.0f);
+  const GeometrySet result_c = this->evaluate();
+  ASSERT_NE(result_a.get_mesh_for_read(), nullptr);
+  ASSERT_NE(result_b.get_mesh_for_read(), nullptr);
+  EXPECT_NE(result_a.get_mesh_for_read(), result_b.get_mesh_for_read());
+  EXPECT_EQ(result_a.get_mesh_for_read(), result_c.get_mesh_for_read());
+}
+
+TEST_F(NodesCacheTest, ChangedOperation)
+{
+  const GeometrySet result_a = this->evaluate();
+  this->set_math_operation(NODE_MATH_MULTIPLY);
+  const GeometrySet result_b = this->evaluate();
+  this->set_math_operation(NODE_MATH_ADD);
+  const GeometrySet result_c = this->evaluate();
+  ASSERT_NE(result_a.get_mesh_for_read(), nullptr);
+  ASSERT_NE(result_b.get_mesh_for_read(), nullptr);
+  EXPECT_NE(result_a.get_mesh_for_read(), result_b.get_mesh_for_read());
+  EXPECT_EQ(result_a.get_mesh_for_read(), result_c.get_mesh_for_read());
+}
+
+TEST_F(NodesCacheTest, Disabled)
+{
+  U.experimental.use_geometry_nodes_cache = 0;
+  const GeometrySet result_a = this->evaluate();
+  const GeometrySet result_b = this->evaluate();
+  EXPECT_NE(result_a.get_mesh_for_read(), result_b.get_mesh_for_read());
+}
+
+TEST_F(NodesCacheTest, StorageHash)
+{
+  bNode *attribute_math_node = nodeAddNode(nullptr, ntree, "GeometryNodeAttributeMath");
+  const std::optional<uint64_t> hash_a = node_storage_hash(*attribute_math_node);
+  ((NodeAttributeMath *)attribute_math_node->storage)->operation = NODE_MATH_MULTIPLY;
+  const std::optional<uint64_t> hash_b = node_storage_hash(*attribute_math_node);
+  ASSERT_TRUE(hash_a.has_value());
+  ASSERT_TRUE(hash_b.has_value());
+  EXPECT_NE(*hash_a, *hash_b);
+
+  /* The image user references a scene. */
+  bNode *image_node = nodeAddNode(nullptr, ntree, "ShaderNodeTexImage");
+  EXPECT_FALSE(node_storage_hash(*image_node).has_value());
+}
+
+TEST(nodes_cache, CombineOrder)
+{
+  EXPECT_NE(cache_key_combine(cache_key_combine(0, 1), 2),
+            cache_key_combine(cache_key_combine(0, 2), 1));
+  EXPECT_NE(cache_key_combine(cache_key_combine(0, 3), 3), 0);
+  EXPECT_NE(cache_key_combine(0, 0), 0);
+}
+
+}  // namespace blender::modifiers::geometry_nodes::tests
@@ -14,9 +14,12 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
+#include <array>
+
 #include "BLI_hash.h"
-#include "BLI_kdtree.h"
+#include "BLI_map.hh"
 #include "BLI_rand.hh"
+#include "BLI_task.hh"
 #include "BLI_timeit.hh"
 
 #include "DNA_mesh_types.h"
@@ -140,22 +143,101 @@ static void sample_mesh_surface(const Mesh &mesh,
   }
 }
 
-BLI_NOINLINE static KDTree_3d *build_kdtree(Span<Vector<float3>> positions_all,
-                                            const int initial_points_len)
+/* Cell coordinates are packed into a single integer with this many bits per axis. */
+static constexpr int grid_bits_per_axis = 21;
+static constexpr int grid_max_cells_per_axis = (1 << (grid_bits_per_axis - 1));
+
+static uint64_t grid_cell_key(const int x, const int y, const int z)
 {
-  KDTree_3d *kdtree = BLI_kdtree_3d_new(initial_points_len);
+  return (uint64_t)x | ((uint64_t)y << grid_bits_per_axis) |
+         ((uint64_t)z << (2 * grid_bits_per_axis));
+}
 
-  int i_point = 0;
-  for (const Vector<float3> &positions : positions_all) {
-    for (const float3 position : positions) {
-      BLI_kdtree_3d_insert(kdtree, i_point, position);
-      i_point++;
+/**
+ * Hashed grid that stores the indices of the points in every non-empty cell. The cells are at least
+ * as large as the minimum distance, so all points that are close to a point are in one of the 27
+ * cells around it.
+ */
+struct PoissonDiskGrid {
+  float3 min;
+  float cell_size;
+  Map<uint64_t, int> cell_by_key;
+  Vector<uint64_t> cell_keys;
+  /* The points of a cell are stored in ascending order at `cell_offsets[cell]`. */
+  Array<int> cell_offsets;
+  Array<int> points_by_cell;
+
+  std::array<int, 3> cell_coords(const float3 &position) const
+  {
+    return {(int)((position.x - min.x) / cell_size),
+            (int)((position.y - min.y) / cell_size),
+            (int)((position.z - min.z) / cell_size)};
+  }
+
+  Span<int> cell_points(const int cell) const
+  {
+    return points_by_cell.as_span().slice(cell_offsets[cell],
+                                          cell_offsets[cell + 1] - cell_offsets[cell]);
+  }
+};
+
+BLI_NOINLINE static void build_grid(Span<float3> positions,
+                                    const float minimum_distance,
+                                    PoissonDiskGrid &grid)
+{
+  float3 min = positions[0];
+  float3 max = positions[0];
+  for (const float3 &position : positions) {
+    minmax_v3v3_v3(min, max, position);
+  }
+  const float3 extent = max - min;
+  const float max_extent = std::max({extent.x, extent.y, extent.z});
+  grid.min = min;
+  /* Use larger cells for huge extents so that the cell coordinates can be packed. */
+  grid.cell_size = std::max(minimum_distance, max_extent / (float)(grid_max_cells_per_axis - 1));
+
+  Array<uint64_t> point_cell_keys(positions.size());
+  parallel_for(positions.index_range(), 4096, [&](IndexRange range) {
+    for (const int i : range) {
+      const std::array<int, 3> coords = grid.cell_coords(positions[i]);
+      point_cell_keys[i] = grid_cell_key(coords[0], coords[1], coords[2]);
     }
+  });
+
+  /* Sort the point indices by cell with a counting sort, which keeps the original order of the
+   * points within every cell. */
+  Array<int> point_cells(positions.size());
+  Vector<int> cell_sizes;
+  for (const int i : positions.index_range()) {
+    const int cell = grid.cell_by_key.lookup_or_add_cb(point_cell_keys[i], [&]() {
+      grid.cell_keys.append(point_cell_keys[i]);
+      cell_sizes.append(0);
+      return grid.cell_keys.size() - 1;
+    });
+    point_cells[i] = cell;
+    cell_sizes[cell]++;
+  }
+
+  grid.cell_offsets.reinitialize(cell_sizes.size() + 1);
+  grid.cell_offsets[0] = 0;
+  for (const int cell : cell_sizes.index_range()) {
+    grid.cell_offsets[cell + 1] = grid.cell_offsets[cell] + cell_sizes[cell];
+  }
+  grid.points_by_cell.reinitialize(positions.size());
+  Array<int> cell_fill(grid.cell_offsets.as_span().drop_back(1));
+  for (const int i : positions.index_range()) {
+    grid.points_by_cell[cell_fill[point_cells[i]]++] = i;
   }
-  BLI_kdtree_3d_balance(kdtree);
-  return kdtree;
 }
 
+/**
+ * Eliminates every point that is closer than the minimum distance to a point that is processed
+ * before it and not eliminated itself.
+ *
+ * Processing a cell only accesses the 27 cells around it. Cells whose coordinates are equal
+ * modulo 3 on every axis never access the same cells, so those are processed in parallel. The
+ * result does not depend on the number of threads.
+ */
 BLI_NOINLINE static void update_elimination_mask_for_close_points(
     Span<Vector<float3>> positions_all,
     Span<int> instance_start_offsets,
@@ -163,43 +245,64 @@ BLI_NOINLINE static void update_elimination_mask_for_close_points(
     MutableSpan<bool> elimination_mask,
     const int initial_points_len)
 {
-  if (minimum_distance <= 0.0f) {
+  if (minimum_distance <= 0.0f || initial_points_len == 0) {
     return;
   }
 
-  KDTree_3d *kdtree = build_kdtree(positions_all, initial_points_len);
-
-  /* The elimination mask is a flattened array for every point,
-   * so keep track of the index to it separately. */
-  for (const int i_instance : positions_all.index_range()) {
-    Span<float3> positions = positions_all[i_instance];
-    const int offset = instance_start_offsets[i_instance];
-
-    for (const int i : positions.index_range()) {
-      if (elimination_mask[offset + i]) {
-        continue;
-      }
+  /* The elimination mask is a flattened array for every point, so do the same for positions. */
+  Array<float3> positions(initial_points_len);
+  parallel_for(positions_all.index_range(), 64, [&](IndexRange range) {
+    for (const int i_instance : range) {
+      Span<float3> instance_positions = positions_all[i_instance];
+      positions.as_mutable_span()
+          .slice(instance_start_offsets[i_instance], instance_positions.size())
+          .copy_from(instance_positions);
+    }
+  });
+
+  PoissonDiskGrid grid;
+  build_grid(positions, minimum_distance, grid);
+
+  std::array<Vector<int>, 27> cells_by_color;
+  for (const int cell : grid.cell_keys.index_range()) {
+    const uint64_t key = grid.cell_keys[cell];
+    const uint64_t axis_mask = (1 << grid_bits_per_axis) - 1;
+    const int color = (key & axis_mask) % 3 + ((key >> grid_bits_per_axis) & axis_mask) % 3 * 3 +
+                      ((key >> (2 * grid_bits_per_axis)) & axis_mask) % 3 * 9;
+    cells_by_color[color].append(cell);
+  }
 
-      struct CallbackData {
-        int index;
-        MutableSpan<bool> elimination_mask;
-      } callback_data = {offset + i, elimination_mask};
-
-      BLI_kdtree_3d_range_search_cb(
-          kdtree,
-          positions[i],
-          minimum_distance,
-          [](void *user_data, int index, const float *UNUSED(co), float UNUSED(dist_sq)) {
-            CallbackData &callback_data = *static_cast<CallbackData *>(user_data);
-            if (index != callback_data.index) {
-              callback_data.elimination_mask[index] = true;
+  const float minimum_distance_sq = minimum_distance * minimum_distance;
+  for (Span<int> cells : cells_by_color) {
+    parallel_for(cells.index_range(), 16, [&](IndexRange range) {
+      for (const int cell : cells.slice(range)) {
+        for (const int point : grid.cell_points(cell)) {
+          if (elimination_mask[point]) {
+            continue;
+          }
+          const float3 position = positions[point];
+          const std::array<int, 3> coords = grid.cell_coords(position);
+          for (int z = std::max(coords[2] - 1, 0); z <= coords[2] + 1; z++) {
+            for (int y = std::max(coords[1] - 1, 0); y <= coords[1] + 1; y++) {
+              for (int x = std::max(coords[0] - 1, 0); x <= coords[0] + 1; x++) {
+                const int *neighbor_cell = grid.cell_by_key.lookup_ptr(grid_cell_key(x, y, z));
+                if (neighbor_cell == nullptr) {
+                  continue;
+                }
+                for (const int other_point : grid.cell_points(*neighbor_cell)) {
+                  if (other_point != point &&
+                      float3::distance_squared(position, positions[other_point]) <=
+                          minimum_distance_sq) {
+                    elimination_mask[other_point] = true;
+                  }
+                }
+              }
             }
-            return true;
-          },
-          &callback_data);
-    }
+          }
+        }
+      }
+    });
   }
-  BLI_kdtree_3d_free(kdtree);
 }
 
 BLI_NOINLINE static void update_elimination_mask_based_on_density_factors(
@@ -429,6 +532,20 @@ BLI_NOINLINE static void add_remaining_point_attributes(
       set_groups, instance_start_offsets, component, bary_coords_array, looptri_indices_array);
 }
 
+/**
+ * Returns the index of the first instance of every group in the flattened per-instance arrays.
+ */
+static Array<int> instance_group_start_indices(Span<GeometryInstanceGroup> set_groups)
+{
+  Array<int> start_indices(set_groups.size());
+  int i_instance = 0;
+  for (const int group_index : set_groups.index_range()) {
+    start_indices[group_index] = i_instance;
+    i_instance += set_groups[group_index].transforms.size();
+  }
+  return start_indices;
+}
+
 static void distribute_points_random(Span<GeometryInstanceGroup> set_groups,
                                      const StringRef density_attribute_name,
                                      const float density,
@@ -442,28 +559,31 @@ static void distribute_points_random(Span<GeometryInstanceGroup> set_groups,
    * factors. */
   const bool use_one_default = density_attribute_name.is_empty();
 
-  int i_instance = 0;
-  for (const GeometryInstanceGroup &set_group : set_groups) {
-    const GeometrySet &set = set_group.geometry_set;
-    const MeshComponent &component = *set.get_component_for_read<MeshComponent>();
-    GVArray_Typed<float> density_factors = component.attribute_get_for_read<float>(
-        density_attribute_name, ATTR_DOMAIN_CORNER, use_one_default ? 1.0f : 0.0f);
-    const Mesh &mesh = *component.get_for_read();
-    for (const float4x4 &transform : set_group.transforms) {
-      Vector<float3> &positions = positions_all[i_instance];
-      Vector<float3> &bary_coords = bary_coords_all[i_instance];
-      Vector<int> &looptri_indices = looptri_indices_all[i_instance];
-      sample_mesh_surface(mesh,
-                          transform,
-                          density,
-                          &*density_factors,
-                          seed,
-                          positions,
-                          bary_coords,
-                          looptri_indices);
-      i_instance++;
+  const Array<int> group_start_indices = instance_group_start_indices(set_groups);
+  parallel_for(set_groups.index_range(), 1, [&](IndexRange groups_range) {
+    for (const int group_index : groups_range) {
+      const GeometryInstanceGroup &set_group = set_groups[group_index];
+      const GeometrySet &set = set_group.geometry_set;
+      const MeshComponent &component = *set.get_component_for_read<MeshComponent>();
+      GVArray_Typed<float> density_factors = component.attribute_get_for_read<float>(
+          density_attribute_name, ATTR_DOMAIN_CORNER, use_one_default ? 1.0f : 0.0f);
+      const Mesh &mesh = *component.get_for_read();
+      get_mesh_looptris(mesh);
+      parallel_for(set_group.transforms.index_range(), 1, [&](IndexRange transforms_range) {
+        for (const int i : transforms_range) {
+          const int i_instance = group_start_indices[group_index] + i;
+          sample_mesh_surface(mesh,
+                              set_group.transforms[i],
+                              density,
+                              &*density_factors,
+                              seed,
+                              positions_all[i_instance],
+                              bary_coords_all[i_instance],
+                              looptri_indices_all[i_instance]);
+        }
+      });
     }
-  }
+  });
 }
 
 static void distribute_points_poisson_disk(Span<GeometryInstanceGroup> set_groups,
@@ -475,24 +595,35 @@ static void distribute_points_poisson_disk(Span<GeometryInstanceGroup> set_group
                                            MutableSpan<Vector<float3>> bary_coords_all,
                                            MutableSpan<Vector<int>> looptri_indices_all)
 {
+  const Array<int> group_start_indices = instance_group_start_indices(set_groups);
+  parallel_for(set_groups.index_range(), 1, [&](IndexRange groups_range) {
+    for (const int group_index : groups_range) {
+      const GeometryInstanceGroup &set_group = set_groups[group_index];
+      const GeometrySet &set = set_group.geometry_set;
+      const MeshComponent &component = *set.get_component_for_read<MeshComponent>();
+      const Mesh &mesh = *component.get_for_read();
+      get_mesh_looptris(mesh);
+      parallel_for(set_group.transforms.index_range(), 1, [&](IndexRange transforms_range) {
+        for (const int i : transforms_range) {
+          const int i_instance = group_start_indices[group_index] + i;
+          sample_mesh_surface(mesh,
+                              set_group.transforms[i],
+                              density,
+                              nullptr,
+                              seed,
+                              positions_all[i_instance],
+                              bary_coords_all[i_instance],
+                              looptri_indices_all[i_instance]);
+        }
+      });
+    }
+  });
+
   Array<int> instance_start_offsets(positions_all.size());
   int initial_points_len = 0;
-  int i_instance = 0;
-  for (const GeometryInstanceGroup &set_group : set_groups) {
-    const GeometrySet &set = set_group.geometry_set;
-    const MeshComponent &component = *set.get_component_for_read<MeshComponent>();
-    const Mesh &mesh = *component.get_for_read();
-    for (const float4x4 &transform : set_group.transforms) {
-      Vector<float3> &positions = positions_all[i_instance];
-      Vector<float3> &bary_coords = bary_coords_all[i_instance];
-      Vector<int> &looptri_indices = looptri_indices_all[i_instance];
-      sample_mesh_surface(
-          mesh, transform, density, nullptr, seed, positions, bary_coords, looptri_indices);
-
-      instance_start_offsets[i_instance] = initial_points_len;
-      initial_points_len += positions.size();
-      i_instance++;
-    }
+  for (const int i_instance : positions_all.index_range()) {
+    instance_start_offsets[i_instance] = initial_points_len;
+    initial_points_len += positions_all[i_instance].size();
   }
 
   /* If there is an attribute name, the default value for the densities should be zero so that
@@ -501,7 +632,7 @@ static void distribute_points_poisson_disk(Span<GeometryInstanceGroup> set_group
   const bool use_one_default = density_attribute_name.is_empty();
 
   /* Unlike the other result arrays, the elimination mask in stored as a flat array for every
-   * point, in order to simplify culling points from the KDTree (which needs to know about all
+   * point, in order to simplify culling points with the grid (which needs to know about all
    * points at once). */
   Array<bool> elimination_mask(initial_points_len, false);
   update_elimination_mask_for_close_points(positions_all,
@@ -510,35 +641,39 @@ static void distribute_points_poisson_disk(Span<GeometryInstanceGroup> set_group
                                            elimination_mask,
                                            initial_points_len);
 
-  i_instance = 0;
-  for (const GeometryInstanceGroup &set_group : set_groups) {
-    const GeometrySet &set = set_group.geometry_set;
-    const MeshComponent &component = *set.get_component_for_read<MeshComponent>();
-    const Mesh &mesh = *component.get_for_read();
-    const GVArray_Typed<float> density_factors = component.attribute_get_for_read<float>(
-        density_attribute_name, ATTR_DOMAIN_CORNER, use_one_default ? 1.0f : 0.0f);
-
-    for (const int UNUSED(i_set_instance) : set_group.transforms.index_range()) {
-      Vector<float3> &positions = positions_all[i_instance];
-      Vector<float3> &bary_coords = bary_coords_all[i_instance];
-      Vector<int> &looptri_indices = looptri_indices_all[i_instance];
-
-      const int offset = instance_start_offsets[i_instance];
-      update_elimination_mask_based_on_density_factors(
-          mesh,
-          density_factors,
-          bary_coords,
-          looptri_indices,
-          elimination_mask.as_mutable_span().slice(offset, positions.size()));
-
-      eliminate_points_based_on_mask(elimination_mask.as_span().slice(offset, positions.size()),
-                                     positions,
-                                     bary_coords,
-                                     looptri_indices);
-
-      i_instance++;
+  parallel_for(set_groups.index_range(), 1, [&](IndexRange groups_range) {
+    for (const int group_index : groups_range) {
+      const GeometryInstanceGroup &set_group = set_groups[group_index];
+      const GeometrySet &set = set_group.geometry_set;
+      const MeshComponent &component = *set.get_component_for_read<MeshComponent>();
+      const Mesh &mesh = *component.get_for_read();
+      const GVArray_Typed<float> density_factors = component.attribute_get_for_read<float>(
+          density_attribute_name, ATTR_DOMAIN_CORNER, use_one_default ? 1.0f : 0.0f);
+
+      parallel_for(set_group.transforms.index_range(), 1, [&](IndexRange transforms_range) {
+        for (const int i : transforms_range) {
+          const int i_instance = group_start_indices[group_index] + i;
+          Vector<float3> &positions = positions_all[i_instance];
+          Vector<float3> &bary_coords = bary_coords_all[i_instance];
+          Vector<int> &looptri_indices = looptri_indices_all[i_instance];
+
+          const int offset = instance_start_offsets[i_instance];
+          update_elimination_mask_based_on_density_factors(
+              mesh,
+              density_factors,
+              bary_coords,
+              looptri_indices,
+              elimination_mask.as_mutable_span().slice(offset, positions.size()));
+
+          eliminate_points_based_on_mask(
+              elimination_mask.as_span().slice(offset, positions.size()),
+              positions,
+              bary_coords,
+              looptri_indices);
+        }
+      });
     }
-  }
+  });
 }
 
 static void geo_node_point_distribute_exec(GeoNodeExecParams params)
@@ -617,7 +752,7 @@ static void geo_node_point_distribute_exec(GeoNodeExecParams params)
   }
 
   int final_points_len = 0;
-  Array<int> instance_start_offsets(set_groups.size());
+  Array<int> instance_start_offsets(positions_all.size());
   for (const int i : positions_all.index_range()) {
     Vector<float3> &positions = positions_all[i];
     instance_start_offsets[i] = final_points_len;
@@ -18,6 +18,7 @@
 #include "NOD_type_conversions.hh"
 
 #include "FN_multi_function_network_evaluation.hh"
+#include "FN_multi_function_network_optimization.hh"
 
 #include "BLI_color.hh"
 #include "BLI_float2.hh"
@@ -403,6 +404,11 @@ MultiFunctionByNode get_multi_function_per_node(const DerivedNodeTree &tree, Res
     }
   });
 
+  /* Nodes that expanded into chains of element-wise functions, e.g. a math node with clamping,
+   * are evaluated on chunks of the mask. The network evaluators created above traverse the
+   * network when they are called, so they use the fused nodes. */
+  fn::mf_network_optimization::fuse_element_wise_nodes(network, scope);
+
   return functions_by_node;
 }
 
@@ -3904,6 +3904,10 @@ static int early_out_text(Sequence *seq, float UNUSED(facf0), float UNUSED(facf1
   return EARLY_NO_INPUT;
 }
 
+/* Fonts and their drawing state (size, position, target buffer) are global, while prefetch workers
+ * render frames in parallel with each other and with the main thread. */
+static ThreadMutex text_effect_mutex = BLI_MUTEX_INITIALIZER;
+
 static ImBuf *do_text_effect(const SeqRenderData *context,
                              Sequence *seq,
                              float UNUSED(timeline_frame),
@@ -3924,6 +3928,8 @@ static ImBuf *do_text_effect(const SeqRenderData *context,
   int y_ofs, x, y;
   double proxy_size_comp;
 
+  BLI_mutex_lock(&text_effect_mutex);
+
   if (data->text_blf_id == SEQ_FONT_NOT_LOADED) {
     data->text_blf_id = -1;
 
@@ -4024,6 +4030,8 @@ static ImBuf *do_text_effect(const SeqRenderData *context,
 
   BLF_disable(font, font_flags);
 
+  BLI_mutex_unlock(&text_effect_mutex);
+
   return out;
 }
 
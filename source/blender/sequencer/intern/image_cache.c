@@ -146,7 +146,8 @@ typedef struct SeqCache {
   ThreadMutex iterator_mutex;
   struct BLI_mempool *keys_pool;
   struct BLI_mempool *items_pool;
-  struct SeqCacheKey *last_key;
+  /* Last stored key of each task, used to link items of the frame it is rendering. */
+  struct SeqCacheKey *last_key[SEQ_TASK_ID_MAX];
   SeqDiskCache *disk_cache;
 } SeqCache;
 
@@ -810,7 +811,14 @@ static size_t seq_cache_get_mem_total(void)
 static void seq_cache_keyfree(void *val)
 {
   SeqCacheKey *key = val;
-  BLI_mempool_free(key->cache_owner->keys_pool, key);
+  SeqCache *cache = key->cache_owner;
+
+  /* Key may be recycled while its task is still linking items to it. */
+  if (cache->last_key[key->task_id] == key) {
+    cache->last_key[key->task_id] = NULL;
+  }
+
+  BLI_mempool_free(cache->keys_pool, key);
 }
 
 static void seq_cache_valfree(void *val)
@@ -843,6 +851,7 @@ static int get_stored_types_flag(Scene *scene, SeqCacheKey *key)
 static void seq_cache_put_ex(Scene *scene, SeqCacheKey *key, ImBuf *ibuf)
 {
   SeqCache *cache = seq_cache_get_from_scene(scene);
+  SeqCacheKey **last_key = &cache->last_key[key->task_id];
   SeqCacheItem *item;
   item = BLI_mempool_alloc(cache->items_pool);
   item->cache_owner = cache;
@@ -853,30 +862,30 @@ static void seq_cache_put_ex(Scene *scene, SeqCacheKey *key, ImBuf *ibuf)
   /* Item stored for later use. */
   if (stored_types_flag & key->type) {
     key->is_temp_cache = false;
-    key->link_prev = cache->last_key;
+    key->link_prev = *last_key;
   }
 
   /* Store pointer to last cached key. */
-  SeqCacheKey *temp_last_key = cache->last_key;
+  SeqCacheKey *temp_last_key = *last_key;
 
   if (BLI_ghash_reinsert(cache->hash, key, item, seq_cache_keyfree, seq_cache_valfree)) {
     IMB_refImBuf(ibuf);
 
     if (!key->is_temp_cache) {
-      cache->last_key = key;
+      *last_key = key;
     }
   }
 
   /* Set last_key's reference to this key so we can look up chain backwards.
-   * Item is already put in cache, so cache->last_key points to current key.
+   * Item is already put in cache, so last_key points to current key.
    */
   if (!key->is_temp_cache && temp_last_key) {
-    temp_last_key->link_next = cache->last_key;
+    temp_last_key->link_next = *last_key;
   }
 
   /* Reset linking. */
   if (key->type == SEQ_CACHE_STORE_FINAL_OUT) {
-    cache->last_key = NULL;
+    *last_key = NULL;
   }
 }
 
@@ -1126,7 +1135,6 @@ static void seq_cache_create(Main *bmain, Scene *scene)
     cache->keys_pool = BLI_mempool_create(sizeof(SeqCacheKey), 0, 64, BLI_MEMPOOL_NOP);
     cache->items_pool = BLI_mempool_create(sizeof(SeqCacheItem), 0, 64, BLI_MEMPOOL_NOP);
     cache->hash = BLI_ghash_new(seq_cache_hashhash, seq_cache_hashcmp, "SeqCache hash");
-    cache->last_key = NULL;
     cache->bmain = bmain;
     BLI_mutex_init(&cache->iterator_mutex);
     scene->ed->cache = cache;
@@ -1244,7 +1252,7 @@ void SEQ_cache_cleanup(Scene *scene)
     BLI_ghashIterator_step(&gh_iter);
     BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
   }
-  cache->last_key = NULL;
+  memset(cache->last_key, 0, sizeof(cache->last_key));
   seq_cache_unlock(scene);
 }
 
@@ -1308,7 +1316,7 @@ void seq_cache_cleanup_sequence(Scene *scene,
       BLI_ghash_remove(cache->hash, key, seq_cache_keyfree, seq_cache_valfree);
     }
   }
-  cache->last_key = NULL;
+  memset(cache->last_key, 0, sizeof(cache->last_key));
   seq_cache_unlock(scene);
 }
 
@@ -1370,8 +1378,13 @@ struct ImBuf *seq_cache_get(const SeqRenderData *context,
 
     /* Store read image in RAM. Only recycle item for final type. */
     if (key.type != SEQ_CACHE_STORE_FINAL_OUT || seq_cache_recycle_item(scene)) {
-      SeqCacheKey *new_key = seq_cache_allocate_key(cache, context, seq, timeline_frame, type);
-      seq_cache_put_ex(scene, new_key, ibuf);
+      seq_cache_lock(scene);
+      /* Another task could have read the same file in the meantime. */
+      if (!BLI_ghash_haskey(cache->hash, &key)) {
+        SeqCacheKey *new_key = seq_cache_allocate_key(cache, context, seq, timeline_frame, type);
+        seq_cache_put_ex(scene, new_key, ibuf);
+      }
+      seq_cache_unlock(scene);
     }
   }
 
@@ -1398,8 +1411,11 @@ bool seq_cache_put_if_possible(
     return true;
   }
 
-  seq_cache_set_temp_cache_linked(scene, scene->ed->cache->last_key);
-  scene->ed->cache->last_key = NULL;
+  SeqCache *cache = seq_cache_get_from_scene(scene);
+  seq_cache_lock(scene);
+  seq_cache_set_temp_cache_linked(scene, cache->last_key[context->task_id]);
+  cache->last_key[context->task_id] = NULL;
+  seq_cache_unlock(scene);
   return false;
 }
 
@@ -1433,7 +1449,20 @@ void seq_cache_put(
   seq_cache_lock(scene);
   SeqCache *cache = seq_cache_get_from_scene(scene);
   SeqCacheKey *key = seq_cache_allocate_key(cache, context, seq, timeline_frame, type);
+
+  /* Prefetch workers and the main render can produce the same item concurrently, the check
+   * above is not enough to prevent reinserting. */
+  if (BLI_ghash_haskey(cache->hash, key)) {
+    BLI_mempool_free(cache->keys_pool, key);
+    seq_cache_unlock(scene);
+    return;
+  }
+
   seq_cache_put_ex(scene, key, i);
+
+  /* Key can be recycled by another task as soon as the cache is unlocked. */
+  SeqCacheKey key_copy = *key;
+  key = &key_copy;
   seq_cache_unlock(scene);
 
   if (!key->is_temp_cache) {
@@ -1474,7 +1503,7 @@ void SEQ_cache_iterate(
     interrupt = callback_iter(userdata, key->seq, key->timeline_frame, key->type);
   }
 
-  cache->last_key = NULL;
+  memset(cache->last_key, 0, sizeof(cache->last_key));
   seq_cache_unlock(scene);
 }
 
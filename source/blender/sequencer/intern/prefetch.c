@@ -34,6 +34,7 @@
 #include "DNA_windowmanager_types.h"
 
 #include "BLI_listbase.h"
+#include "BLI_math_base.h"
 #include "BLI_threads.h"
 
 #include "IMB_imbuf.h"
@@ -61,29 +62,47 @@
 #include "prefetch.h"
 #include "render.h"
 
+/* Renders one frame at a time, each worker has its own evaluated copy of the scene. */
+typedef struct PrefetchWorker {
+  struct PrefetchJob *pfjob;
+
+  struct Scene *scene_eval;
+  struct Depsgraph *depsgraph;
+
+  /* context */
+  struct SeqRenderData context;
+  struct SeqRenderData context_cpy;
+
+  /* Frame being rendered and #PrefetchJob.generation at the time it was claimed. */
+  float cfra;
+  int generation;
+} PrefetchWorker;
+
 typedef struct PrefetchJob {
   struct PrefetchJob *next, *prev;
 
   struct Main *bmain;
   struct Main *bmain_eval;
   struct Scene *scene;
-  struct Scene *scene_eval;
-  struct Depsgraph *depsgraph;
 
+  /* Protects the prefetch area and control variables shared by workers. */
   ThreadMutex prefetch_suspend_mutex;
   ThreadCondition prefetch_suspend_cond;
 
   ListBase threads;
-
-  /* context */
-  struct SeqRenderData context;
-  struct SeqRenderData context_cpy;
-  struct ListBase *seqbasep;
-  struct ListBase *seqbasep_cpy;
-
-  /* prefetch area */
+  PrefetchWorker workers[SEQ_PREFETCH_WORKERS_MAX];
+  int num_workers;
+  int num_workers_running;
+  int num_workers_waiting;
+
+  /* prefetch area
+   * Frames are claimed by workers up to `cfra + num_frames_scheduled`, but inserted into cache in
+   * order, so frames up to `cfra + num_frames_prefetched` are done. */
   float cfra;
   int num_frames_prefetched;
+  int num_frames_scheduled;
+  /* Incremented when prefetch area is reset, frames claimed before are not committed in order. */
+  int generation;
 
   /* control */
   bool running;
@@ -167,12 +186,19 @@ Sequence *seq_prefetch_get_original_sequence(Sequence *seq, Scene *scene)
   return sequencer_prefetch_get_original_sequence(seq, &ed->seqbase);
 }
 
-/* for cache context swapping */
-SeqRenderData *seq_prefetch_get_original_context(const SeqRenderData *context)
+static PrefetchWorker *seq_prefetch_worker_get(const SeqRenderData *context)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(context->scene);
+  const int index = context->task_id - SEQ_TASK_PREFETCH_RENDER;
 
-  return &pfjob->context;
+  BLI_assert(index >= 0 && index < pfjob->num_workers);
+  return &pfjob->workers[index];
+}
+
+/* for cache context swapping */
+SeqRenderData *seq_prefetch_get_original_context(const SeqRenderData *context)
+{
+  return &seq_prefetch_worker_get(context)->context;
 }
 
 static bool seq_prefetch_is_cache_full(Scene *scene)
@@ -190,52 +216,56 @@ static float seq_prefetch_cfra(PrefetchJob *pfjob)
 {
   return pfjob->cfra + pfjob->num_frames_prefetched;
 }
-static AnimationEvalContext seq_prefetch_anim_eval_context(PrefetchJob *pfjob)
+
+static AnimationEvalContext seq_prefetch_anim_eval_context(PrefetchWorker *worker)
 {
-  return BKE_animsys_eval_context_construct(pfjob->depsgraph, seq_prefetch_cfra(pfjob));
+  return BKE_animsys_eval_context_construct(worker->depsgraph, worker->cfra);
 }
 
 void seq_prefetch_get_time_range(Scene *scene, int *start, int *end)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(scene);
 
+  /* Include frames that are being rendered, so their cache entries are not recycled. */
   *start = pfjob->cfra;
-  *end = seq_prefetch_cfra(pfjob);
+  *end = pfjob->cfra + pfjob->num_frames_scheduled;
 }
 
-static void seq_prefetch_free_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_free_depsgraph(PrefetchWorker *worker)
 {
-  if (pfjob->depsgraph != NULL) {
-    DEG_graph_free(pfjob->depsgraph);
+  if (worker->depsgraph != NULL) {
+    DEG_graph_free(worker->depsgraph);
   }
-  pfjob->depsgraph = NULL;
-  pfjob->scene_eval = NULL;
+  worker->depsgraph = NULL;
+  worker->scene_eval = NULL;
 }
 
-static void seq_prefetch_update_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_update_depsgraph(PrefetchWorker *worker)
 {
-  DEG_evaluate_on_framechange(pfjob->depsgraph, seq_prefetch_cfra(pfjob));
+  DEG_evaluate_on_framechange(worker->depsgraph, worker->cfra);
 }
 
-static void seq_prefetch_init_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_init_depsgraph(PrefetchWorker *worker)
 {
-  Main *bmain = pfjob->bmain_eval;
-  Scene *scene = pfjob->scene;
+  Main *bmain = worker->pfjob->bmain_eval;
+  Scene *scene = worker->pfjob->scene;
   ViewLayer *view_layer = BKE_view_layer_default_render(scene);
 
-  pfjob->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
-  DEG_debug_name_set(pfjob->depsgraph, "SEQUENCER PREFETCH");
+  worker->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
+  DEG_debug_name_set(worker->depsgraph, "SEQUENCER PREFETCH");
 
   /* Make sure there is a correct evaluated scene pointer. */
-  DEG_graph_build_for_render_pipeline(pfjob->depsgraph);
+  DEG_graph_build_for_render_pipeline(worker->depsgraph);
 
   /* Update immediately so we have proper evaluated scene. */
-  seq_prefetch_update_depsgraph(pfjob);
+  worker->cfra = seq_prefetch_cfra(worker->pfjob);
+  seq_prefetch_update_depsgraph(worker);
 
-  pfjob->scene_eval = DEG_get_evaluated_scene(pfjob->depsgraph);
-  pfjob->scene_eval->ed->cache_flag = 0;
+  worker->scene_eval = DEG_get_evaluated_scene(worker->depsgraph);
+  worker->scene_eval->ed->cache_flag = 0;
 }
 
+/* Must be called with `prefetch_suspend_mutex` locked. */
 static void seq_prefetch_update_area(PrefetchJob *pfjob)
 {
   int cfra = pfjob->scene->r.cfra;
@@ -245,19 +275,37 @@ static void seq_prefetch_update_area(PrefetchJob *pfjob)
     int delta = cfra - pfjob->cfra;
     pfjob->cfra = cfra;
     pfjob->num_frames_prefetched -= delta;
+    pfjob->num_frames_scheduled -= delta;
 
     if (pfjob->num_frames_prefetched <= 1) {
       pfjob->num_frames_prefetched = 1;
     }
+    if (pfjob->num_frames_scheduled < pfjob->num_frames_prefetched) {
+      pfjob->num_frames_scheduled = pfjob->num_frames_prefetched;
+    }
   }
 
   /* reset */
   if (cfra < pfjob->cfra) {
     pfjob->cfra = cfra;
     pfjob->num_frames_prefetched = 1;
+    pfjob->num_frames_scheduled = 1;
+    pfjob->generation++;
   }
 }
 
+static int seq_prefetch_num_workers(Scene *scene)
+{
+  int num_workers = scene->ed->prefetch_workers;
+
+  /* Rendering strips is multi-threaded as well, so leave some threads for it. */
+  if (num_workers == 0) {
+    num_workers = BLI_system_thread_count() / 2;
+  }
+
+  return clamp_i(num_workers, 1, SEQ_PREFETCH_WORKERS_MAX);
+}
+
 void SEQ_prefetch_stop_all(void)
 {
   /*TODO(Richard): Use wm_jobs for prefetch, or pass main. */
@@ -278,11 +326,16 @@ void SEQ_prefetch_stop(Scene *scene)
     return;
   }
 
+  BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
   pfjob->stop = true;
+  BLI_condition_notify_all(&pfjob->prefetch_suspend_cond);
+  BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
 
-  while (pfjob->running) {
-    BLI_condition_notify_one(&pfjob->prefetch_suspend_cond);
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    BLI_threadpool_remove(&pfjob->threads, &pfjob->workers[i]);
   }
+
+  BLI_assert(!pfjob->running);
 }
 
 static void seq_prefetch_update_context(const SeqRenderData *context)
@@ -290,32 +343,36 @@ static void seq_prefetch_update_context(const SeqRenderData *context)
   PrefetchJob *pfjob;
   pfjob = seq_prefetch_job_get(context->scene);
 
-  SEQ_render_new_render_data(pfjob->bmain_eval,
-                             pfjob->depsgraph,
-                             pfjob->scene_eval,
-                             context->rectx,
-                             context->recty,
-                             context->preview_render_size,
-                             false,
-                             &pfjob->context_cpy);
-  pfjob->context_cpy.is_prefetch_render = true;
-  pfjob->context_cpy.task_id = SEQ_TASK_PREFETCH_RENDER;
-
-  SEQ_render_new_render_data(pfjob->bmain,
-                             pfjob->depsgraph,
-                             pfjob->scene,
-                             context->rectx,
-                             context->recty,
-                             context->preview_render_size,
-                             false,
-                             &pfjob->context);
-  pfjob->context.is_prefetch_render = false;
-
-  /* Same ID as prefetch context, because context will be swapped, but we still
-   * want to assign this ID to cache entries created in this thread.
-   * This is to allow "temp cache" work correctly for both threads.
-   */
-  pfjob->context.task_id = SEQ_TASK_PREFETCH_RENDER;
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    PrefetchWorker *worker = &pfjob->workers[i];
+
+    SEQ_render_new_render_data(pfjob->bmain_eval,
+                               worker->depsgraph,
+                               worker->scene_eval,
+                               context->rectx,
+                               context->recty,
+                               context->preview_render_size,
+                               false,
+                               &worker->context_cpy);
+    worker->context_cpy.is_prefetch_render = true;
+    worker->context_cpy.task_id = SEQ_TASK_PREFETCH_RENDER + i;
+
+    SEQ_render_new_render_data(pfjob->bmain,
+                               worker->depsgraph,
+                               pfjob->scene,
+                               context->rectx,
+                               context->recty,
+                               context->preview_render_size,
+                               false,
+                               &worker->context);
+    worker->context.is_prefetch_render = false;
+
+    /* Same ID as prefetch context, because context will be swapped, but we still
+     * want to assign this ID to cache entries created in this thread.
+     * This is to allow "temp cache" work correctly for all threads.
+     */
+    worker->context.task_id = SEQ_TASK_PREFETCH_RENDER + i;
+  }
 }
 
 static void seq_prefetch_update_scene(Scene *scene)
@@ -327,8 +384,12 @@ static void seq_prefetch_update_scene(Scene *scene)
   }
 
   pfjob->scene = scene;
-  seq_prefetch_free_depsgraph(pfjob);
-  seq_prefetch_init_depsgraph(pfjob);
+  for (int i = 0; i < SEQ_PREFETCH_WORKERS_MAX; i++) {
+    seq_prefetch_free_depsgraph(&pfjob->workers[i]);
+  }
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    seq_prefetch_init_depsgraph(&pfjob->workers[i]);
+  }
 }
 
 static void seq_prefetch_resume(Scene *scene)
@@ -336,7 +397,9 @@ static void seq_prefetch_resume(Scene *scene)
   PrefetchJob *pfjob = seq_prefetch_job_get(scene);
 
   if (pfjob && pfjob->waiting) {
-    BLI_condition_notify_one(&pfjob->prefetch_suspend_cond);
+    BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
+    BLI_condition_notify_all(&pfjob->prefetch_suspend_cond);
+    BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
   }
 }
 
@@ -349,11 +412,12 @@ void seq_prefetch_free(Scene *scene)
 
   SEQ_prefetch_stop(scene);
 
-  BLI_threadpool_remove(&pfjob->threads, pfjob);
   BLI_threadpool_end(&pfjob->threads);
   BLI_mutex_end(&pfjob->prefetch_suspend_mutex);
   BLI_condition_end(&pfjob->prefetch_suspend_cond);
-  seq_prefetch_free_depsgraph(pfjob);
+  for (int i = 0; i < SEQ_PREFETCH_WORKERS_MAX; i++) {
+    seq_prefetch_free_depsgraph(&pfjob->workers[i]);
+  }
   BKE_main_free(pfjob->bmain_eval);
   MEM_freeN(pfjob);
   scene->ed->prefetch_job = NULL;
@@ -361,18 +425,18 @@ void seq_prefetch_free(Scene *scene)
 
 /* Skip frame if we need to render 3D scene strip. Rendering 3D scene requires main lock or setting
  * up render job that doesn't have API to do openGL renders which can be used for sequencer. */
-static bool seq_prefetch_do_skip_frame(PrefetchJob *pfjob, ListBase *seqbase)
+static bool seq_prefetch_do_skip_frame(PrefetchWorker *worker, ListBase *seqbase)
 {
-  float cfra = seq_prefetch_cfra(pfjob);
+  float cfra = worker->cfra;
   Sequence *seq_arr[MAXSEQ + 1];
   int count = seq_get_shown_sequences(seqbase, cfra, 0, seq_arr);
-  SeqRenderData *ctx = &pfjob->context_cpy;
+  SeqRenderData *ctx = &worker->context_cpy;
   ImBuf *ibuf = NULL;
 
   /* Disable prefetching 3D scene strips, but check for disk cache. */
   for (int i = 0; i < count; i++) {
     if (seq_arr[i]->type == SEQ_TYPE_META &&
-        seq_prefetch_do_skip_frame(pfjob, &seq_arr[i]->seqbase)) {
+        seq_prefetch_do_skip_frame(worker, &seq_arr[i]->seqbase)) {
       return true;
     }
 
@@ -426,73 +490,140 @@ static bool seq_prefetch_do_skip_frame(PrefetchJob *pfjob, ListBase *seqbase)
 static bool seq_prefetch_need_suspend(PrefetchJob *pfjob)
 {
   return seq_prefetch_is_cache_full(pfjob->scene) || seq_prefetch_is_scrubbing(pfjob->bmain) ||
-         (seq_prefetch_cfra(pfjob) >= pfjob->scene->r.efra);
+         (pfjob->cfra + pfjob->num_frames_scheduled > pfjob->scene->r.efra);
+}
+
+static bool seq_prefetch_do_stop(PrefetchJob *pfjob)
+{
+  return !(pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) || pfjob->stop;
 }
 
-static void seq_prefetch_do_suspend(PrefetchJob *pfjob)
+/* Claim next frame to be rendered by worker. Suspend thread if there is nothing to be prefetched.
+ * Return false when worker should stop. */
+static bool seq_prefetch_claim_frame(PrefetchWorker *worker)
 {
+  PrefetchJob *pfjob = worker->pfjob;
+  bool claimed = false;
+
   BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
-  while (seq_prefetch_need_suspend(pfjob) &&
-         (pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) && !pfjob->stop) {
-    pfjob->waiting = true;
-    BLI_condition_wait(&pfjob->prefetch_suspend_cond, &pfjob->prefetch_suspend_mutex);
+  while (!seq_prefetch_do_stop(pfjob)) {
     seq_prefetch_update_area(pfjob);
+
+    /* Avoid "collision" with main thread, but make sure to fetch at least few frames */
+    if (pfjob->num_frames_prefetched > 5 &&
+        (seq_prefetch_cfra(pfjob) - pfjob->scene->r.cfra) < 2) {
+      break;
+    }
+
+    if (!seq_prefetch_need_suspend(pfjob)) {
+      worker->cfra = pfjob->cfra + pfjob->num_frames_scheduled;
+      worker->generation = pfjob->generation;
+      pfjob->num_frames_scheduled++;
+      claimed = true;
+      break;
+    }
+
+    pfjob->num_workers_waiting++;
+    pfjob->waiting = pfjob->num_workers_waiting == pfjob->num_workers_running;
+    BLI_condition_wait(&pfjob->prefetch_suspend_cond, &pfjob->prefetch_suspend_mutex);
+    pfjob->num_workers_waiting--;
+    pfjob->waiting = false;
   }
-  pfjob->waiting = false;
   BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
+
+  return claimed;
 }
 
-static void *seq_prefetch_frames(void *job)
+/* Frame is committed in order, if it was not rebased out of prefetch area already.
+ * Must be called with `prefetch_suspend_mutex` locked. */
+static bool seq_prefetch_frame_is_pending(PrefetchWorker *worker)
 {
-  PrefetchJob *pfjob = (PrefetchJob *)job;
+  PrefetchJob *pfjob = worker->pfjob;
+  return worker->generation == pfjob->generation && worker->cfra >= seq_prefetch_cfra(pfjob);
+}
 
-  while (seq_prefetch_cfra(pfjob) <= pfjob->scene->r.efra) {
-    pfjob->scene_eval->ed->prefetch_job = NULL;
+/* Wait until all frames claimed before this one are inserted into cache. */
+static void seq_prefetch_wait_for_previous_frames(PrefetchWorker *worker)
+{
+  PrefetchJob *pfjob = worker->pfjob;
 
-    seq_prefetch_update_depsgraph(pfjob);
-    AnimData *adt = BKE_animdata_from_id(&pfjob->context_cpy.scene->id);
-    AnimationEvalContext anim_eval_context = seq_prefetch_anim_eval_context(pfjob);
-    BKE_animsys_evaluate_animdata(
-        &pfjob->context_cpy.scene->id, adt, &anim_eval_context, ADT_RECALC_ALL, false);
+  BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
+  while (seq_prefetch_frame_is_pending(worker) && worker->cfra > seq_prefetch_cfra(pfjob) &&
+         !pfjob->stop) {
+    BLI_condition_wait(&pfjob->prefetch_suspend_cond, &pfjob->prefetch_suspend_mutex);
+  }
+  BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
+}
 
-    /* This is quite hacky solution:
-     * We need cross-reference original scene with copy for cache.
-     * However depsgraph must not have this data, because it will try to kill this job.
-     * Scene copy don't reference original scene. Perhaps, this could be done by depsgraph.
-     * Set to NULL before return!
-     */
-    pfjob->scene_eval->ed->prefetch_job = pfjob;
+void seq_prefetch_wait_for_frame_commit(const SeqRenderData *context)
+{
+  seq_prefetch_wait_for_previous_frames(seq_prefetch_worker_get(context));
+}
 
-    ListBase *seqbase = SEQ_active_seqbase_get(SEQ_editing_get(pfjob->scene, false));
-    if (seq_prefetch_do_skip_frame(pfjob, seqbase)) {
-      pfjob->num_frames_prefetched++;
-      continue;
-    }
+static void seq_prefetch_commit_frame(PrefetchWorker *worker)
+{
+  PrefetchJob *pfjob = worker->pfjob;
 
-    ImBuf *ibuf = SEQ_render_give_ibuf(&pfjob->context_cpy, seq_prefetch_cfra(pfjob), 0);
-    seq_cache_free_temp_cache(pfjob->scene, pfjob->context.task_id, seq_prefetch_cfra(pfjob));
-    IMB_freeImBuf(ibuf);
+  seq_prefetch_wait_for_previous_frames(worker);
 
-    /* Suspend thread if there is nothing to be prefetched. */
-    seq_prefetch_do_suspend(pfjob);
+  BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
+  if (seq_prefetch_frame_is_pending(worker) && worker->cfra == seq_prefetch_cfra(pfjob)) {
+    pfjob->num_frames_prefetched++;
+    BLI_condition_notify_all(&pfjob->prefetch_suspend_cond);
+  }
+  BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
+}
 
-    /* Avoid "collision" with main thread, but make sure to fetch at least few frames */
-    if (pfjob->num_frames_prefetched > 5 &&
-        (seq_prefetch_cfra(pfjob) - pfjob->scene->r.cfra) < 2) {
-      break;
-    }
+static void seq_prefetch_render_frame(PrefetchWorker *worker)
+{
+  PrefetchJob *pfjob = worker->pfjob;
 
-    if (!(pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) || pfjob->stop) {
-      break;
-    }
+  worker->scene_eval->ed->prefetch_job = NULL;
 
-    seq_prefetch_update_area(pfjob);
-    pfjob->num_frames_prefetched++;
+  seq_prefetch_update_depsgraph(worker);
+  AnimData *adt = BKE_animdata_from_id(&worker->context_cpy.scene->id);
+  AnimationEvalContext anim_eval_context = seq_prefetch_anim_eval_context(worker);
+  BKE_animsys_evaluate_animdata(
+      &worker->context_cpy.scene->id, adt, &anim_eval_context, ADT_RECALC_ALL, false);
+
+  /* This is quite hacky solution:
+   * We need cross-reference original scene with copy for cache.
+   * However depsgraph must not have this data, because it will try to kill this job.
+   * Scene copy don't reference original scene. Perhaps, this could be done by depsgraph.
+   * Set to NULL before return!
+   */
+  worker->scene_eval->ed->prefetch_job = pfjob;
+
+  ListBase *seqbase = SEQ_active_seqbase_get(SEQ_editing_get(pfjob->scene, false));
+  if (seq_prefetch_do_skip_frame(worker, seqbase)) {
+    return;
+  }
+
+  ImBuf *ibuf = SEQ_render_give_ibuf(&worker->context_cpy, worker->cfra, 0);
+  seq_cache_free_temp_cache(pfjob->scene, worker->context.task_id, worker->cfra);
+  IMB_freeImBuf(ibuf);
+}
+
+static void *seq_prefetch_frames(void *job)
+{
+  PrefetchWorker *worker = (PrefetchWorker *)job;
+  PrefetchJob *pfjob = worker->pfjob;
+
+  while (seq_prefetch_claim_frame(worker)) {
+    seq_prefetch_render_frame(worker);
+    seq_prefetch_commit_frame(worker);
   }
 
-  seq_cache_free_temp_cache(pfjob->scene, pfjob->context.task_id, seq_prefetch_cfra(pfjob));
-  pfjob->running = false;
-  pfjob->scene_eval->ed->prefetch_job = NULL;
+  seq_cache_free_temp_cache(pfjob->scene, worker->context.task_id, worker->cfra);
+  worker->scene_eval->ed->prefetch_job = NULL;
+
+  BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
+  pfjob->num_workers_running--;
+  pfjob->running = pfjob->num_workers_running > 0;
+  /* Remaining workers may be suspended, let them re-evaluate the waiting state. */
+  pfjob->waiting = pfjob->running && pfjob->num_workers_waiting == pfjob->num_workers_running;
+  BLI_condition_notify_all(&pfjob->prefetch_suspend_cond);
+  BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
 
   return NULL;
 }
@@ -506,19 +637,32 @@ static PrefetchJob *seq_prefetch_start_ex(const SeqRenderData *context, float cf
       pfjob = (PrefetchJob *)MEM_callocN(sizeof(PrefetchJob), "PrefetchJob");
       context->scene->ed->prefetch_job = pfjob;
 
-      BLI_threadpool_init(&pfjob->threads, seq_prefetch_frames, 1);
+      BLI_threadpool_init(&pfjob->threads, seq_prefetch_frames, SEQ_PREFETCH_WORKERS_MAX);
       BLI_mutex_init(&pfjob->prefetch_suspend_mutex);
       BLI_condition_init(&pfjob->prefetch_suspend_cond);
 
       pfjob->bmain_eval = BKE_main_new();
       pfjob->scene = context->scene;
-      seq_prefetch_init_depsgraph(pfjob);
+      for (int i = 0; i < SEQ_PREFETCH_WORKERS_MAX; i++) {
+        pfjob->workers[i].pfjob = pfjob;
+      }
     }
   }
+
+  /* Finished workers must be joined before their slots can be reused. */
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    BLI_threadpool_remove(&pfjob->threads, &pfjob->workers[i]);
+  }
+
   pfjob->bmain = context->bmain;
 
   pfjob->cfra = cfra;
   pfjob->num_frames_prefetched = 1;
+  pfjob->num_frames_scheduled = 1;
+  pfjob->generation = 0;
+  pfjob->num_workers = seq_prefetch_num_workers(context->scene);
+  pfjob->num_workers_running = pfjob->num_workers;
+  pfjob->num_workers_waiting = 0;
 
   pfjob->waiting = false;
   pfjob->stop = false;
@@ -527,8 +671,9 @@ static PrefetchJob *seq_prefetch_start_ex(const SeqRenderData *context, float cf
   seq_prefetch_update_scene(context->scene);
   seq_prefetch_update_context(context);
 
-  BLI_threadpool_remove(&pfjob->threads, pfjob);
-  BLI_threadpool_insert(&pfjob->threads, pfjob);
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    BLI_threadpool_insert(&pfjob->threads, &pfjob->workers[i]);
+  }
 
   return pfjob;
 }
@@ -41,6 +41,7 @@ bool seq_prefetch_job_is_running(struct Scene *scene);
 void seq_prefetch_get_time_range(struct Scene *scene, int *start, int *end);
 struct SeqRenderData *seq_prefetch_get_original_context(const struct SeqRenderData *context);
 struct Sequence *seq_prefetch_get_original_sequence(struct Sequence *seq, struct Scene *scene);
+void seq_prefetch_wait_for_frame_commit(const struct SeqRenderData *context);
 
 #ifdef __cplusplus
 }
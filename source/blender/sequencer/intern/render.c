@@ -2002,17 +2002,23 @@ ImBuf *SEQ_render_give_ibuf(const SeqRenderData *context, float timeline_frame,
   seq_cache_free_temp_cache(context->scene, context->task_id, timeline_frame);
 
   if (count && !out) {
-    BLI_mutex_lock(&seq_render_mutex);
-    out = seq_render_strip_stack(context, &state, seqbasep, timeline_frame, chanshown);
-
+    /* Prefetch workers render in parallel. Cache items are linked per task, so only renders
+     * outside of prefetching are serialized. Effects which use global state, like the fonts of
+     * text strips, have their own locks. */
     if (context->is_prefetch_render) {
+      out = seq_render_strip_stack(context, &state, seqbasep, timeline_frame, chanshown);
+
+      /* Final images are inserted into cache in order of frames. */
+      seq_prefetch_wait_for_frame_commit(context);
       seq_cache_put(context, seq_arr[count - 1], timeline_frame, SEQ_CACHE_STORE_FINAL_OUT, out);
     }
     else {
+      BLI_mutex_lock(&seq_render_mutex);
+      out = seq_render_strip_stack(context, &state, seqbasep, timeline_frame, chanshown);
       seq_cache_put_if_possible(
           context, seq_arr[count - 1], timeline_frame, SEQ_CACHE_STORE_FINAL_OUT, out);
+      BLI_mutex_unlock(&seq_render_mutex);
     }
-    BLI_mutex_unlock(&seq_render_mutex);
   }
 
   seq_prefetch_start(context, timeline_frame);
@@ -60,6 +60,7 @@
 #include "BKE_brush.h"
 #include "BKE_colortools.h"
 #include "BKE_context.h"
+#include "BKE_customdata.h"
 #include "BKE_global.h"
 #include "BKE_icons.h"
 #include "BKE_idprop.h"
@@ -3307,6 +3308,16 @@ static void WM_OT_redraw_timer(wmOperatorType *ot)
 static int memory_statistics_exec(bContext *UNUSED(C), wmOperator *UNUSED(op))
 {
   MEM_printmemlist_stats();
+
+  int sharings_num, users_num;
+  size_t size_shared, size_saved;
+  CustomData_sharing_stats(&sharings_num, &users_num, &size_shared, &size_saved);
+  printf("\nshared custom data: %d buffers used by %d layers, %.3f MB shared, %.3f MB saved\n",
+         sharings_num,
+         users_num,
+         (double)size_shared / (1024.0 * 1024.0),
+         (double)size_saved / (1024.0 * 1024.0));
+
   return OPERATOR_FINISHED;
 }
 
@@ -589,6 +589,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-time");
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-pretty");
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-uuid");
+  BLI_args_print_arg_doc(ba, "--debug-geometry-nodes-time");
   BLI_args_print_arg_doc(ba, "--debug-ghost");
   BLI_args_print_arg_doc(ba, "--debug-gpu");
   BLI_args_print_arg_doc(ba, "--debug-gpu-force-workarounds");
@@ -988,6 +989,9 @@ static const char arg_handle_debug_mode_generic_set_doc_depsgraph_eval[] =
 static const char arg_handle_debug_mode_generic_set_doc_depsgraph_no_threads[] =
     "\n\t"
     "Switch dependency graph to a single threaded evaluation.";
+static const char arg_handle_debug_mode_generic_set_doc_geometry_nodes_time[] =
+    "\n\t"
+    "Enable per-node timing statistics for geometry nodes evaluation.";
 static const char arg_handle_debug_mode_generic_set_doc_depsgraph_pretty[] =
     "\n\t"
     "Enable colors for dependency graph debug messages.";
@@ -2188,6 +2192,11 @@ void main_args_setup(bContext *C, bArgs *ba)
                "--debug-depsgraph-uuid",
                CB_EX(arg_handle_debug_mode_generic_set, depsgraph_build),
                (void *)G_DEBUG_DEPSGRAPH_UUID);
+  BLI_args_add(ba,
+               NULL,
+               "--debug-geometry-nodes-time",
+               CB_EX(arg_handle_debug_mode_generic_set, geometry_nodes_time),
+               (void *)G_DEBUG_GEOMETRY_NODES_TIME);
   BLI_args_add(ba,
                NULL,
                "--debug-gpu-force-workarounds",